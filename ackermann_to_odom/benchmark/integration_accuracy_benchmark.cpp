@@ -0,0 +1,105 @@
+/**
+ * \file integration_accuracy_benchmark.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: m.a.munoz
+ *
+ * Position error of every integration method against the odometry rate, on
+ * a 120 s drive of constant curvature segments (turns and straights) with the
+ * yaw integrated from the bicycle model, at a low and at a high speed. The
+ * analytic trajectory is the chain of arcs in double precision.
+ */
+
+#include "odometry_integrator.h"
+#include <math.h>
+#include <stdio.h>
+
+namespace
+{
+
+const float DRIVE_WHEELBASE = 1.08;
+const float DRIVE_SPEEDS[] = {3.0, 20.0};
+const int DRIVE_SPEED_COUNT = 2;
+// every segment lasts DRIVE_SEGMENT [s], so all the rates below step on the segment borders
+const double DRIVE_SEGMENT = 2.0;
+const int DRIVE_SEGMENTS = 60;
+const double DRIVE_START = 1000.0;
+
+// down to 1 Hz, where the steps are 20 m long at the high speed
+const int RATES[] = {100, 50, 20, 10, 5, 4, 2, 1};
+const int RATE_COUNT = 8;
+
+const char* const METHOD_NAMES[] = {"euler", "midpoint", "rk4", "exact_arc"};
+
+/**
+ * \brief Steering angle of a segment [rad], left and right turns of several
+ * radii between straights.
+ */
+float segmentSteering(int segment)
+{
+  const float steering[] = {0.0, 0.3, 0.0, -0.15, -0.4, 0.0, 0.05, 0.2};
+  return steering[segment % 8];
+}
+
+/**
+ * \brief Distance between the integrated and the analytic final position.
+ */
+double driveError(IntegrationMethod method, float speed, int rate)
+{
+  OdometryIntegrator integrator;
+  integrator.setTiming(true, 1.0);
+  integrator.setWheelbase(DRIVE_WHEELBASE);
+  integrator.setKinematicModel(KINEMATIC_BICYCLE, false);
+  integrator.setIntegrationMethod(method);
+  integrator.seed(0.0, 0.0, 0.0, ros::Time(DRIVE_START));
+
+  double x = 0.0;
+  double y = 0.0;
+  double yaw = 0.0;
+  int steps_per_segment = (int)(DRIVE_SEGMENT * rate + 0.5);
+  for (int segment = 0; segment < DRIVE_SEGMENTS; segment++)
+  {
+    float steering = segmentSteering(segment);
+    for (int step = 1; step <= steps_per_segment; step++)
+    {
+      double t = segment * DRIVE_SEGMENT + step / (double)rate;
+      integrator.integrate(ros::Time(DRIVE_START + t), speed, steering, 0.0, 0.0);
+    }
+
+    // arc of the segment
+    double yaw_increment = speed * tan((double)steering) / DRIVE_WHEELBASE * DRIVE_SEGMENT;
+    double distance = speed * DRIVE_SEGMENT;
+    double chord = distance;
+    if (fabs(yaw_increment) > 1e-12)
+      chord *= sin(0.5 * yaw_increment) / (0.5 * yaw_increment);
+    x += chord * cos(yaw + 0.5 * yaw_increment);
+    y += chord * sin(yaw + 0.5 * yaw_increment);
+    yaw += yaw_increment;
+  }
+
+  return hypot(integrator.getX() - x, integrator.getY() - y);
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+  for (int speed = 0; speed < DRIVE_SPEED_COUNT; speed++)
+  {
+    printf("final position error [m] after %.0f m at %.0f m/s, by odometry rate [Hz]\n",
+           DRIVE_SPEEDS[speed] * DRIVE_SEGMENT * DRIVE_SEGMENTS, DRIVE_SPEEDS[speed]);
+    printf("%-10s", "method");
+    for (int r = 0; r < RATE_COUNT; r++)
+      printf("%12d", RATES[r]);
+    printf("\n");
+
+    for (int method = INTEGRATION_EULER; method <= INTEGRATION_EXACT_ARC; method++)
+    {
+      printf("%-10s", METHOD_NAMES[method]);
+      for (int r = 0; r < RATE_COUNT; r++)
+        printf("%12.5f", driveError((IntegrationMethod)method, DRIVE_SPEEDS[speed], RATES[r]));
+      printf("\n");
+    }
+  }
+  return 0;
+}
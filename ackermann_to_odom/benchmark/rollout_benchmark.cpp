@@ -0,0 +1,62 @@
+/**
+ * \file rollout_benchmark.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: m.a.munoz
+ *
+ * Time of a planning batch of TrajectoryRollout, 10000 control sequences of
+ * 50 steps, on one thread and on the thread pool.
+ */
+
+#include "trajectory_rollout.h"
+#include "ros/time.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+namespace
+{
+
+const int BENCHMARK_ROLLOUTS = 10000;
+const int BENCHMARK_STEPS = 50;
+const int BENCHMARK_REPEATS = 50;
+
+/**
+ * \brief Mean time of a batch in [ms].
+ */
+double batchTime(TrajectoryRollout& rollout, RolloutBatch& batch)
+{
+  // warm up, and wakes the workers once
+  rollout.rollout(0.0, 0.0, 0.0, 0.1, batch);
+
+  ros::WallTime start = ros::WallTime::now();
+  for (int repeat = 0; repeat < BENCHMARK_REPEATS; repeat++)
+    rollout.rollout(0.0, 0.0, 0.0, 0.1, batch);
+  return (ros::WallTime::now() - start).toSec() / BENCHMARK_REPEATS * 1e3;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+  RolloutBatch batch(BENCHMARK_ROLLOUTS, BENCHMARK_STEPS);
+  for (int k = 0; k < BENCHMARK_ROLLOUTS; k++)
+  {
+    float speed = 5.0 * rand() / RAND_MAX;
+    float steering = 0.8 * rand() / RAND_MAX - 0.4;
+    for (int step = 0; step < BENCHMARK_STEPS; step++)
+    {
+      batch.speed(step)[k] = speed;
+      batch.steering(step)[k] = steering;
+    }
+  }
+
+  TrajectoryRollout single_thread(KINEMATIC_TRICYCLE, 1.08, INTEGRATION_EXACT_ARC, 1);
+  double single = batchTime(single_thread, batch);
+  TrajectoryRollout thread_pool(KINEMATIC_TRICYCLE, 1.08, INTEGRATION_EXACT_ARC);
+  double pooled = batchTime(thread_pool, batch);
+
+  printf("rollout of %d sequences of %d steps [ms]: 1 thread %.2f, %d threads %.2f (%.1f M steps/s)\n",
+         BENCHMARK_ROLLOUTS, BENCHMARK_STEPS, single, (int)boost::thread::hardware_concurrency(), pooled,
+         BENCHMARK_ROLLOUTS * BENCHMARK_STEPS / pooled * 1e-3);
+  return 0;
+}
@@ -0,0 +1,112 @@
+/**
+ * \file ackermann_imu_synchronizer.h
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: m.a.munoz
+ */
+
+#ifndef _ackermann_imu_synchronizer_h_
+#define _ackermann_imu_synchronizer_h_
+
+#include "ackermann_msgs/AckermannDriveStamped.h"
+#include "sensor_msgs/Imu.h"
+#include <boost/circular_buffer.hpp>
+
+// capacity of the time indexed buffers (1 s of virtual imu at 1 kHz)
+#define SYNC_IMU_BUFFER_SIZE 1024
+#define SYNC_ACKERMANN_BUFFER_SIZE 64
+
+/**
+ * \brief Ackermann and imu synchronizer
+ *
+ * Keeps the recent ackermann samples and imu orientations in short buffers
+ * ordered by header stamp, and pairs every ackermann sample with the imu
+ * orientation interpolated (slerp) to its stamp. Samples are paired in stamp
+ * order as soon as the imu data covers them, or after a timeout with the last
+ * imu orientation, so the pairing is driven by the callbacks. The timeout runs
+ * both on the ackermann stamps, when the imu stops, and on the time since the
+ * sample arrived, when both streams stop, so a caller polling nextPair
+ * releases the last samples too.
+ */
+class AckermannImuSynchronizer
+{
+private:
+
+  struct ImuEntry
+  {
+    ros::Time stamp;
+    double x, y, z, w;
+    double yaw_variance;
+  };
+
+  struct AckermannEntry
+  {
+    std_msgs::Header header;
+    ros::Time arrival;
+    float speed;
+    float steering_angle;
+  };
+
+  boost::circular_buffer<ImuEntry> imu_buffer_;
+  boost::circular_buffer<AckermannEntry> ackermann_buffer_;
+
+  // orientation used when no imu sample was received yet
+  ImuEntry last_imu_;
+
+  // maximum time an ackermann sample waits for newer imu data, in stamp and in arrival time [s]
+  double timeout_;
+
+public:
+
+  // pairing statistics
+  unsigned long interpolated_pairs_;
+  unsigned long clamped_pairs_;
+  unsigned long held_pairs_;
+  unsigned long dropped_imu_samples_;
+  unsigned long dropped_ackermann_samples_;
+
+  /**
+   * \brief Constructor of AckermannImuSynchronizer class
+   */
+  AckermannImuSynchronizer(void);
+
+  /**
+   * \brief Maximum time in [s] an ackermann sample waits for imu data newer than
+   * its stamp before it is paired with the last imu orientation.
+   */
+  void setTimeout(double timeout);
+
+  /**
+   * \brief Empties the buffers and the statistics.
+   */
+  void reset(void);
+
+  /**
+   * \brief Adds an imu orientation. Samples older than the last one are dropped.
+   */
+  void addImu(const sensor_msgs::Imu& imu);
+
+  /**
+   * \brief Adds an ackermann sample. The oldest one is dropped when the buffer is full.
+   *
+   * @param ackermann is the ackermann sample.
+   * @param arrival is the time the sample was received, on the clock passed to nextPair.
+   */
+  void addAckermann(const ackermann_msgs::AckermannDriveStamped& ackermann, const ros::Time& arrival);
+
+  /**
+   * \brief Pops the oldest ackermann sample that can be paired.
+   *
+   * A sample the imu data does not cover yet is paired with the last imu
+   * orientation once a newer ackermann stamp, or now, is more than the
+   * timeout past it.
+   *
+   * @param ackermann is the ackermann sample.
+   * @param imu gets the orientation interpolated to the ackermann stamp.
+   * @param now is the current time, on the clock of the arrival times.
+   * \return false if no ackermann sample can be paired yet.
+   */
+  bool nextPair(ackermann_msgs::AckermannDriveStamped& ackermann, sensor_msgs::Imu& imu, const ros::Time& now);
+};
+
+#endif /* _ackermann_imu_synchronizer_h_ */
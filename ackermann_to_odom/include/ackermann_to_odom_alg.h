@@ -38,8 +38,13 @@
 #include "nav_msgs/Odometry.h"
 #include "sensor_msgs/Imu.h"
 #include <tf/transform_broadcaster.h>
+#include <boost/circular_buffer.hpp>
+#include "odometry_integrator.h"
 
-#define MAX_DIFF 1.5
+#define DEG2RAD (M_PI / 180.0)
+
+// imu samples kept for the replay of the imu rate odometry (2.5 s at 100 Hz)
+#define IMU_REPLAY_BUFFER_SIZE 256
 
 //include ackermann_to_odom_alg main library
 
@@ -60,8 +65,50 @@ protected:
   pthread_mutex_t access_;
 
   // private attributes and methods
+  bool ackermann_covariance_received_;
+
+  // imu rate odometry: integrator state at the last ackermann sample, the imu
+  // samples integrated since then, and the ackermann sample held between them
+  OdometryIntegrator anchor_;
+  sensor_msgs::Imu anchor_imu_;
+  boost::circular_buffer<sensor_msgs::Imu> imu_replay_;
+  ackermann_msgs::AckermannDriveStamped last_ackermann_;
+  bool ackermann_received_;
+  bool replay_overflow_;
+
+  /**
+   * \brief Applies the configuration to an integrator.
+   */
+  void configureIntegrator(OdometryIntegrator& integrator, const ackermann_to_odom::AckermannToOdomConfig& config);
+
+  /**
+   * \brief Integrates one ackermann sample with the imu orientation, in 2D or in 3D.
+   *
+   * \return false if the sample was rejected by its stamp.
+   */
+  bool integrateSample(const ackermann_msgs::AckermannDriveStamped& estimated_ackermann_state,
+                       const sensor_msgs::Imu& virtual_imu_msg, bool odometry_3d);
+
+  /**
+   * \brief Fills the odometry messages and the transform from the integrator state.
+   *
+   * The orientation is computed once and shared by the messages and the
+   * transform. In 3D the roll and pitch variances are read from the imu.
+   */
+  void fillOdometryMsgs(const sensor_msgs::Imu& virtual_imu_msg, bool odometry_3d,
+                        geometry_msgs::PoseWithCovarianceStamped& odometry_pose, nav_msgs::Odometry& odometry,
+                        geometry_msgs::TransformStamped& odom_trans);
 
 public:
+
+  // state of the odometry integration
+  OdometryIntegrator integrator_;
+
+  // imu rate odometry statistics, replayed corrections and corrections lost
+  // because the replay buffer overflowed
+  unsigned long corrections_;
+  unsigned long lost_corrections_;
+
   /**
    * \brief define config type
    *
@@ -150,6 +197,17 @@ public:
    */
   ~AckermannToOdomAlgorithm(void);
 
+  /**
+   * \brief Set ackermann covariance
+   *
+   * Sets the speed and steering variances used to propagate the pose
+   * covariance. Once called, the variances of the config are not used.
+   *
+   * @param covariance has the variance of the speed in [m^2/s^2] in drive.speed,
+   * and the variance of the steering angle in [deg^2] in drive.steering_angle.
+   */
+  void setAckermannCovariance(const ackermann_msgs::AckermannDriveStamped& covariance);
+
   /**
    * \brief Generate new message of odometry
    *
@@ -157,16 +215,64 @@ public:
    * of odometry type.
    *
    * @param estimated_ackermann_state is the state of the robot.
-   * @param covariance is the covariance value of the ackermann state.
    * @param virtual_imu_ms is the message of the imu sensor.
    * @param odometry is the output of the function. Is odometry message.
    * @param odom_trans is the odometry transform in /tf message.
-   * @param base_trans is the laser transform in /tf message.
+   * \return false if the sample was rejected by its header stamp and the outputs were not updated.
    */
-  void generateNewOdometryMsg2D(ackermann_msgs::AckermannDriveStamped estimated_ackermann_state,
+  bool generateNewOdometryMsg2D(ackermann_msgs::AckermannDriveStamped estimated_ackermann_state,
                                 sensor_msgs::Imu virtual_imu_ms,
                                 geometry_msgs::PoseWithCovarianceStamped& odometry_pose, nav_msgs::Odometry& odometry,
                                 geometry_msgs::TransformStamped& odom_trans);
+
+  /**
+   * \brief Generate new message of 3D odometry
+   *
+   * Same as generateNewOdometryMsg2D, but the speed is projected along the full
+   * imu attitude, z is integrated, and the published orientation is the imu
+   * attitude, with its roll and pitch variances.
+   *
+   * @param estimated_ackermann_state is the state of the robot.
+   * @param virtual_imu_ms is the message of the imu sensor.
+   * @param odometry is the output of the function. Is odometry message.
+   * @param odom_trans is the odometry transform in /tf message.
+   * \return false if the sample was rejected by its header stamp and the outputs were not updated.
+   */
+  bool generateNewOdometryMsg3D(ackermann_msgs::AckermannDriveStamped estimated_ackermann_state,
+                                sensor_msgs::Imu virtual_imu_ms,
+                                geometry_msgs::PoseWithCovarianceStamped& odometry_pose, nav_msgs::Odometry& odometry,
+                                geometry_msgs::TransformStamped& odom_trans);
+
+  /**
+   * \brief Propagates the imu rate odometry to an imu sample
+   *
+   * Integrates the last ackermann speed and steering up to the imu stamp, with
+   * the imu orientation, and keeps the sample to replay it when the next
+   * ackermann sample arrives.
+   *
+   * @param virtual_imu_msg is the imu sample.
+   * @param odometry is the output of the function. Is odometry message.
+   * @param odom_trans is the odometry transform in /tf message.
+   * \return false if no ackermann sample was received yet or the imu sample was
+   * rejected by its stamp, and the outputs were not updated.
+   */
+  bool propagateImu(const sensor_msgs::Imu& virtual_imu_msg, geometry_msgs::PoseWithCovarianceStamped& odometry_pose,
+                    nav_msgs::Odometry& odometry, geometry_msgs::TransformStamped& odom_trans);
+
+  /**
+   * \brief Corrects the imu rate odometry with a new ackermann sample
+   *
+   * The state goes back to the previous ackermann sample, and the imu samples
+   * received since then are integrated again, with the speed and steering
+   * interpolated between both ackermann samples up to the new one and with the
+   * new ones after it.
+   */
+  void correctAckermann(const ackermann_msgs::AckermannDriveStamped& estimated_ackermann_state);
+
+  /**
+   * \brief Restarts the imu rate odometry, it waits again for an ackermann sample.
+   */
+  void resetImuRate(void);
 };
 
 #endif
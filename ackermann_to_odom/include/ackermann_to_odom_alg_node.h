@@ -32,7 +32,12 @@
 #define _ackermann_to_odom_alg_node_h_
 
 #include <iri_base_algorithm/iri_base_algorithm.h>
+#include <dynamic_reconfigure/server.h>
 #include "ackermann_to_odom_alg.h"
+#include "ackermann_imu_synchronizer.h"
+#include "pose_history.h"
+#include <boost/atomic.hpp>
+#include <boost/make_shared.hpp>
 #include "ackermann_msgs/AckermannDriveStamped.h"
 #include "geometry_msgs/PoseWithCovarianceStamped.h"
 #include "nav_msgs/Odometry.h"
@@ -40,10 +45,12 @@
 #include <tf/transform_broadcaster.h>
 #include <tf/transform_listener.h>
 #include <tf/tf.h>
+#include <tf2_ros/static_transform_broadcaster.h>
 
 // [publisher subscriber headers]
 
 // [service client headers]
+#include "ackermann_to_odom/GetPoseAtTime.h"
 
 // [action server client headers]
 
@@ -59,12 +66,56 @@ private:
   ackermann_msgs::AckermannDriveStamped estimated_ackermann_state_;
   sensor_msgs::Imu virtual_imu_msg_;
   geometry_msgs::TransformStamped odom_trans_;
-  tf::StampedTransform scan_trans_;
   tf::TransformBroadcaster broadcaster_;
   tf::TransformListener listener_;
+  tf2_ros::StaticTransformBroadcaster static_broadcaster_;
   nav_msgs::Odometry odometry_;
   geometry_msgs::PoseWithCovarianceStamped odometry_pose_;
 
+  // rosparam configuration
+  bool odom_in_tf_;
+  bool scan_in_tf_;
+  std::string frame_id_;
+  std::string child_id_;
+
+  // cached scan transform, resolved once by cb_scanTransformTimer
+  geometry_msgs::TransformStamped scan_trans_;
+  bool scan_trans_resolved_;
+  ros::Timer scan_transform_timer_;
+
+  /**
+   * \brief Tries to resolve the scan transform without blocking.
+   *
+   * Once it is available it is cached, published once in /tf_static, and the
+   * timer is stopped.
+   */
+  void cb_scanTransformTimer(const ros::TimerEvent& event);
+
+  /**
+   * \brief Publishes the last generated odometry, and its transform if odom_in_tf is set.
+   */
+  void publishOdometry(void);
+
+  /**
+   * \brief Generates the odometry of the current samples, in 2D or in 3D as
+   * selected by odometry_3d.
+   *
+   * \return false if the sample was rejected by its header stamp.
+   */
+  bool generateOdometry(void);
+
+  // pairs ackermann samples and imu orientations by header stamp
+  AckermannImuSynchronizer synchronizer_;
+
+  /**
+   * \brief Integrates and publishes every ackermann sample that can be paired
+   * with the imu orientation at its stamp, in stamp order.
+   */
+  void integrateSynchronized(void);
+
+  // odometry poses queried by time, shared with the nodelets of the process
+  boost::shared_ptr<PoseHistory> pose_history_;
+
   // [publisher attributes]
   ros::Publisher odometry_publisher_;
   ros::Publisher pose_publisher_;
@@ -84,7 +135,20 @@ private:
    */
   void cb_ackermannState(const ackermann_msgs::AckermannDriveStamped::ConstPtr& estimated_ackermann_state_msg);
 
+  /**
+   * \brief Callback for read the variances of the ackermann state.
+   */
+  void cb_ackermannCovariance(const ackermann_msgs::AckermannDriveStamped::ConstPtr& covariance_ackermann_state_msg);
+
   // [service attributes]
+  ros::ServiceServer pose_at_time_server_;
+
+  /**
+   * \brief Callback for the pose at a given time.
+   *
+   * Served from the pose history without taking the algorithm lock.
+   */
+  bool cb_getPoseAtTime(ackermann_to_odom::GetPoseAtTime::Request &req, ackermann_to_odom::GetPoseAtTime::Response &res);
 
   // [client attributes]
 
@@ -99,6 +163,35 @@ private:
    * Is updated everytime function config_update() is called.
    */
   Config config_;
+
+  // node loop when loaded as a nodelet, see startNodeLoop()
+  pthread_t node_loop_thread_;
+  boost::atomic<bool> node_loop_running_;
+
+  /**
+   * \brief Node loop thread
+   *
+   * Same loop as the one run by algorithm_base::main: mainNodeThread() and the
+   * diagnostics update at the loop rate.
+   */
+  static void *nodeLoopThread(void *param);
+
+  // dynamic reconfigure server on the private namespace of the nodelet
+  boost::shared_ptr<dynamic_reconfigure::Server<Config> > nodelet_reconfigure_server_;
+
+  /**
+   * \brief Dynamic reconfigure callback of the nodelet server
+   *
+   * Updates the algorithm and the node configuration, as the callback of the
+   * base class server.
+   */
+  void nodeletConfigUpdate(Config &config, uint32_t level);
+
+  /**
+   * \brief Initializes the node attributes and its ROS communications.
+   */
+  void init(void);
+
 public:
   /**
    * \brief Constructor
@@ -108,6 +201,18 @@ public:
    */
   AckermannToOdomAlgNode(void);
 
+  /**
+   * \brief Nodelet constructor
+   *
+   * Same as the default constructor, with the node handles of the nodelet
+   * instead of the ones of the process, and a dynamic reconfigure server on
+   * the private namespace of the nodelet.
+   *
+   * @param node_handle is the nodelet node handle.
+   * @param private_node_handle is the nodelet private node handle.
+   */
+  AckermannToOdomAlgNode(const ros::NodeHandle& node_handle, const ros::NodeHandle& private_node_handle);
+
   /**
    * \brief Destructor
    *
@@ -116,6 +221,20 @@ public:
    */
   ~AckermannToOdomAlgNode(void);
 
+  /**
+   * \brief Starts the node loop
+   *
+   * Used by the nodelet, which can not block in algorithm_base::main. Adds the
+   * node diagnostics and runs mainNodeThread() in its own thread until
+   * stopNodeLoop() is called. The callbacks are served by the nodelet manager.
+   */
+  void startNodeLoop(void);
+
+  /**
+   * \brief Stops the node loop started with startNodeLoop().
+   */
+  void stopNodeLoop(void);
+
 protected:
   /**
    * \brief main node thread
@@ -164,6 +283,11 @@ protected:
 
   // [diagnostic functions]
 
+  /**
+   * \brief Reports the ackermann sample timing statistics.
+   */
+  void timingDiagnostic(diagnostic_updater::DiagnosticStatusWrapper &stat);
+
   // [test functions]
 };
 
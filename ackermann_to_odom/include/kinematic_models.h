@@ -0,0 +1,285 @@
+/**
+ * \file kinematic_models.h
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: m.a.munoz
+ */
+
+#ifndef _kinematic_models_h_
+#define _kinematic_models_h_
+
+#include <Eigen/Core>
+#include <math.h>
+
+/**
+ * \brief Integration methods of the pose, same values as integration_method in AckermannToOdom.cfg
+ */
+enum IntegrationMethod
+{
+  INTEGRATION_EULER = 0,
+  INTEGRATION_MIDPOINT = 1,
+  INTEGRATION_RK4 = 2,
+  INTEGRATION_EXACT_ARC = 3
+};
+
+/**
+ * \brief Kinematic models, same values as kinematic_model in AckermannToOdom.cfg
+ */
+enum KinematicModel
+{
+  KINEMATIC_TRICYCLE = 0,
+  KINEMATIC_BICYCLE = 1,
+  KINEMATIC_FOUR_WHEEL_ACKERMANN = 2,
+  KINEMATIC_SKID_STEER = 3
+};
+
+/*
+ * Kinematic model policies of OdometryIntegrator. Each one maps the ackermann
+ * speed and steering angle to the forward speed and the yaw rate of the rear
+ * axle centre (the base_link origin), and gives their derivatives for the
+ * covariance propagation. Everything is static and inline, so the model
+ * constants fold into the integration kernel instantiated for each model.
+ *
+ * The forward speed and the yaw rate are templates on the value type, so the
+ * odometry (float) and the batch rollouts (fixed size Eigen arrays of
+ * rollouts) run the same model. MODEL is the KinematicModel value of the policy.
+ */
+
+/**
+ * \brief Tricycle, the speed is measured at the steered front wheel.
+ */
+struct TricycleModel
+{
+  static const KinematicModel MODEL = KINEMATIC_TRICYCLE;
+
+  template <typename T>
+  static inline T forwardSpeed(const T& speed, const T& steering)
+  {
+    return speed * cos(steering);
+  }
+
+  template <typename T>
+  static inline T yawRate(const T& speed, const T& steering, float wheelbase)
+  {
+    return (speed / wheelbase) * sin(steering);
+  }
+
+  static inline double forwardSpeedDerivatives(double speed, double steering, double& d_steering)
+  {
+    d_steering = -speed * sin(steering);
+    return cos(steering);
+  }
+
+  static inline double yawRateDerivatives(double speed, double steering, double wheelbase, double& d_steering)
+  {
+    d_steering = speed * cos(steering) / wheelbase;
+    return sin(steering) / wheelbase;
+  }
+};
+
+/**
+ * \brief Bicycle, the speed is measured at the rear axle.
+ */
+struct BicycleModel
+{
+  static const KinematicModel MODEL = KINEMATIC_BICYCLE;
+
+  template <typename T>
+  static inline T forwardSpeed(const T& speed, const T& steering)
+  {
+    return speed;
+  }
+
+  template <typename T>
+  static inline T yawRate(const T& speed, const T& steering, float wheelbase)
+  {
+    return speed * tan(steering) / wheelbase;
+  }
+
+  static inline double forwardSpeedDerivatives(double speed, double steering, double& d_steering)
+  {
+    d_steering = 0.0;
+    return 1.0;
+  }
+
+  static inline double yawRateDerivatives(double speed, double steering, double wheelbase, double& d_steering)
+  {
+    double cos_steering = cos(steering);
+    d_steering = speed / (wheelbase * cos_steering * cos_steering);
+    return tan(steering) / wheelbase;
+  }
+};
+
+/**
+ * \brief Four wheel Ackermann, the speed is the mean of the four wheel
+ * encoders, so it is measured at the centre of the vehicle, half the wheelbase
+ * ahead of the rear axle.
+ *
+ * The steering angle is the one of the virtual wheel at the centre of the
+ * front axle. The velocity at the centre forms the angle
+ * beta = atan(tan(steering) / 2) with the vehicle axis.
+ */
+struct FourWheelAckermannModel
+{
+  static const KinematicModel MODEL = KINEMATIC_FOUR_WHEEL_ACKERMANN;
+
+  template <typename T>
+  static inline T forwardSpeed(const T& speed, const T& steering)
+  {
+    T half_tan = 0.5 * tan(steering);
+    return speed / sqrt(1.0 + half_tan * half_tan);
+  }
+
+  template <typename T>
+  static inline T yawRate(const T& speed, const T& steering, float wheelbase)
+  {
+    return forwardSpeed(speed, steering) * tan(steering) / wheelbase;
+  }
+
+  static inline double forwardSpeedDerivatives(double speed, double steering, double& d_steering)
+  {
+    double cos_steering = cos(steering);
+    double half_tan = 0.5 * tan(steering);
+    double cos_beta = 1.0 / sqrt(1.0 + half_tan * half_tan);
+    // d(cos(beta))/d(steering) = -cos(beta)^3 * tan(steering) / (4 cos(steering)^2)
+    d_steering = -speed * cos_beta * cos_beta * cos_beta * half_tan / (2.0 * cos_steering * cos_steering);
+    return cos_beta;
+  }
+
+  static inline double yawRateDerivatives(double speed, double steering, double wheelbase, double& d_steering)
+  {
+    double cos_steering = cos(steering);
+    double tan_steering = tan(steering);
+    double forward_d_steering;
+    double forward_d_speed = forwardSpeedDerivatives(speed, steering, forward_d_steering);
+    d_steering = (forward_d_steering * tan_steering + speed * forward_d_speed / (cos_steering * cos_steering))
+        / wheelbase;
+    return forward_d_speed * tan_steering / wheelbase;
+  }
+};
+
+/**
+ * \brief Skid steer, there is no steering angle, so the steering angle field
+ * carries the yaw rate (deg/s in the message, rad/s here) and the wheelbase
+ * is not used.
+ */
+struct SkidSteerModel
+{
+  static const KinematicModel MODEL = KINEMATIC_SKID_STEER;
+
+  template <typename T>
+  static inline T forwardSpeed(const T& speed, const T& steering)
+  {
+    return speed;
+  }
+
+  template <typename T>
+  static inline T yawRate(const T& speed, const T& steering, float wheelbase)
+  {
+    return steering;
+  }
+
+  static inline double forwardSpeedDerivatives(double speed, double steering, double& d_steering)
+  {
+    d_steering = 0.0;
+    return 1.0;
+  }
+
+  static inline double yawRateDerivatives(double speed, double steering, double wheelbase, double& d_steering)
+  {
+    d_steering = 1.0;
+    return 0.0;
+  }
+};
+
+/**
+ * \brief Length of the chord of an arc divided by the length of the arc,
+ * sin(h) / h for half the yaw increment h, 1 in the straight line limit.
+ */
+inline float arcChordFactor(float half_increment)
+{
+  return fabs(half_increment) < 5e-7 ? 1.0 : sin(half_increment) / half_increment;
+}
+
+template <int N>
+inline Eigen::Array<float, N, 1> arcChordFactor(const Eigen::Array<float, N, 1>& half_increment)
+{
+  return (half_increment.abs() < 5e-7f).select(Eigen::Array<float, N, 1>::Ones(),
+                                               sin(half_increment) / half_increment);
+}
+
+/**
+ * \brief Displacement in the odom frame over one step, one specialization per
+ * integration method.
+ *
+ * The forward speed is constant along the step and the heading changes
+ * linearly from yaw_start to yaw_start + yaw_increment.
+ *
+ * @param distance is the forward speed times the step time.
+ */
+template <IntegrationMethod Method>
+struct StepDisplacement
+{
+  // euler, heading at the end of the step
+  template <typename T>
+  static inline void apply(const T& distance, const T& yaw_start, const T& yaw_increment, T& delta_x, T& delta_y)
+  {
+    T yaw_end = yaw_start + yaw_increment;
+    delta_x = distance * cos(yaw_end);
+    delta_y = distance * sin(yaw_end);
+  }
+};
+
+template <>
+struct StepDisplacement<INTEGRATION_MIDPOINT>
+{
+  template <typename T>
+  static inline void apply(const T& distance, const T& yaw_start, const T& yaw_increment, T& delta_x, T& delta_y)
+  {
+    T yaw_middle = yaw_start + 0.5 * yaw_increment;
+    delta_x = distance * cos(yaw_middle);
+    delta_y = distance * sin(yaw_middle);
+  }
+};
+
+template <>
+struct StepDisplacement<INTEGRATION_RK4>
+{
+  template <typename T>
+  static inline void apply(const T& distance, const T& yaw_start, const T& yaw_increment, T& delta_x, T& delta_y)
+  {
+    // the heading does not depend on the position, so k2 = k3
+    T yaw_end = yaw_start + yaw_increment;
+    T yaw_middle = yaw_start + 0.5 * yaw_increment;
+    delta_x = distance * (cos(yaw_start) + 4.0 * cos(yaw_middle) + cos(yaw_end)) / 6.0;
+    delta_y = distance * (sin(yaw_start) + 4.0 * sin(yaw_middle) + sin(yaw_end)) / 6.0;
+  }
+};
+
+template <>
+struct StepDisplacement<INTEGRATION_EXACT_ARC>
+{
+  template <typename T>
+  static inline void apply(const T& distance, const T& yaw_start, const T& yaw_increment, T& delta_x, T& delta_y)
+  {
+    // the chord of the arc is along the middle heading, this form does not
+    // cancel in float for small increments like the difference of sines
+    T yaw_middle = yaw_start + 0.5 * yaw_increment;
+    T half_increment = 0.5 * yaw_increment;
+    T chord = distance * arcChordFactor(half_increment);
+    delta_x = chord * cos(yaw_middle);
+    delta_y = chord * sin(yaw_middle);
+  }
+};
+
+/**
+ * \brief Displacement in the odom frame over one step with the integration
+ * method Method, see StepDisplacement.
+ */
+template <IntegrationMethod Method, typename T>
+inline void stepDisplacement(const T& distance, const T& yaw_start, const T& yaw_increment, T& delta_x, T& delta_y)
+{
+  StepDisplacement<Method>::apply(distance, yaw_start, yaw_increment, delta_x, delta_y);
+}
+
+#endif /* _kinematic_models_h_ */
@@ -0,0 +1,400 @@
+/**
+ * \file odometry_integrator.h
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: m.a.munoz
+ */
+
+#ifndef _odometry_integrator_h_
+#define _odometry_integrator_h_
+
+#include "ros/time.h"
+#include "kinematic_models.h"
+#include <Eigen/Dense>
+
+// distance from the anchor in [m] at which the long mission mode moves the
+// float pose into the double anchor, where the float resolution is about 8 um
+#define REANCHOR_DISTANCE 64.0
+
+/**
+ * \brief Ackermann odometry integrator
+ *
+ * Holds the whole state of the odometry integration: the pose and its
+ * covariance, the time of the previous sample and the sample timing statistics. Every instance is
+ * independent, so several vehicles or replay segments can be integrated in the
+ * same process, each one from its own thread, and an instance can be reset or
+ * seeded with a known pose at any time.
+ *
+ * In 3D the speed is projected along the full imu attitude, so the planar
+ * pose advances with the horizontal part of the motion and z is integrated
+ * from the slope.
+ *
+ * The position is the double anchor plus the float pose integrated from it.
+ * In the long mission mode the float pose is accumulated with compensated
+ * (Kahan) summation and moved into the anchor every REANCHOR_DISTANCE, so the
+ * small increments are not rounded away after kilometres of integration.
+ * Otherwise the anchor is only set by seed() and the float pose is a plain sum.
+ *
+ * The integration step is instantiated for every kinematic model, yaw source
+ * and integration method, and the one in use is bound once in
+ * setKinematicModel() and setIntegrationMethod(), so the step has no branches
+ * on them. Building with FIXED_KINEMATIC_MODEL (see
+ * KINEMATIC_MODEL in CMakeLists.txt) compiles a single model.
+ */
+class OdometryIntegrator
+{
+private:
+
+  // integrated pose, relative to the anchor for the position
+  float pose_x_;
+  float pose_y_;
+  float pose_yaw_;
+  float pose_z_;
+
+  // anchor of the position
+  double anchor_x_;
+  double anchor_y_;
+  double anchor_z_;
+
+  // low order bits lost by the float sums of the position (long mission mode)
+  float compensation_x_;
+  float compensation_y_;
+  float compensation_z_;
+  bool long_mission_;
+
+  // attitude of the last 3D sample
+  Eigen::Quaterniond attitude_;
+
+  // horizontal part and slope of the heading direction of the last sample,
+  // cos(pitch) and -sin(pitch), 1 and 0 in 2D
+  float horizontal_;
+  float vertical_;
+  // covariance of x, y and yaw, propagated to first order through the model
+  Eigen::Matrix3d covariance_;
+  double z_variance_;
+
+  // noise of the ackermann inputs, speed [m^2/s^2] and steering angle [rad^2]
+  double speed_variance_;
+  double steering_variance_;
+
+  // velocity of the last integrated sample in the odom frame
+  float speed_x_;
+  float speed_y_;
+  float speed_z_;
+
+  // angular velocity of the last integrated sample in the base_link frame,
+  // from the attitude change over the step
+  float angular_speed_x_;
+  float angular_speed_y_;
+  float angular_speed_z_;
+
+  // sample timing
+  bool use_header_stamp_;
+  double max_sample_gap_;
+  float max_speed_;
+  bool first_sample_;
+  ros::Time last_stamp_;
+  ros::Time stamp_;
+
+  // distance between axles [m], used when the yaw is not read from the imu
+  float wheelbase_;
+
+  // configuration of the bound steps
+  KinematicModel model_;
+  bool use_imu_;
+  IntegrationMethod method_;
+
+  typedef bool (OdometryIntegrator::*StepFunction)(const ros::Time& stamp, float lineal_speed, float steering_radians,
+                                                    float imu_yaw, double imu_yaw_variance, float horizontal,
+                                                    float vertical, const Eigen::Quaterniond* attitude,
+                                                    double pitch_variance);
+
+  // steps of the kinematic model in use, with the configured yaw source and with the imu yaw (3D)
+  StepFunction step_;
+  StepFunction step_imu_;
+
+  /**
+   * \brief Binds the steps of the configured model, yaw source and integration method.
+   */
+  void bindStep(void);
+
+  /**
+   * \brief Binds the steps of the configured model with an integration method.
+   */
+  template <IntegrationMethod Method>
+  void bindMethod(void);
+
+  /**
+   * \brief Binds the steps of a kinematic model and an integration method.
+   */
+  template <class Model, IntegrationMethod Method>
+  void bindModel(void);
+
+  /**
+   * \brief Adds an increment to a float coordinate of the pose.
+   *
+   * In the long mission mode the sum is compensated, so the low order bits of
+   * the increment rounded away by the sum are kept in compensation and added
+   * back in the next step.
+   */
+  float accumulate(float coordinate, float increment, float& compensation) const
+  {
+    if (!this->long_mission_)
+      return coordinate + increment;
+
+    float corrected = increment - compensation;
+    float sum = coordinate + corrected;
+    compensation = (sum - coordinate) - corrected;
+    return sum;
+  }
+
+  /**
+   * \brief Moves the float pose into the anchor.
+   */
+  void reanchor(void);
+
+  /**
+   * \brief compute delta time
+   *
+   * Computes the time elapsed since the previous sample. If use_header_stamp is
+   * set the sample stamp is used, otherwise the node clock. Duplicated and out
+   * of order samples are rejected, and after a gap the integration restarts from
+   * the current sample with zero elapsed time.
+   *
+   * @param stamp is the header stamp of the current sample.
+   * @param delta_t is the elapsed time in [s].
+   * \return true if the sample has to be integrated.
+   */
+  bool computeDeltaT(const ros::Time& stamp, float& delta_t);
+
+  /**
+   * \brief Propagates the pose covariance over one step.
+   *
+   * Uses the jacobians of the step displacement with respect to the previous
+   * pose and to the speed, steering and imu yaw noises. Fixed size, so nothing
+   * is allocated.
+   */
+  template <class Model, bool UseImu>
+  void propagateCovariance(float lineal_speed, float steering_radians, float delta_t, float yaw_middle,
+                           float horizontal, float vertical, double imu_yaw_variance, double pitch_variance);
+
+  /**
+   * \brief Integrates one sample, shared by integrate() and integrate3D().
+   *
+   * The yaw is read from the imu if UseImu is set, otherwise it is integrated
+   * from the yaw rate of the model.
+   *
+   * @param horizontal is the horizontal part of the heading direction, cos(pitch).
+   * @param vertical is the slope of the heading direction, -sin(pitch).
+   * @param attitude is the attitude of the sample, NULL in 2D.
+   * @param pitch_variance is the variance of the pitch in [rad^2].
+   */
+  template <class Model, bool UseImu, IntegrationMethod Method>
+  bool integrateStep(const ros::Time& stamp, float lineal_speed, float steering_radians, float imu_yaw,
+                     double imu_yaw_variance, float horizontal, float vertical, const Eigen::Quaterniond* attitude,
+                     double pitch_variance);
+
+public:
+
+  // sample timing statistics (header stamp mode)
+  unsigned long duplicated_samples_;
+  unsigned long out_of_order_samples_;
+  unsigned long gapped_samples_;
+
+  /**
+   * \brief Constructor of OdometryIntegrator class
+   *
+   * Starts at the origin, integrating with the node clock, with the tricycle
+   * model and the imu yaw.
+   */
+  OdometryIntegrator(void);
+
+  /**
+   * \brief Sets how the time between samples is computed.
+   *
+   * @param use_header_stamp selects the sample stamps instead of the node clock.
+   * @param max_sample_gap is the maximum time in [s] integrated between two samples.
+   */
+  void setTiming(bool use_header_stamp, double max_sample_gap);
+
+  /**
+   * \brief Sets the maximum vehicle speed in [m/s].
+   *
+   * A step longer than the vehicle can drive at this speed in the time of
+   * the step is discarded as a jump, so the limit scales with the sample rate.
+   */
+  void setMaxSpeed(float max_speed);
+
+  /**
+   * \brief Sets the distance between axles in [m].
+   */
+  void setWheelbase(float wheelbase);
+
+  /**
+   * \brief Selects the kinematic model and the yaw source.
+   *
+   * The model is ignored, with a warning if it is not the compiled one, if
+   * the integrator was built with FIXED_KINEMATIC_MODEL, which sets it at
+   * compile time.
+   *
+   * @param model is the kinematic model of the vehicle.
+   * @param use_imu selects the imu yaw as the vehicle heading instead of integrating the model yaw rate.
+   */
+  void setKinematicModel(KinematicModel model, bool use_imu);
+
+  /**
+   * \brief Sets the integration method of the pose.
+   *
+   * Euler uses the heading at the end of the step. Midpoint and RK4 sample the
+   * heading along the step, and the exact arc integrates the constant curvature
+   * path in closed form, so it stays exact at low rates.
+   */
+  void setIntegrationMethod(IntegrationMethod method);
+
+  /**
+   * \brief Sets the variances of the ackermann inputs used to propagate the covariance.
+   *
+   * @param speed_variance is the variance of the speed in [m^2/s^2].
+   * @param steering_variance is the variance of the steering angle in [rad^2].
+   */
+  void setInputVariances(double speed_variance, double steering_variance);
+
+  /**
+   * \brief Selects the long mission accumulation of the position.
+   *
+   * @param long_mission selects the compensated float sums re-anchored in
+   * double precision every REANCHOR_DISTANCE instead of plain float sums.
+   */
+  void setLongMission(bool long_mission);
+
+  /**
+   * \brief Moves the pose back to the origin and forgets the previous sample
+   * and the timing statistics.
+   */
+  void reset(void);
+
+  /**
+   * \brief Starts the integration from a known pose, with zero covariance.
+   *
+   * The next sample is integrated from the given stamp.
+   */
+  void seed(double x, double y, float yaw, const ros::Time& stamp);
+
+  /**
+   * \brief Integrates an ackermann sample.
+   *
+   * @param stamp is the header stamp of the sample.
+   * @param lineal_speed is the vehicle speed in [m/s].
+   * @param steering_radians is the steering angle in [rad].
+   * @param imu_yaw is the heading read from the imu in [rad], not used if the
+   * yaw is integrated from the model.
+   * @param imu_yaw_variance is the variance of imu_yaw in [rad^2].
+   * \return false if the sample was rejected by its stamp and the state was not changed.
+   */
+  bool integrate(const ros::Time& stamp, float lineal_speed, float steering_radians, float imu_yaw,
+                 double imu_yaw_variance)
+  {
+    return (this->*step_)(stamp, lineal_speed, steering_radians, imu_yaw, imu_yaw_variance, 1.0, 0.0, NULL, 0.0);
+  }
+
+  /**
+   * \brief Integrates an ackermann sample along the full imu attitude.
+   *
+   * The heading, the horizontal part and the slope of the motion are read from
+   * a single rotation matrix of the attitude. The yaw is always the imu yaw.
+   *
+   * @param stamp is the header stamp of the sample.
+   * @param lineal_speed is the vehicle speed in [m/s].
+   * @param steering_radians is the steering angle in [rad].
+   * @param attitude is the normalized imu orientation.
+   * @param imu_yaw_variance is the variance of the imu yaw in [rad^2].
+   * @param imu_pitch_variance is the variance of the imu pitch in [rad^2].
+   * \return false if the sample was rejected by its stamp and the state was not changed.
+   */
+  bool integrate3D(const ros::Time& stamp, float lineal_speed, float steering_radians,
+                   const Eigen::Quaterniond& attitude, double imu_yaw_variance, double imu_pitch_variance);
+
+  double getX(void) const
+  {
+    return anchor_x_ + pose_x_;
+  }
+
+  double getY(void) const
+  {
+    return anchor_y_ + pose_y_;
+  }
+
+  float getYaw(void) const
+  {
+    return pose_yaw_;
+  }
+
+  double getZ(void) const
+  {
+    return anchor_z_ + pose_z_;
+  }
+
+  /**
+   * \brief Attitude of the last sample integrated with integrate3D().
+   */
+  const Eigen::Quaterniond& getAttitude(void) const
+  {
+    return attitude_;
+  }
+
+  /**
+   * \brief Variance of z, from the speed and pitch noises.
+   */
+  double getZVariance(void) const
+  {
+    return z_variance_;
+  }
+
+  /**
+   * \brief Covariance of x, y and yaw.
+   */
+  const Eigen::Matrix3d& getCovariance(void) const
+  {
+    return covariance_;
+  }
+
+  float getSpeedX(void) const
+  {
+    return speed_x_;
+  }
+
+  float getSpeedY(void) const
+  {
+    return speed_y_;
+  }
+
+  float getSpeedZ(void) const
+  {
+    return speed_z_;
+  }
+
+  float getAngularSpeedX(void) const
+  {
+    return angular_speed_x_;
+  }
+
+  float getAngularSpeedY(void) const
+  {
+    return angular_speed_y_;
+  }
+
+  float getAngularSpeedZ(void) const
+  {
+    return angular_speed_z_;
+  }
+
+  /**
+   * \brief Stamp of the last integrated sample, the header stamp or the node clock.
+   */
+  const ros::Time& getStamp(void) const
+  {
+    return stamp_;
+  }
+};
+
+#endif /* _odometry_integrator_h_ */
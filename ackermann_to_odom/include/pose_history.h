@@ -0,0 +1,133 @@
+/**
+ * \file pose_history.h
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: m.a.munoz
+ */
+
+#ifndef _pose_history_h_
+#define _pose_history_h_
+
+#include "ros/time.h"
+#include <boost/atomic.hpp>
+#include <boost/scoped_array.hpp>
+#include <boost/shared_ptr.hpp>
+#include <stdint.h>
+#include <string>
+
+// default capacity of the pose history (about 40 s of odometry at 50 Hz)
+#define POSE_HISTORY_SIZE 2048
+
+/**
+ * \brief Pose at a given time, position and orientation quaternion
+ */
+struct Pose3D
+{
+  ros::Time stamp;
+  double x;
+  double y;
+  double z;
+  double qx;
+  double qy;
+  double qz;
+  double qw;
+};
+
+/**
+ * \brief Bounded history of odometry poses
+ *
+ * Ring buffer of poses ordered by stamp, written by a single thread (the
+ * odometry integration) and read without locks by any number of threads.
+ * Every entry is protected by a sequence number, so a reader detects entries
+ * overwritten while it was reading them and retries. The pose at a given time
+ * is found by binary search and interpolated between the two closest entries,
+ * linearly for the position and by slerp for the orientation.
+ *
+ * Nodelets in the same process share the history through instance(), so a
+ * single buffer serves every consumer. The odometry node names its history
+ * after its private namespace, so every writer has its own buffer.
+ */
+class PoseHistory
+{
+private:
+
+  struct Entry
+  {
+    // 2 * index + 1 while written, 2 * index + 2 once index is stored
+    boost::atomic<uint64_t> sequence;
+    double stamp;
+    double x;
+    double y;
+    double z;
+    double qx;
+    double qy;
+    double qz;
+    double qw;
+  };
+
+  boost::scoped_array<Entry> entries_;
+  uint64_t capacity_;
+
+  // number of poses pushed since construction
+  boost::atomic<uint64_t> head_;
+
+  // stamp of the last pushed pose, only used by the writer
+  double last_stamp_;
+
+  /**
+   * \brief Reads the entry with the given index.
+   *
+   * \return false if the entry was not written yet or was overwritten.
+   */
+  bool read(uint64_t index, Pose3D& pose) const;
+
+  /**
+   * \brief Pose at a given time, for a snapshot of the history.
+   *
+   * \return 1 on success, 0 if the time is out of the history and -1 if the
+   * history changed under the reader and the query has to be repeated.
+   */
+  int tryQuery(const ros::Time& stamp, Pose3D& pose) const;
+
+public:
+
+  /**
+   * \brief Constructor of PoseHistory class
+   *
+   * @param capacity is the maximum number of poses kept.
+   */
+  explicit PoseHistory(size_t capacity = POSE_HISTORY_SIZE);
+
+  /**
+   * \brief Adds a pose. Only one thread can call it.
+   *
+   * @param pose is the pose and its stamp, with a normalized quaternion.
+   * \return false if the stamp is not newer than the last pose.
+   */
+  bool push(const Pose3D& pose);
+
+  /**
+   * \brief Pose at a given time, interpolated between the two closest poses.
+   *
+   * Lock-free, can be called from any thread. The lookup is O(log n).
+   *
+   * \return false if the time is not covered by the history.
+   */
+  bool query(const ros::Time& stamp, Pose3D& pose) const;
+
+  /**
+   * \brief Number of poses in the history.
+   */
+  size_t size(void) const;
+
+  /**
+   * \brief History of the given name shared in the process, created the first
+   * time it is requested.
+   *
+   * @param name is the private namespace of the node that writes the history,
+   * for example "/ackermann_to_odom".
+   */
+  static boost::shared_ptr<PoseHistory> instance(const std::string& name, size_t capacity = POSE_HISTORY_SIZE);
+};
+
+#endif /* _pose_history_h_ */
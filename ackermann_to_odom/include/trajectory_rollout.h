@@ -0,0 +1,227 @@
+/**
+ * \file trajectory_rollout.h
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: m.a.munoz
+ */
+
+#ifndef _trajectory_rollout_h_
+#define _trajectory_rollout_h_
+
+#include "kinematic_models.h"
+#include <boost/atomic.hpp>
+#include <boost/thread.hpp>
+#include <Eigen/StdVector>
+#include <vector>
+
+// rollouts integrated together, one fixed size Eigen array (SIMD registers) per state variable
+#define ROLLOUT_BLOCK 16
+
+/**
+ * \brief Structure of arrays of K control sequences and their trajectories
+ *
+ * Every array is stored step major: the values of all the rollouts for one
+ * step are contiguous, padded to a multiple of ROLLOUT_BLOCK. The controls
+ * are the inputs of each step, and x, y and yaw the pose at the end of it.
+ */
+class RolloutBatch
+{
+private:
+
+  typedef std::vector<float, Eigen::aligned_allocator<float> > Buffer;
+
+  int rollouts_;
+  int steps_;
+  int stride_;
+
+  Buffer speed_;
+  Buffer steering_;
+  Buffer x_;
+  Buffer y_;
+  Buffer yaw_;
+
+public:
+
+  /**
+   * \brief Constructor of RolloutBatch class
+   *
+   * @param rollouts is the number of control sequences K.
+   * @param steps is the number of steps of every sequence.
+   */
+  RolloutBatch(int rollouts = 0, int steps = 0);
+
+  /**
+   * \brief Changes the size of the batch, with all the controls set to zero.
+   */
+  void resize(int rollouts, int steps);
+
+  int rollouts(void) const
+  {
+    return rollouts_;
+  }
+
+  int steps(void) const
+  {
+    return steps_;
+  }
+
+  /**
+   * \brief Distance between the values of two consecutive steps.
+   */
+  int stride(void) const
+  {
+    return stride_;
+  }
+
+  /**
+   * \brief Speeds in [m/s] of every rollout at a step.
+   */
+  float* speed(int step)
+  {
+    return &speed_[step * stride_];
+  }
+
+  const float* speed(int step) const
+  {
+    return &speed_[step * stride_];
+  }
+
+  /**
+   * \brief Steering angles in [rad] of every rollout at a step.
+   */
+  float* steering(int step)
+  {
+    return &steering_[step * stride_];
+  }
+
+  const float* steering(int step) const
+  {
+    return &steering_[step * stride_];
+  }
+
+  /**
+   * \brief Pose of every rollout at the end of a step.
+   */
+  float* x(int step)
+  {
+    return &x_[step * stride_];
+  }
+
+  const float* x(int step) const
+  {
+    return &x_[step * stride_];
+  }
+
+  float* y(int step)
+  {
+    return &y_[step * stride_];
+  }
+
+  const float* y(int step) const
+  {
+    return &y_[step * stride_];
+  }
+
+  float* yaw(int step)
+  {
+    return &yaw_[step * stride_];
+  }
+
+  const float* yaw(int step) const
+  {
+    return &yaw_[step * stride_];
+  }
+};
+
+/**
+ * \brief Batch trajectory rollout on the odometry kinematic models
+ *
+ * Integrates K control sequences of (speed, steering) from a start pose with
+ * the same kinematic model policies and step formulas as OdometryIntegrator
+ * (yaw integrated from the model yaw rate), so a planner predicts exactly the
+ * motion the odometry measures. The rollouts are integrated ROLLOUT_BLOCK at
+ * a time with Eigen arrays, which map to SIMD registers, and the blocks are
+ * shared by a pool of worker threads and the calling thread.
+ *
+ * rollout() must be called from one thread at a time.
+ */
+class TrajectoryRollout
+{
+private:
+
+  typedef void (TrajectoryRollout::*BlockFunction)(RolloutBatch& batch, int first) const;
+
+  // kernel of the kinematic model and the integration method, bound once in the constructor
+  BlockFunction block_;
+
+  float wheelbase_;
+
+  // current job
+  RolloutBatch* batch_;
+  float start_x_;
+  float start_y_;
+  float start_yaw_;
+  float delta_t_;
+  boost::atomic<int> next_block_;
+
+  // worker pool
+  boost::thread_group workers_;
+  int worker_count_;
+  boost::mutex mutex_;
+  boost::condition_variable work_ready_;
+  boost::condition_variable work_done_;
+  unsigned long generation_;
+  int pending_workers_;
+  bool stopping_;
+
+  /**
+   * \brief Integrates ROLLOUT_BLOCK rollouts starting at first.
+   */
+  template <class Model, IntegrationMethod Method>
+  void rolloutBlock(RolloutBatch& batch, int first) const;
+
+  /**
+   * \brief Binds the kernel of a kinematic model with an integration method.
+   */
+  template <IntegrationMethod Method>
+  void bindMethod(KinematicModel model);
+
+  /**
+   * \brief Integrates blocks of the current job until none is left.
+   */
+  void runBlocks(void);
+
+  void workerThread(void);
+
+public:
+
+  /**
+   * \brief Constructor of TrajectoryRollout class
+   *
+   * @param model is the kinematic model of the vehicle. It is ignored if the
+   * package was built with FIXED_KINEMATIC_MODEL.
+   * @param wheelbase is the distance between axles in [m].
+   * @param method is the integration method of every step.
+   * @param threads is the number of threads, including the calling one. The
+   * number of cores if it is not positive.
+   */
+  TrajectoryRollout(KinematicModel model, float wheelbase, IntegrationMethod method, int threads = 0);
+
+  /**
+   * \brief Destructor, stops the worker threads.
+   */
+  ~TrajectoryRollout(void);
+
+  /**
+   * \brief Integrates every control sequence of the batch.
+   *
+   * @param x is the x of the start pose in [m].
+   * @param y is the y of the start pose in [m].
+   * @param yaw is the yaw of the start pose in [rad].
+   * @param delta_t is the duration of every step in [s].
+   * @param batch has the controls, and gets the trajectories.
+   */
+  void rollout(float x, float y, float yaw, float delta_t, RolloutBatch& batch);
+};
+
+#endif /* _trajectory_rollout_h_ */
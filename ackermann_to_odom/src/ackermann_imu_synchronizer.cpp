@@ -0,0 +1,130 @@
+#include "ackermann_imu_synchronizer.h"
+#include <tf/tf.h>
+
+AckermannImuSynchronizer::AckermannImuSynchronizer(void) :
+    imu_buffer_(SYNC_IMU_BUFFER_SIZE), ackermann_buffer_(SYNC_ACKERMANN_BUFFER_SIZE)
+{
+  this->timeout_ = 0.1;
+  this->reset();
+}
+
+void AckermannImuSynchronizer::setTimeout(double timeout)
+{
+  this->timeout_ = timeout;
+}
+
+void AckermannImuSynchronizer::reset(void)
+{
+  this->imu_buffer_.clear();
+  this->ackermann_buffer_.clear();
+
+  this->last_imu_.x = 0.0;
+  this->last_imu_.y = 0.0;
+  this->last_imu_.z = 0.0;
+  this->last_imu_.w = 1.0;
+  this->last_imu_.yaw_variance = 0.0;
+
+  this->interpolated_pairs_ = 0;
+  this->clamped_pairs_ = 0;
+  this->held_pairs_ = 0;
+  this->dropped_imu_samples_ = 0;
+  this->dropped_ackermann_samples_ = 0;
+}
+
+void AckermannImuSynchronizer::addImu(const sensor_msgs::Imu& imu)
+{
+  if (!this->imu_buffer_.empty() && imu.header.stamp <= this->imu_buffer_.back().stamp)
+  {
+    this->dropped_imu_samples_++;
+    return;
+  }
+
+  ImuEntry entry;
+  entry.stamp = imu.header.stamp;
+  entry.x = imu.orientation.x;
+  entry.y = imu.orientation.y;
+  entry.z = imu.orientation.z;
+  entry.w = imu.orientation.w;
+  entry.yaw_variance = imu.orientation_covariance[8];
+  this->imu_buffer_.push_back(entry);
+}
+
+void AckermannImuSynchronizer::addAckermann(const ackermann_msgs::AckermannDriveStamped& ackermann,
+                                            const ros::Time& arrival)
+{
+  if (this->ackermann_buffer_.full())
+    this->dropped_ackermann_samples_++;
+
+  AckermannEntry entry;
+  entry.header = ackermann.header;
+  entry.arrival = arrival;
+  entry.speed = ackermann.drive.speed;
+  entry.steering_angle = ackermann.drive.steering_angle;
+  this->ackermann_buffer_.push_back(entry);
+}
+
+bool AckermannImuSynchronizer::nextPair(ackermann_msgs::AckermannDriveStamped& ackermann, sensor_msgs::Imu& imu,
+                                        const ros::Time& now)
+{
+  if (this->ackermann_buffer_.empty())
+    return false;
+
+  const AckermannEntry& sample = this->ackermann_buffer_.front();
+  const ros::Time& stamp = sample.header.stamp;
+
+  tf::Quaternion orientation;
+  double yaw_variance;
+  if (!this->imu_buffer_.empty() && this->imu_buffer_.back().stamp >= stamp)
+  {
+    // the imu data covers the sample, keep only the entry just before it
+    while (this->imu_buffer_.size() > 1 && this->imu_buffer_[1].stamp <= stamp)
+      this->imu_buffer_.pop_front();
+
+    const ImuEntry& before = this->imu_buffer_[0];
+    if (before.stamp >= stamp)
+    {
+      if (before.stamp > stamp)
+        this->clamped_pairs_++;
+      else
+        this->interpolated_pairs_++;
+      orientation = tf::Quaternion(before.x, before.y, before.z, before.w);
+      yaw_variance = before.yaw_variance;
+    }
+    else
+    {
+      const ImuEntry& after = this->imu_buffer_[1];
+      double ratio = (stamp - before.stamp).toSec() / (after.stamp - before.stamp).toSec();
+      orientation = tf::Quaternion(before.x, before.y, before.z, before.w).slerp(
+          tf::Quaternion(after.x, after.y, after.z, after.w), ratio);
+      yaw_variance = before.yaw_variance + (after.yaw_variance - before.yaw_variance) * ratio;
+      this->interpolated_pairs_++;
+    }
+    this->last_imu_ = before;
+  }
+  else
+  {
+    // wait for imu data newer than the sample, unless the imu is late: newer
+    // ackermann samples are past the timeout when only the imu stopped, and
+    // the time since the sample arrived when both streams stopped
+    if ((this->ackermann_buffer_.back().header.stamp - stamp).toSec() <= this->timeout_
+        && (now - sample.arrival).toSec() <= this->timeout_)
+      return false;
+
+    if (!this->imu_buffer_.empty())
+      this->last_imu_ = this->imu_buffer_.back();
+    orientation = tf::Quaternion(this->last_imu_.x, this->last_imu_.y, this->last_imu_.z, this->last_imu_.w);
+    yaw_variance = this->last_imu_.yaw_variance;
+    this->held_pairs_++;
+  }
+
+  ackermann.header = sample.header;
+  ackermann.drive.speed = sample.speed;
+  ackermann.drive.steering_angle = sample.steering_angle;
+
+  imu.header.stamp = stamp;
+  tf::quaternionTFToMsg(orientation.normalized(), imu.orientation);
+  imu.orientation_covariance[8] = yaw_variance;
+
+  this->ackermann_buffer_.pop_front();
+  return true;
+}
@@ -1,9 +1,15 @@
 #include "ackermann_to_odom_alg.h"
 #include <time.h>
 
-AckermannToOdomAlgorithm::AckermannToOdomAlgorithm(void)
+AckermannToOdomAlgorithm::AckermannToOdomAlgorithm(void) :
+    imu_replay_(IMU_REPLAY_BUFFER_SIZE)
 {
   pthread_mutex_init(&this->access_, NULL);
+
+  this->config_ = Config::__getDefault__();
+  this->ackermann_covariance_received_ = false;
+  this->configureIntegrator(this->integrator_, this->config_);
+  this->resetImuRate();
 }
 
 AckermannToOdomAlgorithm::~AckermannToOdomAlgorithm(void)
@@ -15,142 +21,261 @@ void AckermannToOdomAlgorithm::config_update(Config& config, uint32_t level)
 {
   this->lock();
 
+  if (config.imu_rate_odometry != this->config_.imu_rate_odometry)
+    this->resetImuRate();
+
+  // the anchor of the imu rate odometry is replayed later, so it gets the same configuration
+  this->configureIntegrator(this->integrator_, config);
+  this->configureIntegrator(this->anchor_, config);
+
   // save the current configuration
   this->config_ = config;
 
   this->unlock();
 }
 
+void AckermannToOdomAlgorithm::configureIntegrator(OdometryIntegrator& integrator, const Config& config)
+{
+  // the imu rate samples are ordered and replayed by their header stamps
+  integrator.setTiming(config.use_header_stamp || config.imu_rate_odometry, config.max_sample_gap);
+  integrator.setMaxSpeed(config.max_speed);
+  integrator.setIntegrationMethod((IntegrationMethod)config.integration_method);
+  integrator.setWheelbase(config.wheelbase);
+  integrator.setKinematicModel((KinematicModel)config.kinematic_model, config.use_imu);
+  integrator.setLongMission(config.long_mission);
+  if (!this->ackermann_covariance_received_)
+    integrator.setInputVariances(config.speed_variance, config.steering_variance * DEG2RAD * DEG2RAD);
+}
+
+void AckermannToOdomAlgorithm::setAckermannCovariance(const ackermann_msgs::AckermannDriveStamped& covariance)
+{
+  this->ackermann_covariance_received_ = true;
+  this->integrator_.setInputVariances(covariance.drive.speed, covariance.drive.steering_angle * DEG2RAD * DEG2RAD);
+  this->anchor_.setInputVariances(covariance.drive.speed, covariance.drive.steering_angle * DEG2RAD * DEG2RAD);
+}
+
+bool AckermannToOdomAlgorithm::integrateSample(const ackermann_msgs::AckermannDriveStamped& estimated_ackermann_state,
+                                               const sensor_msgs::Imu& virtual_imu_msg, bool odometry_3d)
+{
+  //read information of low-level sensor
+  float lineal_speed = estimated_ackermann_state.drive.speed;
+  float steering_radians = estimated_ackermann_state.drive.steering_angle * DEG2RAD;
+
+  if (!odometry_3d)
+  {
+    //angle, only used if the yaw is read from the imu
+    double yaw = tf::getYaw(virtual_imu_msg.orientation);
+
+    return this->integrator_.integrate(estimated_ackermann_state.header.stamp, lineal_speed, steering_radians, yaw,
+                                       virtual_imu_msg.orientation_covariance[8]);
+  }
+
+  // the imu attitude is normalized once, the integrator reads yaw and slope from it
+  Eigen::Quaterniond attitude(virtual_imu_msg.orientation.w, virtual_imu_msg.orientation.x,
+                              virtual_imu_msg.orientation.y, virtual_imu_msg.orientation.z);
+  attitude.normalize();
+
+  return this->integrator_.integrate3D(estimated_ackermann_state.header.stamp, lineal_speed, steering_radians,
+                                       attitude, virtual_imu_msg.orientation_covariance[8],
+                                       virtual_imu_msg.orientation_covariance[4]);
+}
+
 // AckermannToOdomAlgorithm Public API
-void AckermannToOdomAlgorithm::generateNewOdometryMsg2D(ackermann_msgs::AckermannDriveStamped estimated_ackermann_state,
+bool AckermannToOdomAlgorithm::generateNewOdometryMsg2D(ackermann_msgs::AckermannDriveStamped estimated_ackermann_state,
                                                         sensor_msgs::Imu virtual_imu_msg,
                                                         geometry_msgs::PoseWithCovarianceStamped& odometry_pose,
                                                         nav_msgs::Odometry& odometry,
                                                         geometry_msgs::TransformStamped& odom_trans)
 {
+  if (!this->integrateSample(estimated_ackermann_state, virtual_imu_msg, false))
+    return false;
 
-  int i, j;
-  float pose_yaw = 0;
-  static float pose_yaw_prev = 0;
-  static float pose_x_prev = 0;
-  static float pose_y_prev = 0;
-  static double t_1;
-  static double t_2;
-  static bool first_exec = true;
-  float d_vehicle = 1.08; // TODO: get from param and modify git .rm
-  bool flag_imu = true; // TODO: get from param and modify git .rm
-  tf::Quaternion quaternion = tf::createQuaternionFromRPY(0, 0, 0);;
+  this->fillOdometryMsgs(virtual_imu_msg, false, odometry_pose, odometry, odom_trans);
+  return true;
+}
 
-  /////////////////////////////////////////////////
-  //// POSE AND VELOCITY
-  //calculate increment of time
-  if (first_exec)
-  {
-    t_2 = (double)ros::Time::now().toSec();
-    first_exec = false;
-  }
-  t_1 = (double)ros::Time::now().toSec();
-  float delta_t = (float)(t_1 - t_2);
-  t_2 = (double)ros::Time::now().toSec();
+bool AckermannToOdomAlgorithm::generateNewOdometryMsg3D(ackermann_msgs::AckermannDriveStamped estimated_ackermann_state,
+                                                        sensor_msgs::Imu virtual_imu_msg,
+                                                        geometry_msgs::PoseWithCovarianceStamped& odometry_pose,
+                                                        nav_msgs::Odometry& odometry,
+                                                        geometry_msgs::TransformStamped& odom_trans)
+{
+  if (!this->integrateSample(estimated_ackermann_state, virtual_imu_msg, true))
+    return false;
 
-  //read information of low-level sensor
-  float lineal_speed = estimated_ackermann_state.drive.speed;
-  float steering_radians = estimated_ackermann_state.drive.steering_angle * M_PI / 180.0;
+  this->fillOdometryMsgs(virtual_imu_msg, true, odometry_pose, odometry, odom_trans);
+  return true;
+}
+
+bool AckermannToOdomAlgorithm::propagateImu(const sensor_msgs::Imu& virtual_imu_msg,
+                                            geometry_msgs::PoseWithCovarianceStamped& odometry_pose,
+                                            nav_msgs::Odometry& odometry, geometry_msgs::TransformStamped& odom_trans)
+{
+  // nothing to propagate until the first speed is known
+  if (!this->ackermann_received_)
+    return false;
+
+  // the last speed and steering are held until the next ackermann sample
+  ackermann_msgs::AckermannDriveStamped held = this->last_ackermann_;
+  held.header.stamp = virtual_imu_msg.header.stamp;
+  if (!this->integrateSample(held, virtual_imu_msg, this->config_.odometry_3d))
+    return false;
+
+  if (this->imu_replay_.full())
+    this->replay_overflow_ = true;
+  this->imu_replay_.push_back(virtual_imu_msg);
+
+  this->fillOdometryMsgs(virtual_imu_msg, this->config_.odometry_3d, odometry_pose, odometry, odom_trans);
+  return true;
+}
 
-  //angle
-  if (flag_imu)
+void AckermannToOdomAlgorithm::correctAckermann(const ackermann_msgs::AckermannDriveStamped& estimated_ackermann_state)
+{
+  const ros::Time& stamp = estimated_ackermann_state.header.stamp;
+  bool odometry_3d = this->config_.odometry_3d;
+
+  if (this->ackermann_received_ && stamp <= this->last_ackermann_.header.stamp)
+    return;
+
+  if (!this->ackermann_received_ || this->replay_overflow_)
   {
-    tf::Quaternion q(virtual_imu_msg.orientation.x, virtual_imu_msg.orientation.y, virtual_imu_msg.orientation.z,
-                     virtual_imu_msg.orientation.w);
-    tf::Matrix3x3 m(q);
-    double roll, pitch, yaw;
-    m.getRPY(roll, pitch, yaw);
-    pose_yaw = yaw;
-    quaternion = tf::createQuaternionFromRPY(0, 0, pose_yaw);
+    // nothing to replay, the current state is the new anchor
+    if (this->ackermann_received_)
+      this->lost_corrections_++;
+    this->ackermann_received_ = true;
+    this->replay_overflow_ = false;
+    this->imu_replay_.clear();
+    this->last_ackermann_ = estimated_ackermann_state;
+    this->anchor_ = this->integrator_;
+    return;
   }
-  else
+
+  // replay the imu samples since the previous ackermann sample from its anchor,
+  // with the speed and steering interpolated between both samples
+  const ackermann_msgs::AckermannDriveStamped& previous = this->last_ackermann_;
+  double span = (stamp - previous.header.stamp).toSec();
+  this->integrator_ = this->anchor_;
+
+  ackermann_msgs::AckermannDriveStamped interpolated = estimated_ackermann_state;
+  while (!this->imu_replay_.empty() && this->imu_replay_.front().header.stamp <= stamp)
   {
-    float angular_speed_yaw = (lineal_speed / d_vehicle) * sin(steering_radians);
-    pose_yaw = pose_yaw_prev + angular_speed_yaw * delta_t;
-    quaternion = tf::createQuaternionFromRPY(0, 0, pose_yaw);
+    const sensor_msgs::Imu& imu = this->imu_replay_.front();
+    double ratio = (imu.header.stamp - previous.header.stamp).toSec() / span;
+    interpolated.header.stamp = imu.header.stamp;
+    interpolated.drive.speed = previous.drive.speed
+        + (estimated_ackermann_state.drive.speed - previous.drive.speed) * ratio;
+    interpolated.drive.steering_angle = previous.drive.steering_angle
+        + (estimated_ackermann_state.drive.steering_angle - previous.drive.steering_angle) * ratio;
+    this->integrateSample(interpolated, imu, odometry_3d);
+
+    this->anchor_imu_ = imu;
+    this->imu_replay_.pop_front();
   }
 
-  //pose
-  float lineal_speed_x = lineal_speed * cos(pose_yaw) * cos(steering_radians);
-  float lineal_speed_y = lineal_speed * sin(pose_yaw) * cos(steering_radians);
-  float pose_x = pose_x_prev + lineal_speed_x * delta_t;
-  float pose_y = pose_y_prev + lineal_speed_y * delta_t;
-  if (isnan(pose_yaw))
+  // the new anchor is at the ackermann sample, with the last imu orientation before it
+  if (this->integrator_.getStamp() < stamp)
+    this->integrateSample(estimated_ackermann_state, this->anchor_imu_, odometry_3d);
+  this->anchor_ = this->integrator_;
+  this->last_ackermann_ = estimated_ackermann_state;
+  this->corrections_++;
+
+  // the newer imu samples are integrated again with the new speed
+  ackermann_msgs::AckermannDriveStamped held = estimated_ackermann_state;
+  for (unsigned int i = 0; i < this->imu_replay_.size(); i++)
   {
-    lineal_speed_x = 0.0;
-    lineal_speed_y = 0.0;
-    pose_x = 0.0;
-    pose_y = 0.0;
-    quaternion = tf::createQuaternionFromRPY(0, 0, 0);
-    ROS_INFO("isnan(pose_yaw)");
+    held.header.stamp = this->imu_replay_[i].header.stamp;
+    this->integrateSample(held, this->imu_replay_[i], odometry_3d);
   }
+}
+
+void AckermannToOdomAlgorithm::resetImuRate(void)
+{
+  this->ackermann_received_ = false;
+  this->replay_overflow_ = false;
+  this->imu_replay_.clear();
+  this->anchor_imu_ = sensor_msgs::Imu();
+  this->anchor_imu_.orientation.w = 1.0;
+  this->corrections_ = 0;
+  this->lost_corrections_ = 0;
+}
+
+void AckermannToOdomAlgorithm::fillOdometryMsgs(const sensor_msgs::Imu& virtual_imu_msg, bool odometry_3d,
+                                                geometry_msgs::PoseWithCovarianceStamped& odometry_pose,
+                                                nav_msgs::Odometry& odometry,
+                                                geometry_msgs::TransformStamped& odom_trans)
+{
+  int i, j;
 
-  // For next step
-  if (abs(pose_x_prev - pose_x) < MAX_DIFF && abs(pose_y_prev - pose_y) < MAX_DIFF)
+  ros::Time stamp = this->integrator_.getStamp();
+  double pose_x = this->integrator_.getX();
+  double pose_y = this->integrator_.getY();
+  double pose_z = this->integrator_.getZ();
+
+  // the same quaternion is used in the messages and in the transform
+  geometry_msgs::Quaternion orientation;
+  double roll_variance = 0.0;
+  double pitch_variance = 0.0;
+  if (odometry_3d)
   {
-    pose_x_prev = pose_x;
-    pose_y_prev = pose_y;
-    pose_yaw_prev = pose_yaw;
+    const Eigen::Quaterniond& attitude = this->integrator_.getAttitude();
+    orientation.x = attitude.x();
+    orientation.y = attitude.y();
+    orientation.z = attitude.z();
+    orientation.w = attitude.w();
+    roll_variance = virtual_imu_msg.orientation_covariance[0];
+    pitch_variance = virtual_imu_msg.orientation_covariance[4];
   }
   else
-  {
-    pose_x = pose_x_prev;
-    pose_y = pose_y_prev;
-    pose_yaw = pose_yaw_prev;
-    quaternion = tf::createQuaternionFromRPY(0, 0, pose_yaw);
-  }
-  /////////////////////////////////////////////////
+    orientation = tf::createQuaternionMsgFromYaw(this->integrator_.getYaw());
 
   /////////////////////////////////////////////////
   //// GENERATE MESSAGE
   // Header
-  odometry.header.stamp = ros::Time::now();
+  odometry.header.stamp = stamp;
   odometry.header.frame_id = "odom";
   odometry.child_frame_id = "base_link";
-  odometry_pose.header.stamp = ros::Time::now();
+  odometry_pose.header.stamp = stamp;
   odometry_pose.header.frame_id = "odom";
 
   // Twist
-  odometry.twist.twist.linear.x = lineal_speed_x;
-  odometry.twist.twist.linear.y = lineal_speed_y;
-  odometry.twist.twist.linear.z = 0;
-  odometry.twist.twist.angular.x = 0;
-  odometry.twist.twist.angular.y = 0;
-  odometry.twist.twist.angular.z = 0;
+  odometry.twist.twist.linear.x = this->integrator_.getSpeedX();
+  odometry.twist.twist.linear.y = this->integrator_.getSpeedY();
+  odometry.twist.twist.linear.z = this->integrator_.getSpeedZ();
+  odometry.twist.twist.angular.x = this->integrator_.getAngularSpeedX();
+  odometry.twist.twist.angular.y = this->integrator_.getAngularSpeedY();
+  odometry.twist.twist.angular.z = this->integrator_.getAngularSpeedZ();
 
   // Pose
   odometry.pose.pose.position.x = pose_x;
   odometry.pose.pose.position.y = pose_y;
-  odometry.pose.pose.position.z = 0;
-  odometry.pose.pose.orientation.x = quaternion[0];
-  odometry.pose.pose.orientation.y = quaternion[1];
-  odometry.pose.pose.orientation.z = quaternion[2];
-  odometry.pose.pose.orientation.w = quaternion[3];
-  odometry_pose.pose.pose.position.x = pose_x;
-  odometry_pose.pose.pose.position.y = pose_y;
-  odometry_pose.pose.pose.position.z = 0;
-  odometry_pose.pose.pose.orientation.x = quaternion[0];
-  odometry_pose.pose.pose.orientation.y = quaternion[1];
-  odometry_pose.pose.pose.orientation.z = quaternion[2];
-  odometry_pose.pose.pose.orientation.w = quaternion[3];
-  odometry_pose.pose.covariance[0] = 0.5; // TODO: calculation of variances !!!
-  odometry_pose.pose.covariance[7] = 0.5;
-  odometry_pose.pose.covariance[35] = 0.5;
+  odometry.pose.pose.position.z = pose_z;
+  odometry.pose.pose.orientation = orientation;
+  odometry_pose.pose.pose = odometry.pose.pose;
+
+  // Covariance of x, y and yaw in the 6x6 row major pose covariance, and of
+  // z, roll and pitch, which are zero in 2D
+  const Eigen::Matrix3d& covariance = this->integrator_.getCovariance();
+  const int index[3] = {0, 1, 5};
+  odometry.pose.covariance.assign(0.0);
+  for (i = 0; i < 3; i++)
+  {
+    for (j = 0; j < 3; j++)
+      odometry.pose.covariance[6 * index[i] + index[j]] = covariance(i, j);
+  }
+  odometry.pose.covariance[6 * 2 + 2] = this->integrator_.getZVariance();
+  odometry.pose.covariance[6 * 3 + 3] = roll_variance;
+  odometry.pose.covariance[6 * 4 + 4] = pitch_variance;
+  odometry_pose.pose.covariance = odometry.pose.covariance;
   /////////////////////////////////////////////////
 
   ////////////////////////////////////////////////////////////////
   //// GENERATE MESSAGES TF
   odom_trans.header.frame_id = "odom";
   odom_trans.child_frame_id = "base_link";
-  odom_trans.header.stamp = ros::Time::now();
+  odom_trans.header.stamp = stamp;
   odom_trans.transform.translation.x = pose_x;
   odom_trans.transform.translation.y = pose_y;
-  odom_trans.transform.translation.z = 0.0;
-  odom_trans.transform.rotation = tf::createQuaternionMsgFromYaw(pose_yaw);
+  odom_trans.transform.translation.z = pose_z;
+  odom_trans.transform.rotation = orientation;
   ////////////////////////////////////////////////////////////////
 }
@@ -2,8 +2,29 @@
 
 AckermannToOdomAlgNode::AckermannToOdomAlgNode(void) :
     algorithm_base::IriBaseAlgorithm<AckermannToOdomAlgorithm>()
+{
+  this->init();
+}
+
+AckermannToOdomAlgNode::AckermannToOdomAlgNode(const ros::NodeHandle& node_handle, const ros::NodeHandle& private_node_handle) :
+    algorithm_base::IriBaseAlgorithm<AckermannToOdomAlgorithm>()
+{
+  // the topics, timers and parameters use the nodelet namespace and the
+  // callback queue of the manager
+  this->public_node_handle_ = node_handle;
+  this->private_node_handle_ = private_node_handle;
+  this->init();
+
+  // the base class server is on the private namespace of the manager, shared
+  // by all the nodelets of the manager
+  this->nodelet_reconfigure_server_.reset(new dynamic_reconfigure::Server<Config>(this->private_node_handle_));
+  this->nodelet_reconfigure_server_->setCallback(boost::bind(&AckermannToOdomAlgNode::nodeletConfigUpdate, this, _1, _2));
+}
+
+void AckermannToOdomAlgNode::init(void)
 {
   //init class attributes if necessary
+  this->node_loop_running_ = false;
   this->loop_rate_ = 10; //in [Hz]
   this->virtual_imu_msg_.orientation.x = 0.0;
   this->virtual_imu_msg_.orientation.y = 0.0;
@@ -11,18 +32,46 @@ AckermannToOdomAlgNode::AckermannToOdomAlgNode(void) :
   this->virtual_imu_msg_.orientation.w = 1.0;
   this->estimated_ackermann_state_.drive.speed = 0.0;
   this->estimated_ackermann_state_.drive.steering_angle = 0.0;
+  this->config_ = Config::__getDefault__();
+  this->synchronizer_.setTimeout(this->config_.sync_timeout);
+
+  this->odom_in_tf_ = false;
+  this->scan_in_tf_ = false;
+  // the private names, or the global ones read before the nodelets, so older launch files keep working
+  if (!this->private_node_handle_.getParam("odom_in_tf", this->odom_in_tf_))
+    this->public_node_handle_.getParam("/odom_in_tf", this->odom_in_tf_);
+  if (!this->private_node_handle_.getParam("scan_in_tf", this->scan_in_tf_))
+    this->public_node_handle_.getParam("/scan_in_tf", this->scan_in_tf_);
+  if (!this->private_node_handle_.getParam("frame_id", this->frame_id_))
+    this->public_node_handle_.getParam("/frame_id", this->frame_id_);
+  if (!this->private_node_handle_.getParam("child_id", this->child_id_))
+    this->public_node_handle_.getParam("/child_id", this->child_id_);
+  this->scan_trans_resolved_ = false;
+  // one history per node, so several odometry nodelets in a manager do not write the same ring
+  this->pose_history_ = PoseHistory::instance(this->private_node_handle_.getNamespace());
 
   // [init publishers]
   this->odometry_publisher_ = this->public_node_handle_.advertise < nav_msgs::Odometry > ("/odometry", 1);
   this->pose_publisher_ = this->public_node_handle_.advertise < geometry_msgs::PoseWithCovarianceStamped > ("/odometry_pose", 1);
 
   // [init subscribers]
+  // the queues hold as many samples as the synchronizer, so a late spin does
+  // not drop samples that the synchronizer and the imu rate replay would use
   this->estimated_ackermann_subscriber_ = this->public_node_handle_.subscribe(
-      "/estimated_ackermann_state", 1, &AckermannToOdomAlgNode::cb_ackermannState, this);
-  this->virtual_imu_subscriber_ = this->public_node_handle_.subscribe("/virtual_imu_data", 1,
+      "/estimated_ackermann_state", SYNC_ACKERMANN_BUFFER_SIZE, &AckermannToOdomAlgNode::cb_ackermannState, this);
+  this->virtual_imu_subscriber_ = this->public_node_handle_.subscribe("/virtual_imu_data", SYNC_IMU_BUFFER_SIZE,
                                                                       &AckermannToOdomAlgNode::cb_imuData, this);
+  this->covariance_ackermann_subscriber_ = this->public_node_handle_.subscribe(
+      "/covariance_ackermann_state", 1, &AckermannToOdomAlgNode::cb_ackermannCovariance, this);
+
+  // the static scan transform is resolved in the background, so the loop never waits for tf
+  if (this->scan_in_tf_)
+    this->scan_transform_timer_ = this->public_node_handle_.createTimer(
+        ros::Duration(1.0), &AckermannToOdomAlgNode::cb_scanTransformTimer, this);
 
   // [init services]
+  this->pose_at_time_server_ = this->public_node_handle_.advertiseService(
+      "/odometry_pose_at_time", &AckermannToOdomAlgNode::cb_getPoseAtTime, this);
 
   // [init clients]
 
@@ -34,57 +83,137 @@ AckermannToOdomAlgNode::AckermannToOdomAlgNode(void) :
 AckermannToOdomAlgNode::~AckermannToOdomAlgNode(void)
 {
   // [free dynamic memory]
+  this->stopNodeLoop();
+}
+
+void AckermannToOdomAlgNode::startNodeLoop(void)
+{
+  this->addNodeDiagnostics();
+  this->node_loop_running_ = true;
+  pthread_create(&this->node_loop_thread_, NULL, &AckermannToOdomAlgNode::nodeLoopThread, this);
+}
+
+void AckermannToOdomAlgNode::stopNodeLoop(void)
+{
+  if (!this->node_loop_running_)
+    return;
+  this->node_loop_running_ = false;
+  pthread_join(this->node_loop_thread_, NULL);
+}
+
+void AckermannToOdomAlgNode::nodeletConfigUpdate(Config &config, uint32_t level)
+{
+  this->alg_.config_update(config, level);
+  this->node_config_update(config, level);
+}
+
+void *AckermannToOdomAlgNode::nodeLoopThread(void *param)
+{
+  AckermannToOdomAlgNode *node = (AckermannToOdomAlgNode *)param;
+
+  while (node->node_loop_running_ && ros::ok())
+  {
+    node->mainNodeThread();
+    node->diagnostic_.update();
+    node->loop_rate_.sleep();
+  }
+
+  pthread_exit(NULL);
 }
 
 void AckermannToOdomAlgNode::mainNodeThread(void)
 {
-  static bool first_exec = true;
-  static bool odom_in_tf;
-  static bool scan_in_tf;
-  static std::string frame_id;
-  static std::string child_id;
+  this->alg_.lock();
 
-  // [read parameters]
-  if (first_exec)
+  // [fill msg structures]
+  // in header stamp mode the odometry is generated in cb_ackermannState, and
+  // in imu rate mode in cb_imuData
+  bool generated = false;
+  if (!this->config_.use_header_stamp && !this->config_.imu_rate_odometry)
+    generated = this->generateOdometry();
+  // releases the samples held for imu data when both streams stopped
+  else if (this->config_.use_header_stamp && !this->config_.imu_rate_odometry)
+    this->integrateSynchronized();
+
+  // [fill srv structure and make request to the server]
+
+  // [fill action structure and make request to the action server]
+
+  // [publish messages]
+  if (generated)
+    this->publishOdometry();
+
+  this->alg_.unlock();
+}
+
+void AckermannToOdomAlgNode::cb_scanTransformTimer(const ros::TimerEvent& event)
+{
+  if (!this->listener_.canTransform(this->frame_id_, this->child_id_, ros::Time(0)))
   {
-    this->public_node_handle_.getParam("/odom_in_tf", odom_in_tf);
-    this->public_node_handle_.getParam("/scan_in_tf", scan_in_tf);
-    this->public_node_handle_.getParam("/frame_id", frame_id);
-    this->public_node_handle_.getParam("/child_id", child_id);
-    first_exec = false;
+    ROS_WARN_THROTTLE(10.0, "Waiting for the transform from %s to %s", this->frame_id_.c_str(),
+                      this->child_id_.c_str());
+    return;
   }
 
-  // [listen transform]
+  tf::StampedTransform scan_trans;
   try
   {
-    this->listener_.lookupTransform(frame_id, child_id, ros::Time(0), this->scan_trans_);
+    this->listener_.lookupTransform(this->frame_id_, this->child_id_, ros::Time(0), scan_trans);
   }
   catch (tf::TransformException ex)
   {
     ROS_ERROR("%s", ex.what());
-    ros::Duration(1.0).sleep();
+    return;
   }
 
-  // [fill msg structures]
-  this->alg_.generateNewOdometryMsg2D(this->estimated_ackermann_state_, this->virtual_imu_msg_, this->odometry_pose_,
-                                      this->odometry_, this->odom_trans_);
-
-  // [fill srv structure and make request to the server]
+  this->alg_.lock();
+  tf::transformStampedTFToMsg(scan_trans, this->scan_trans_);
+  this->scan_trans_resolved_ = true;
+  this->alg_.unlock();
 
-  // [fill action structure and make request to the action server]
+  // latched, so it is sent only once
+  this->static_broadcaster_.sendTransform(this->scan_trans_);
+  this->scan_transform_timer_.stop();
+}
 
-  // [publish messages]
-  if (odom_in_tf)
+void AckermannToOdomAlgNode::publishOdometry(void)
+{
+  if (this->odom_in_tf_)
   {
     this->broadcaster_.sendTransform(this->odom_trans_);
   }
-  if (scan_in_tf)
+
+  Pose3D pose;
+  pose.stamp = this->odometry_.header.stamp;
+  pose.x = this->odometry_.pose.pose.position.x;
+  pose.y = this->odometry_.pose.pose.position.y;
+  pose.z = this->odometry_.pose.pose.position.z;
+  pose.qx = this->odometry_.pose.pose.orientation.x;
+  pose.qy = this->odometry_.pose.pose.orientation.y;
+  pose.qz = this->odometry_.pose.pose.orientation.z;
+  pose.qw = this->odometry_.pose.pose.orientation.w;
+  this->pose_history_->push(pose);
+
+  this->odometry_publisher_.publish(boost::make_shared<nav_msgs::Odometry>(this->odometry_));
+  this->pose_publisher_.publish(boost::make_shared<geometry_msgs::PoseWithCovarianceStamped>(this->odometry_pose_));
+}
+
+bool AckermannToOdomAlgNode::generateOdometry(void)
+{
+  if (this->config_.odometry_3d)
+    return this->alg_.generateNewOdometryMsg3D(this->estimated_ackermann_state_, this->virtual_imu_msg_,
+                                               this->odometry_pose_, this->odometry_, this->odom_trans_);
+  return this->alg_.generateNewOdometryMsg2D(this->estimated_ackermann_state_, this->virtual_imu_msg_,
+                                             this->odometry_pose_, this->odometry_, this->odom_trans_);
+}
+
+void AckermannToOdomAlgNode::integrateSynchronized(void)
+{
+  while (this->synchronizer_.nextPair(this->estimated_ackermann_state_, this->virtual_imu_msg_, ros::Time::now()))
   {
-    this->broadcaster_.sendTransform(this->scan_trans_);
+    if (this->generateOdometry())
+      this->publishOdometry();
   }
-
-  this->odometry_publisher_.publish(this->odometry_);
-  this->pose_publisher_.publish(this->odometry_pose_);
 }
 
 /*  [subscriber callbacks] */
@@ -93,9 +222,32 @@ void AckermannToOdomAlgNode::cb_ackermannState(
 {
   this->alg_.lock();
 
-  this->estimated_ackermann_state_.drive.speed = estimated_ackermann_state_msg->drive.speed;
-  this->estimated_ackermann_state_.drive.steering_angle = estimated_ackermann_state_msg->drive.steering_angle;
+  // in imu rate mode the ackermann sample corrects the propagated odometry,
+  // which is published with the next imu sample
+  if (this->config_.imu_rate_odometry)
+    this->alg_.correctAckermann(*estimated_ackermann_state_msg);
+  // in header stamp mode every ackermann sample is integrated with the imu
+  // orientation at its stamp, as soon as the imu data covers it
+  else if (this->config_.use_header_stamp)
+  {
+    this->synchronizer_.addAckermann(*estimated_ackermann_state_msg, ros::Time::now());
+    this->integrateSynchronized();
+  }
+  else
+  {
+    this->estimated_ackermann_state_.header = estimated_ackermann_state_msg->header;
+    this->estimated_ackermann_state_.drive.speed = estimated_ackermann_state_msg->drive.speed;
+    this->estimated_ackermann_state_.drive.steering_angle = estimated_ackermann_state_msg->drive.steering_angle;
+  }
+
+  this->alg_.unlock();
+}
 
+void AckermannToOdomAlgNode::cb_ackermannCovariance(
+    const ackermann_msgs::AckermannDriveStamped::ConstPtr& covariance_ackermann_state_msg)
+{
+  this->alg_.lock();
+  this->alg_.setAckermannCovariance(*covariance_ackermann_state_msg);
   this->alg_.unlock();
 }
 
@@ -103,15 +255,47 @@ void AckermannToOdomAlgNode::cb_imuData(const sensor_msgs::Imu::ConstPtr& Imu_ms
 {
   this->alg_.lock();
 
+  this->virtual_imu_msg_.header = Imu_msg->header;
   this->virtual_imu_msg_.orientation.x = Imu_msg->orientation.x;
   this->virtual_imu_msg_.orientation.y = Imu_msg->orientation.y;
   this->virtual_imu_msg_.orientation.z = Imu_msg->orientation.z;
   this->virtual_imu_msg_.orientation.w = Imu_msg->orientation.w;
+  this->virtual_imu_msg_.orientation_covariance = Imu_msg->orientation_covariance;
+
+  if (this->config_.imu_rate_odometry)
+  {
+    if (this->alg_.propagateImu(*Imu_msg, this->odometry_pose_, this->odometry_, this->odom_trans_))
+      this->publishOdometry();
+  }
+  else if (this->config_.use_header_stamp)
+  {
+    this->synchronizer_.addImu(*Imu_msg);
+    this->integrateSynchronized();
+  }
 
   this->alg_.unlock();
 }
 
 /*  [service callbacks] */
+bool AckermannToOdomAlgNode::cb_getPoseAtTime(ackermann_to_odom::GetPoseAtTime::Request &req,
+                                              ackermann_to_odom::GetPoseAtTime::Response &res)
+{
+  Pose3D pose;
+  res.success = this->pose_history_->query(req.stamp, pose);
+  if (!res.success)
+    return true;
+
+  res.pose.header.stamp = pose.stamp;
+  res.pose.header.frame_id = "odom";
+  res.pose.pose.position.x = pose.x;
+  res.pose.pose.position.y = pose.y;
+  res.pose.pose.position.z = pose.z;
+  res.pose.pose.orientation.x = pose.qx;
+  res.pose.pose.orientation.y = pose.qy;
+  res.pose.pose.orientation.z = pose.qz;
+  res.pose.pose.orientation.w = pose.qw;
+  return true;
+}
 
 /*  [action callbacks] */
 
@@ -120,16 +304,57 @@ void AckermannToOdomAlgNode::cb_imuData(const sensor_msgs::Imu::ConstPtr& Imu_ms
 void AckermannToOdomAlgNode::node_config_update(Config &config, uint32_t level)
 {
   this->alg_.lock();
+  if (config.use_header_stamp != this->config_.use_header_stamp)
+    this->synchronizer_.reset();
+  this->synchronizer_.setTimeout(config.sync_timeout);
   this->config_ = config;
   this->alg_.unlock();
 }
 
 void AckermannToOdomAlgNode::addNodeDiagnostics(void)
 {
+  this->diagnostic_.add("Ackermann odometry timing", this, &AckermannToOdomAlgNode::timingDiagnostic);
+}
+
+void AckermannToOdomAlgNode::timingDiagnostic(diagnostic_updater::DiagnosticStatusWrapper &stat)
+{
+  this->alg_.lock();
+
+  if (this->config_.imu_rate_odometry)
+    stat.summary(diagnostic_msgs::DiagnosticStatus::OK, "Propagating at imu rate, corrected by ackermann samples");
+  else if (this->config_.use_header_stamp)
+    stat.summary(diagnostic_msgs::DiagnosticStatus::OK, "Integrating ackermann samples by header stamp");
+  else
+    stat.summary(diagnostic_msgs::DiagnosticStatus::OK, "Integrating at loop rate with the node clock");
+
+  if (this->scan_in_tf_)
+  {
+    stat.add("Scan transform resolved", this->scan_trans_resolved_);
+    if (!this->scan_trans_resolved_)
+      stat.mergeSummary(diagnostic_msgs::DiagnosticStatus::WARN, "Waiting for the scan transform");
+  }
+  stat.add("Duplicated samples", this->alg_.integrator_.duplicated_samples_);
+  stat.add("Out of order samples", this->alg_.integrator_.out_of_order_samples_);
+  stat.add("Gapped samples", this->alg_.integrator_.gapped_samples_);
+  stat.add("Interpolated imu pairs", this->synchronizer_.interpolated_pairs_);
+  stat.add("Clamped imu pairs", this->synchronizer_.clamped_pairs_);
+  stat.add("Held imu pairs", this->synchronizer_.held_pairs_);
+  stat.add("Dropped imu samples", this->synchronizer_.dropped_imu_samples_);
+  stat.add("Dropped ackermann samples", this->synchronizer_.dropped_ackermann_samples_);
+  if (this->synchronizer_.dropped_ackermann_samples_ > 0)
+    stat.mergeSummary(diagnostic_msgs::DiagnosticStatus::WARN, "Ackermann samples lost waiting for imu data");
+  stat.add("Imu rate corrections", this->alg_.corrections_);
+  stat.add("Imu rate lost corrections", this->alg_.lost_corrections_);
+  if (this->alg_.lost_corrections_ > 0)
+    stat.mergeSummary(diagnostic_msgs::DiagnosticStatus::WARN, "Ackermann samples too far apart to replay the imu");
+
+  this->alg_.unlock();
 }
 
-/* main function */
+/* main function, not built in the nodelet library */
+#ifndef BUILD_NODELET
 int main(int argc, char *argv[])
 {
   return algorithm_base::main < AckermannToOdomAlgNode > (argc, argv, "ackermann_to_odom_alg_node");
 }
+#endif
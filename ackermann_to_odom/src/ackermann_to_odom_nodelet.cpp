@@ -0,0 +1,33 @@
+#include "ackermann_to_odom_alg_node.h"
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
+
+namespace ackermann_to_odom
+{
+
+/**
+ * \brief Nodelet version of AckermannToOdomAlgNode
+ *
+ * Runs the ackermann odometry node inside a nodelet manager, so the messages exchanged
+ * with other nodelets of the same manager are passed as shared pointers
+ * without serialization. The node is built on the nodelet handles, so its
+ * parameters and dynamic reconfigure server are in the nodelet namespace and
+ * its callbacks are served by the callback queue of the nodelet in the
+ * manager. The node loop runs in its own thread.
+ */
+class AckermannToOdomNodelet : public nodelet::Nodelet
+{
+private:
+
+  boost::shared_ptr<AckermannToOdomAlgNode> node_;
+
+  virtual void onInit(void)
+  {
+    this->node_.reset(new AckermannToOdomAlgNode(this->getNodeHandle(), this->getPrivateNodeHandle()));
+    this->node_->startNodeLoop();
+  }
+};
+
+}
+
+PLUGINLIB_EXPORT_CLASS(ackermann_to_odom::AckermannToOdomNodelet, nodelet::Nodelet)
@@ -0,0 +1,441 @@
+#include "odometry_integrator.h"
+#include "ros/console.h"
+#include <math.h>
+
+OdometryIntegrator::OdometryIntegrator(void)
+{
+  this->use_header_stamp_ = false;
+  this->max_sample_gap_ = 0.5;
+  this->max_speed_ = 50.0;
+  this->wheelbase_ = 1.08;
+  this->method_ = INTEGRATION_EULER;
+  this->setKinematicModel(KINEMATIC_TRICYCLE, true);
+  this->speed_variance_ = 0.0;
+  this->steering_variance_ = 0.0;
+  this->long_mission_ = false;
+  this->reset();
+}
+
+void OdometryIntegrator::setTiming(bool use_header_stamp, double max_sample_gap)
+{
+  this->use_header_stamp_ = use_header_stamp;
+  this->max_sample_gap_ = max_sample_gap;
+}
+
+void OdometryIntegrator::setMaxSpeed(float max_speed)
+{
+  this->max_speed_ = max_speed;
+}
+
+void OdometryIntegrator::setWheelbase(float wheelbase)
+{
+  this->wheelbase_ = wheelbase;
+}
+
+void OdometryIntegrator::setIntegrationMethod(IntegrationMethod method)
+{
+  this->method_ = method;
+  this->bindStep();
+}
+
+void OdometryIntegrator::setInputVariances(double speed_variance, double steering_variance)
+{
+  this->speed_variance_ = speed_variance;
+  this->steering_variance_ = steering_variance;
+}
+
+void OdometryIntegrator::setLongMission(bool long_mission)
+{
+  // the compensation is folded into the anchor, so the plain sums start clean
+  if (long_mission != this->long_mission_)
+    this->reanchor();
+  this->long_mission_ = long_mission;
+}
+
+void OdometryIntegrator::reanchor(void)
+{
+  // the true sum is the float sum minus the compensation
+  this->anchor_x_ += (double)this->pose_x_ - (double)this->compensation_x_;
+  this->anchor_y_ += (double)this->pose_y_ - (double)this->compensation_y_;
+  this->anchor_z_ += (double)this->pose_z_ - (double)this->compensation_z_;
+  this->pose_x_ = 0.0;
+  this->pose_y_ = 0.0;
+  this->pose_z_ = 0.0;
+  this->compensation_x_ = 0.0;
+  this->compensation_y_ = 0.0;
+  this->compensation_z_ = 0.0;
+}
+
+void OdometryIntegrator::reset(void)
+{
+  this->pose_x_ = 0.0;
+  this->pose_y_ = 0.0;
+  this->pose_yaw_ = 0.0;
+  this->pose_z_ = 0.0;
+  this->anchor_x_ = 0.0;
+  this->anchor_y_ = 0.0;
+  this->anchor_z_ = 0.0;
+  this->compensation_x_ = 0.0;
+  this->compensation_y_ = 0.0;
+  this->compensation_z_ = 0.0;
+  this->attitude_.setIdentity();
+  this->horizontal_ = 1.0;
+  this->vertical_ = 0.0;
+  this->covariance_.setZero();
+  this->z_variance_ = 0.0;
+  this->speed_x_ = 0.0;
+  this->speed_y_ = 0.0;
+  this->speed_z_ = 0.0;
+  this->angular_speed_x_ = 0.0;
+  this->angular_speed_y_ = 0.0;
+  this->angular_speed_z_ = 0.0;
+
+  this->first_sample_ = true;
+  this->duplicated_samples_ = 0;
+  this->out_of_order_samples_ = 0;
+  this->gapped_samples_ = 0;
+}
+
+void OdometryIntegrator::seed(double x, double y, float yaw, const ros::Time& stamp)
+{
+  this->pose_x_ = 0.0;
+  this->pose_y_ = 0.0;
+  this->pose_yaw_ = yaw;
+  this->pose_z_ = 0.0;
+  this->anchor_x_ = x;
+  this->anchor_y_ = y;
+  this->anchor_z_ = 0.0;
+  this->compensation_x_ = 0.0;
+  this->compensation_y_ = 0.0;
+  this->compensation_z_ = 0.0;
+  this->attitude_ = Eigen::AngleAxisd(yaw, Eigen::Vector3d::UnitZ());
+  this->horizontal_ = 1.0;
+  this->vertical_ = 0.0;
+  this->covariance_.setZero();
+  this->z_variance_ = 0.0;
+  this->speed_x_ = 0.0;
+  this->speed_y_ = 0.0;
+  this->speed_z_ = 0.0;
+  this->angular_speed_x_ = 0.0;
+  this->angular_speed_y_ = 0.0;
+  this->angular_speed_z_ = 0.0;
+
+  this->first_sample_ = false;
+  this->last_stamp_ = stamp;
+  this->stamp_ = stamp;
+}
+
+bool OdometryIntegrator::computeDeltaT(const ros::Time& stamp, float& delta_t)
+{
+  ros::Time current = this->use_header_stamp_ ? stamp : ros::Time::now();
+
+  delta_t = 0.0;
+  if (this->first_sample_)
+  {
+    this->last_stamp_ = current;
+    this->first_sample_ = false;
+    return true;
+  }
+
+  if (!this->use_header_stamp_)
+  {
+    delta_t = (float)(current - this->last_stamp_).toSec();
+    this->last_stamp_ = current;
+    return true;
+  }
+
+  double elapsed = (current - this->last_stamp_).toSec();
+  if (elapsed == 0.0)
+  {
+    this->duplicated_samples_++;
+    return false;
+  }
+  if (elapsed < 0.0)
+  {
+    this->out_of_order_samples_++;
+    return false;
+  }
+
+  this->last_stamp_ = current;
+  if (elapsed > this->max_sample_gap_)
+  {
+    // the speed is not integrated across the gap, restart from this sample
+    this->gapped_samples_++;
+    return true;
+  }
+
+  delta_t = (float)elapsed;
+  return true;
+}
+
+bool OdometryIntegrator::integrate3D(const ros::Time& stamp, float lineal_speed, float steering_radians,
+                                     const Eigen::Quaterniond& attitude, double imu_yaw_variance,
+                                     double imu_pitch_variance)
+{
+  // the heading direction is the first column of the rotation,
+  // (cos(pitch) cos(yaw), cos(pitch) sin(yaw), -sin(pitch))
+  Eigen::Vector3d heading = attitude.toRotationMatrix().col(0);
+  float horizontal = sqrt(heading.x() * heading.x() + heading.y() * heading.y());
+  float yaw = atan2(heading.y(), heading.x());
+
+  return (this->*step_imu_)(stamp, lineal_speed, steering_radians, yaw, imu_yaw_variance, horizontal, heading.z(),
+                            &attitude, imu_pitch_variance);
+}
+
+template <class Model, bool UseImu, IntegrationMethod Method>
+bool OdometryIntegrator::integrateStep(const ros::Time& stamp, float lineal_speed, float steering_radians,
+                                       float imu_yaw, double imu_yaw_variance, float horizontal, float vertical,
+                                       const Eigen::Quaterniond* attitude, double pitch_variance)
+{
+  //calculate increment of time
+  float delta_t;
+  if (!this->computeDeltaT(stamp, delta_t))
+    return false;
+  this->stamp_ = this->last_stamp_;
+
+  //angle
+  float pose_yaw;
+  float yaw_increment;
+  if (UseImu)
+  {
+    pose_yaw = imu_yaw;
+    yaw_increment = atan2(sin(pose_yaw - this->pose_yaw_), cos(pose_yaw - this->pose_yaw_));
+  }
+  else
+  {
+    float angular_speed_yaw = Model::yawRate(lineal_speed, steering_radians, this->wheelbase_);
+    yaw_increment = angular_speed_yaw * delta_t;
+    pose_yaw = this->pose_yaw_ + yaw_increment;
+  }
+
+  // the pitch changes along the step like the heading, only euler takes the end value
+  float horizontal_step = horizontal;
+  float vertical_step = vertical;
+  if (Method != INTEGRATION_EULER)
+  {
+    horizontal_step = 0.5 * (this->horizontal_ + horizontal);
+    vertical_step = 0.5 * (this->vertical_ + vertical);
+  }
+
+  //pose
+  float forward_speed = Model::forwardSpeed(lineal_speed, steering_radians);
+  float lineal_speed_x = forward_speed * horizontal * cos(pose_yaw);
+  float lineal_speed_y = forward_speed * horizontal * sin(pose_yaw);
+  float lineal_speed_z = forward_speed * vertical;
+  float delta_x, delta_y;
+  float distance = forward_speed * horizontal_step * delta_t;
+  float yaw_start = pose_yaw - yaw_increment;
+  stepDisplacement<Method>(distance, yaw_start, yaw_increment, delta_x, delta_y);
+  float delta_z = forward_speed * delta_t * vertical_step;
+  float compensation_x = this->compensation_x_;
+  float compensation_y = this->compensation_y_;
+  float compensation_z = this->compensation_z_;
+  float pose_x = this->accumulate(this->pose_x_, delta_x, compensation_x);
+  float pose_y = this->accumulate(this->pose_y_, delta_y, compensation_y);
+  float pose_z = this->accumulate(this->pose_z_, delta_z, compensation_z);
+  if (isnan(pose_yaw))
+  {
+    lineal_speed_x = 0.0;
+    lineal_speed_y = 0.0;
+    lineal_speed_z = 0.0;
+    pose_x = 0.0;
+    pose_y = 0.0;
+    pose_z = 0.0;
+    pose_yaw = 0.0;
+    compensation_x = 0.0;
+    compensation_y = 0.0;
+    compensation_z = 0.0;
+    this->covariance_.setZero();
+    this->z_variance_ = 0.0;
+    ROS_INFO("isnan(pose_yaw)");
+  }
+  this->speed_x_ = lineal_speed_x;
+  this->speed_y_ = lineal_speed_y;
+  this->speed_z_ = lineal_speed_z;
+
+  // attitude rate, the rotation from the previous attitude in the body frame
+  // in 3D, the yaw rate in 2D
+  this->angular_speed_x_ = 0.0;
+  this->angular_speed_y_ = 0.0;
+  this->angular_speed_z_ = 0.0;
+  if (delta_t > 0.0 && !isnan(pose_yaw))
+  {
+    if (attitude != NULL)
+    {
+      Eigen::AngleAxisd rotation(this->attitude_.conjugate() * (*attitude));
+      Eigen::Vector3d angular_speed = rotation.axis() * (rotation.angle() / delta_t);
+      this->angular_speed_x_ = angular_speed.x();
+      this->angular_speed_y_ = angular_speed.y();
+      this->angular_speed_z_ = angular_speed.z();
+    }
+    else
+      this->angular_speed_z_ = yaw_increment / delta_t;
+  }
+
+  // For next step, jumps are discarded, steps longer than the vehicle can drive in delta_t
+  float max_step = this->max_speed_ * delta_t;
+  if (fabs(this->pose_x_ - pose_x) <= max_step && fabs(this->pose_y_ - pose_y) <= max_step
+      && fabs(this->pose_z_ - pose_z) <= max_step)
+  {
+    if (!isnan(this->pose_yaw_ + yaw_increment))
+      this->propagateCovariance<Model, UseImu>(lineal_speed, steering_radians, delta_t,
+                                               this->pose_yaw_ + 0.5 * yaw_increment, horizontal_step, vertical_step,
+                                               imu_yaw_variance, pitch_variance);
+    this->pose_x_ = pose_x;
+    this->pose_y_ = pose_y;
+    this->pose_z_ = pose_z;
+    this->pose_yaw_ = pose_yaw;
+    this->compensation_x_ = compensation_x;
+    this->compensation_y_ = compensation_y;
+    this->compensation_z_ = compensation_z;
+    if (attitude != NULL)
+      this->attitude_ = *attitude;
+
+    if (this->long_mission_
+        && (fabs(this->pose_x_) > REANCHOR_DISTANCE || fabs(this->pose_y_) > REANCHOR_DISTANCE
+            || fabs(this->pose_z_) > REANCHOR_DISTANCE))
+      this->reanchor();
+  }
+  this->horizontal_ = horizontal;
+  this->vertical_ = vertical;
+
+  return true;
+}
+
+template <class Model, bool UseImu>
+void OdometryIntegrator::propagateCovariance(float lineal_speed, float steering_radians, float delta_t, float yaw_middle,
+                                             float horizontal, float vertical, double imu_yaw_variance,
+                                             double pitch_variance)
+{
+  // first order model of the step, the displacement along the heading at the
+  // middle of the step, which all the integration methods match to first order
+  double cos_yaw = cos(yaw_middle);
+  double sin_yaw = sin(yaw_middle);
+
+  // forward speed of the model and its derivatives with respect to the speed and the steering angle
+  double dforward_dsteering;
+  double dforward_dspeed = Model::forwardSpeedDerivatives(lineal_speed, steering_radians, dforward_dsteering);
+  double forward_speed = Model::forwardSpeed(lineal_speed, steering_radians);
+
+  // horizontal distance and its derivatives
+  double distance = forward_speed * delta_t * horizontal;
+  double ddistance_dspeed = dforward_dspeed * delta_t * horizontal;
+  double ddistance_dsteering = dforward_dsteering * delta_t * horizontal;
+
+  // jacobian with respect to the previous x, y and yaw
+  Eigen::Matrix3d F = Eigen::Matrix3d::Identity();
+
+  // jacobian with respect to the speed, the steering angle and the imu yaw
+  Eigen::Matrix3d G = Eigen::Matrix3d::Zero();
+  Eigen::Vector3d input_variances(this->speed_variance_, this->steering_variance_, 0.0);
+
+  if (UseImu)
+  {
+    // the new yaw is the imu yaw, the middle yaw is the mean of the old and the new one
+    F(0, 2) = -0.5 * distance * sin_yaw;
+    F(1, 2) = 0.5 * distance * cos_yaw;
+    F(2, 2) = 0.0;
+
+    G(0, 0) = ddistance_dspeed * cos_yaw;
+    G(1, 0) = ddistance_dspeed * sin_yaw;
+    G(0, 1) = ddistance_dsteering * cos_yaw;
+    G(1, 1) = ddistance_dsteering * sin_yaw;
+    G(0, 2) = -0.5 * distance * sin_yaw;
+    G(1, 2) = 0.5 * distance * cos_yaw;
+    G(2, 2) = 1.0;
+    input_variances(2) = imu_yaw_variance;
+  }
+  else
+  {
+    // the yaw increment comes from the yaw rate of the model
+    double dyaw_dsteering;
+    double dyaw_dspeed = Model::yawRateDerivatives(lineal_speed, steering_radians, this->wheelbase_, dyaw_dsteering)
+        * delta_t;
+    dyaw_dsteering *= delta_t;
+
+    F(0, 2) = -distance * sin_yaw;
+    F(1, 2) = distance * cos_yaw;
+
+    G(0, 0) = ddistance_dspeed * cos_yaw - 0.5 * distance * sin_yaw * dyaw_dspeed;
+    G(1, 0) = ddistance_dspeed * sin_yaw + 0.5 * distance * cos_yaw * dyaw_dspeed;
+    G(2, 0) = dyaw_dspeed;
+    G(0, 1) = ddistance_dsteering * cos_yaw - 0.5 * distance * sin_yaw * dyaw_dsteering;
+    G(1, 1) = ddistance_dsteering * sin_yaw + 0.5 * distance * cos_yaw * dyaw_dsteering;
+    G(2, 1) = dyaw_dsteering;
+  }
+
+  this->covariance_ = F * this->covariance_ * F.transpose() + G * input_variances.asDiagonal() * G.transpose();
+
+  // z only depends on the forward speed and on the slope, d(-sin(pitch))/d(pitch) = -cos(pitch)
+  double dz_dspeed = dforward_dspeed * delta_t * vertical;
+  double dz_dsteering = dforward_dsteering * delta_t * vertical;
+  double dz_dpitch = forward_speed * delta_t * horizontal;
+  this->z_variance_ += dz_dspeed * dz_dspeed * this->speed_variance_
+      + dz_dsteering * dz_dsteering * this->steering_variance_ + dz_dpitch * dz_dpitch * pitch_variance;
+}
+
+template <class Model, IntegrationMethod Method>
+void OdometryIntegrator::bindModel(void)
+{
+  if (this->use_imu_)
+    this->step_ = &OdometryIntegrator::integrateStep<Model, true, Method>;
+  else
+    this->step_ = &OdometryIntegrator::integrateStep<Model, false, Method>;
+  this->step_imu_ = &OdometryIntegrator::integrateStep<Model, true, Method>;
+}
+
+template <IntegrationMethod Method>
+void OdometryIntegrator::bindMethod(void)
+{
+#ifdef FIXED_KINEMATIC_MODEL
+  // single model build, the other models are not instantiated
+  this->bindModel<FIXED_KINEMATIC_MODEL, Method>();
+#else
+  switch (this->model_)
+  {
+    case KINEMATIC_BICYCLE:
+      this->bindModel<BicycleModel, Method>();
+      break;
+    case KINEMATIC_FOUR_WHEEL_ACKERMANN:
+      this->bindModel<FourWheelAckermannModel, Method>();
+      break;
+    case KINEMATIC_SKID_STEER:
+      this->bindModel<SkidSteerModel, Method>();
+      break;
+    default:
+      this->bindModel<TricycleModel, Method>();
+      break;
+  }
+#endif
+}
+
+void OdometryIntegrator::bindStep(void)
+{
+  switch (this->method_)
+  {
+    case INTEGRATION_MIDPOINT:
+      this->bindMethod<INTEGRATION_MIDPOINT>();
+      break;
+    case INTEGRATION_RK4:
+      this->bindMethod<INTEGRATION_RK4>();
+      break;
+    case INTEGRATION_EXACT_ARC:
+      this->bindMethod<INTEGRATION_EXACT_ARC>();
+      break;
+    default:
+      this->bindMethod<INTEGRATION_EULER>();
+      break;
+  }
+}
+
+void OdometryIntegrator::setKinematicModel(KinematicModel model, bool use_imu)
+{
+#ifdef FIXED_KINEMATIC_MODEL
+  if (model != FIXED_KINEMATIC_MODEL::MODEL)
+    ROS_WARN("OdometryIntegrator: kinematic model %d ignored, built with the fixed model %d", (int)model,
+             (int)FIXED_KINEMATIC_MODEL::MODEL);
+#endif
+  this->model_ = model;
+  this->use_imu_ = use_imu;
+  this->bindStep();
+}
@@ -0,0 +1,154 @@
+#include "pose_history.h"
+#include <boost/thread/mutex.hpp>
+#include <Eigen/Geometry>
+#include <map>
+
+PoseHistory::PoseHistory(size_t capacity) :
+    entries_(new Entry[capacity < 2 ? 2 : capacity]), capacity_(capacity < 2 ? 2 : capacity)
+{
+  for (uint64_t i = 0; i < this->capacity_; i++)
+    this->entries_[i].sequence = 0;
+  this->head_ = 0;
+  this->last_stamp_ = 0.0;
+}
+
+bool PoseHistory::push(const Pose3D& pose)
+{
+  double t = pose.stamp.toSec();
+  uint64_t index = this->head_.load(boost::memory_order_relaxed);
+  if (index > 0 && t <= this->last_stamp_)
+    return false;
+
+  Entry& entry = this->entries_[index % this->capacity_];
+  entry.sequence.store(2 * index + 1, boost::memory_order_relaxed);
+  boost::atomic_thread_fence(boost::memory_order_release);
+  entry.stamp = t;
+  entry.x = pose.x;
+  entry.y = pose.y;
+  entry.z = pose.z;
+  entry.qx = pose.qx;
+  entry.qy = pose.qy;
+  entry.qz = pose.qz;
+  entry.qw = pose.qw;
+  entry.sequence.store(2 * index + 2, boost::memory_order_release);
+
+  this->head_.store(index + 1, boost::memory_order_release);
+  this->last_stamp_ = t;
+  return true;
+}
+
+bool PoseHistory::read(uint64_t index, Pose3D& pose) const
+{
+  const Entry& entry = this->entries_[index % this->capacity_];
+  uint64_t sequence = 2 * index + 2;
+  if (entry.sequence.load(boost::memory_order_acquire) != sequence)
+    return false;
+
+  double stamp = entry.stamp;
+  double x = entry.x;
+  double y = entry.y;
+  double z = entry.z;
+  double qx = entry.qx;
+  double qy = entry.qy;
+  double qz = entry.qz;
+  double qw = entry.qw;
+
+  boost::atomic_thread_fence(boost::memory_order_acquire);
+  if (entry.sequence.load(boost::memory_order_relaxed) != sequence)
+    return false;
+
+  pose.stamp.fromSec(stamp);
+  pose.x = x;
+  pose.y = y;
+  pose.z = z;
+  pose.qx = qx;
+  pose.qy = qy;
+  pose.qz = qz;
+  pose.qw = qw;
+  return true;
+}
+
+int PoseHistory::tryQuery(const ros::Time& stamp, Pose3D& pose) const
+{
+  uint64_t head = this->head_.load(boost::memory_order_acquire);
+  if (head == 0)
+    return 0;
+
+  // the oldest slot is the next one to be overwritten, so it is not searched
+  uint64_t tail = head > this->capacity_ - 1 ? head - (this->capacity_ - 1) : 0;
+
+  Pose3D before, after;
+  if (!this->read(tail, before) || !this->read(head - 1, after))
+    return -1;
+  if (stamp < before.stamp || stamp > after.stamp)
+    return 0;
+
+  // last pose not newer than the requested time
+  uint64_t low = tail;
+  uint64_t high = head - 1;
+  while (low < high)
+  {
+    uint64_t middle = low + (high - low + 1) / 2;
+    Pose3D candidate;
+    if (!this->read(middle, candidate))
+      return -1;
+    if (candidate.stamp <= stamp)
+    {
+      low = middle;
+      before = candidate;
+    }
+    else
+      high = middle - 1;
+  }
+
+  if (low + 1 < head && !this->read(low + 1, after))
+    return -1;
+  if (low + 1 == head)
+    after = before;
+
+  double span = (after.stamp - before.stamp).toSec();
+  double ratio = span > 0.0 ? (stamp - before.stamp).toSec() / span : 0.0;
+  // slerp takes the shortest path between the two orientations
+  Eigen::Quaterniond orientation = Eigen::Quaterniond(before.qw, before.qx, before.qy, before.qz).slerp(
+      ratio, Eigen::Quaterniond(after.qw, after.qx, after.qy, after.qz));
+
+  pose.stamp = stamp;
+  pose.x = before.x + (after.x - before.x) * ratio;
+  pose.y = before.y + (after.y - before.y) * ratio;
+  pose.z = before.z + (after.z - before.z) * ratio;
+  pose.qx = orientation.x();
+  pose.qy = orientation.y();
+  pose.qz = orientation.z();
+  pose.qw = orientation.w();
+  return 1;
+}
+
+bool PoseHistory::query(const ros::Time& stamp, Pose3D& pose) const
+{
+  // a retry only happens when the writer wraps over the searched entries
+  for (int attempt = 0; attempt < 8; attempt++)
+  {
+    int result = this->tryQuery(stamp, pose);
+    if (result >= 0)
+      return result == 1;
+  }
+  return false;
+}
+
+size_t PoseHistory::size(void) const
+{
+  uint64_t head = this->head_.load(boost::memory_order_acquire);
+  return head < this->capacity_ - 1 ? head : this->capacity_ - 1;
+}
+
+boost::shared_ptr<PoseHistory> PoseHistory::instance(const std::string& name, size_t capacity)
+{
+  static boost::mutex mutex;
+  static std::map<std::string, boost::shared_ptr<PoseHistory> > histories;
+
+  boost::mutex::scoped_lock lock(mutex);
+  boost::shared_ptr<PoseHistory>& history = histories[name];
+  if (!history)
+    history.reset(new PoseHistory(capacity));
+  return history;
+}
@@ -0,0 +1,183 @@
+#include "trajectory_rollout.h"
+
+RolloutBatch::RolloutBatch(int rollouts, int steps)
+{
+  this->resize(rollouts, steps);
+}
+
+void RolloutBatch::resize(int rollouts, int steps)
+{
+  this->rollouts_ = rollouts;
+  this->steps_ = steps;
+  this->stride_ = ((rollouts + ROLLOUT_BLOCK - 1) / ROLLOUT_BLOCK) * ROLLOUT_BLOCK;
+
+  size_t size = (size_t)this->stride_ * steps;
+  this->speed_.assign(size, 0.0);
+  this->steering_.assign(size, 0.0);
+  this->x_.assign(size, 0.0);
+  this->y_.assign(size, 0.0);
+  this->yaw_.assign(size, 0.0);
+}
+
+TrajectoryRollout::TrajectoryRollout(KinematicModel model, float wheelbase, IntegrationMethod method, int threads)
+{
+  this->wheelbase_ = wheelbase;
+  this->batch_ = NULL;
+  this->next_block_ = 0;
+  this->generation_ = 0;
+  this->pending_workers_ = 0;
+  this->stopping_ = false;
+
+  switch (method)
+  {
+    case INTEGRATION_MIDPOINT:
+      this->bindMethod<INTEGRATION_MIDPOINT>(model);
+      break;
+    case INTEGRATION_RK4:
+      this->bindMethod<INTEGRATION_RK4>(model);
+      break;
+    case INTEGRATION_EXACT_ARC:
+      this->bindMethod<INTEGRATION_EXACT_ARC>(model);
+      break;
+    default:
+      this->bindMethod<INTEGRATION_EULER>(model);
+      break;
+  }
+
+  if (threads <= 0)
+    threads = boost::thread::hardware_concurrency();
+
+  // the calling thread is one of them
+  this->worker_count_ = threads > 1 ? threads - 1 : 0;
+  for (int i = 0; i < this->worker_count_; i++)
+    this->workers_.create_thread(boost::bind(&TrajectoryRollout::workerThread, this));
+}
+
+TrajectoryRollout::~TrajectoryRollout(void)
+{
+  {
+    boost::mutex::scoped_lock lock(this->mutex_);
+    this->stopping_ = true;
+  }
+  this->work_ready_.notify_all();
+  this->workers_.join_all();
+}
+
+template <IntegrationMethod Method>
+void TrajectoryRollout::bindMethod(KinematicModel model)
+{
+#ifdef FIXED_KINEMATIC_MODEL
+  // single model build, the other models are not instantiated
+  this->block_ = &TrajectoryRollout::rolloutBlock<FIXED_KINEMATIC_MODEL, Method>;
+#else
+  switch (model)
+  {
+    case KINEMATIC_BICYCLE:
+      this->block_ = &TrajectoryRollout::rolloutBlock<BicycleModel, Method>;
+      break;
+    case KINEMATIC_FOUR_WHEEL_ACKERMANN:
+      this->block_ = &TrajectoryRollout::rolloutBlock<FourWheelAckermannModel, Method>;
+      break;
+    case KINEMATIC_SKID_STEER:
+      this->block_ = &TrajectoryRollout::rolloutBlock<SkidSteerModel, Method>;
+      break;
+    default:
+      this->block_ = &TrajectoryRollout::rolloutBlock<TricycleModel, Method>;
+      break;
+  }
+#endif
+}
+
+template <class Model, IntegrationMethod Method>
+void TrajectoryRollout::rolloutBlock(RolloutBatch& batch, int first) const
+{
+  typedef Eigen::Array<float, ROLLOUT_BLOCK, 1> Packet;
+  typedef Eigen::Map<const Packet, Eigen::Aligned> ConstPacketMap;
+  typedef Eigen::Map<Packet, Eigen::Aligned> PacketMap;
+
+  Packet x = Packet::Constant(this->start_x_);
+  Packet y = Packet::Constant(this->start_y_);
+  Packet yaw = Packet::Constant(this->start_yaw_);
+  Packet delta_x, delta_y;
+
+  for (int step = 0; step < batch.steps(); step++)
+  {
+    Packet speed = ConstPacketMap(batch.speed(step) + first);
+    Packet steering = ConstPacketMap(batch.steering(step) + first);
+
+    // same step as OdometryIntegrator without imu
+    Packet yaw_increment = Model::yawRate(speed, steering, this->wheelbase_) * this->delta_t_;
+    Packet yaw_end = yaw + yaw_increment;
+    Packet distance = Model::forwardSpeed(speed, steering) * this->delta_t_;
+    Packet yaw_start = yaw_end - yaw_increment;
+    stepDisplacement<Method>(distance, yaw_start, yaw_increment, delta_x, delta_y);
+
+    x += delta_x;
+    y += delta_y;
+    yaw = yaw_end;
+
+    PacketMap(batch.x(step) + first) = x;
+    PacketMap(batch.y(step) + first) = y;
+    PacketMap(batch.yaw(step) + first) = yaw;
+  }
+}
+
+void TrajectoryRollout::runBlocks(void)
+{
+  int blocks = this->batch_->stride() / ROLLOUT_BLOCK;
+  for (int block = this->next_block_.fetch_add(1); block < blocks; block = this->next_block_.fetch_add(1))
+    (this->*block_)(*this->batch_, block * ROLLOUT_BLOCK);
+}
+
+void TrajectoryRollout::workerThread(void)
+{
+  unsigned long generation = 0;
+
+  boost::mutex::scoped_lock lock(this->mutex_);
+  while (true)
+  {
+    while (!this->stopping_ && this->generation_ == generation)
+      this->work_ready_.wait(lock);
+    if (this->stopping_)
+      return;
+    generation = this->generation_;
+
+    lock.unlock();
+    this->runBlocks();
+    lock.lock();
+
+    if (--this->pending_workers_ == 0)
+      this->work_done_.notify_all();
+  }
+}
+
+void TrajectoryRollout::rollout(float x, float y, float yaw, float delta_t, RolloutBatch& batch)
+{
+  this->batch_ = &batch;
+  this->start_x_ = x;
+  this->start_y_ = y;
+  this->start_yaw_ = yaw;
+  this->delta_t_ = delta_t;
+  this->next_block_ = 0;
+
+  // a single block is not worth waking the workers
+  int blocks = batch.stride() / ROLLOUT_BLOCK;
+  if (this->worker_count_ == 0 || blocks <= 1)
+  {
+    this->runBlocks();
+    return;
+  }
+
+  {
+    boost::mutex::scoped_lock lock(this->mutex_);
+    this->pending_workers_ = this->worker_count_;
+    this->generation_++;
+  }
+  this->work_ready_.notify_all();
+
+  this->runBlocks();
+
+  boost::mutex::scoped_lock lock(this->mutex_);
+  while (this->pending_workers_ > 0)
+    this->work_done_.wait(lock);
+}
@@ -0,0 +1,184 @@
+#include "ackermann_imu_synchronizer.h"
+#include <gtest/gtest.h>
+#include <math.h>
+
+namespace
+{
+
+const double SYNC_START = 1000.0;
+
+sensor_msgs::Imu imuAt(double t, double yaw)
+{
+  sensor_msgs::Imu imu;
+  imu.header.stamp = ros::Time(SYNC_START + t);
+  imu.orientation.x = 0.0;
+  imu.orientation.y = 0.0;
+  imu.orientation.z = sin(0.5 * yaw);
+  imu.orientation.w = cos(0.5 * yaw);
+  imu.orientation_covariance[8] = 0.01 * yaw;
+  return imu;
+}
+
+ackermann_msgs::AckermannDriveStamped ackermannAt(double t, float speed)
+{
+  ackermann_msgs::AckermannDriveStamped ackermann;
+  ackermann.header.stamp = ros::Time(SYNC_START + t);
+  ackermann.drive.speed = speed;
+  ackermann.drive.steering_angle = 0.1;
+  return ackermann;
+}
+
+double yawOf(const sensor_msgs::Imu& imu)
+{
+  return 2.0 * atan2(imu.orientation.z, imu.orientation.w);
+}
+
+}
+
+// the orientation at the ackermann stamp is the slerp of the imu samples around it
+TEST(AckermannImuSynchronizer, Interpolates)
+{
+  AckermannImuSynchronizer synchronizer;
+  ros::Time now(SYNC_START);
+  synchronizer.addImu(imuAt(0.0, 0.0));
+  synchronizer.addImu(imuAt(0.1, 0.2));
+  synchronizer.addAckermann(ackermannAt(0.025, 2.0), now);
+
+  ackermann_msgs::AckermannDriveStamped ackermann;
+  sensor_msgs::Imu imu;
+  ASSERT_TRUE(synchronizer.nextPair(ackermann, imu, now));
+  EXPECT_EQ(ros::Time(SYNC_START + 0.025), ackermann.header.stamp);
+  EXPECT_FLOAT_EQ(2.0, ackermann.drive.speed);
+  EXPECT_EQ(ackermann.header.stamp, imu.header.stamp);
+  EXPECT_NEAR(0.05, yawOf(imu), 1e-9);
+  EXPECT_NEAR(0.0005, imu.orientation_covariance[8], 1e-12);
+  EXPECT_EQ(1u, synchronizer.interpolated_pairs_);
+  EXPECT_FALSE(synchronizer.nextPair(ackermann, imu, now));
+}
+
+// a sample before the first imu sample gets its orientation, and samples are paired in stamp order
+TEST(AckermannImuSynchronizer, ClampsAtTheStart)
+{
+  AckermannImuSynchronizer synchronizer;
+  ros::Time now(SYNC_START);
+  synchronizer.addAckermann(ackermannAt(0.0, 1.0), now);
+  synchronizer.addAckermann(ackermannAt(0.15, 2.0), now);
+  synchronizer.addImu(imuAt(0.1, 0.3));
+  synchronizer.addImu(imuAt(0.2, 0.5));
+
+  ackermann_msgs::AckermannDriveStamped ackermann;
+  sensor_msgs::Imu imu;
+  ASSERT_TRUE(synchronizer.nextPair(ackermann, imu, now));
+  EXPECT_FLOAT_EQ(1.0, ackermann.drive.speed);
+  EXPECT_NEAR(0.3, yawOf(imu), 1e-9);
+  EXPECT_EQ(1u, synchronizer.clamped_pairs_);
+
+  ASSERT_TRUE(synchronizer.nextPair(ackermann, imu, now));
+  EXPECT_FLOAT_EQ(2.0, ackermann.drive.speed);
+  EXPECT_NEAR(0.4, yawOf(imu), 1e-9);
+  EXPECT_EQ(1u, synchronizer.interpolated_pairs_);
+}
+
+// a sample past the newest imu sample waits until the imu data covers it
+TEST(AckermannImuSynchronizer, WaitsForTheImu)
+{
+  AckermannImuSynchronizer synchronizer;
+  ros::Time now(SYNC_START);
+  synchronizer.addImu(imuAt(0.0, 0.0));
+  synchronizer.addAckermann(ackermannAt(0.05, 1.0), now);
+
+  ackermann_msgs::AckermannDriveStamped ackermann;
+  sensor_msgs::Imu imu;
+  EXPECT_FALSE(synchronizer.nextPair(ackermann, imu, now));
+
+  synchronizer.addImu(imuAt(0.1, 0.4));
+  ASSERT_TRUE(synchronizer.nextPair(ackermann, imu, now));
+  EXPECT_NEAR(0.2, yawOf(imu), 1e-9);
+  EXPECT_EQ(0u, synchronizer.held_pairs_);
+}
+
+// when the imu stops, newer ackermann stamps past the timeout release the sample with the last orientation
+TEST(AckermannImuSynchronizer, ReleasesOnNewerAckermann)
+{
+  AckermannImuSynchronizer synchronizer;
+  synchronizer.setTimeout(0.1);
+  ros::Time now(SYNC_START);
+  synchronizer.addImu(imuAt(0.0, 0.0));
+  synchronizer.addImu(imuAt(0.02, 0.1));
+  synchronizer.addAckermann(ackermannAt(0.05, 1.0), now);
+  synchronizer.addAckermann(ackermannAt(0.1, 2.0), now);
+
+  ackermann_msgs::AckermannDriveStamped ackermann;
+  sensor_msgs::Imu imu;
+  EXPECT_FALSE(synchronizer.nextPair(ackermann, imu, now));
+
+  synchronizer.addAckermann(ackermannAt(0.2, 3.0), now);
+  ASSERT_TRUE(synchronizer.nextPair(ackermann, imu, now));
+  EXPECT_FLOAT_EQ(1.0, ackermann.drive.speed);
+  EXPECT_NEAR(0.1, yawOf(imu), 1e-9);
+  EXPECT_EQ(1u, synchronizer.held_pairs_);
+  EXPECT_FALSE(synchronizer.nextPair(ackermann, imu, now));
+}
+
+// when both streams stop, the time since the samples arrived releases them
+TEST(AckermannImuSynchronizer, ReleasesOnArrivalTime)
+{
+  AckermannImuSynchronizer synchronizer;
+  synchronizer.setTimeout(0.1);
+  // arrival times on a clock unrelated to the stamps, as when a bag is replayed
+  ros::Time arrival(50.0);
+  synchronizer.addImu(imuAt(0.0, 0.2));
+  synchronizer.addAckermann(ackermannAt(0.05, 1.0), arrival);
+  synchronizer.addAckermann(ackermannAt(0.1, 2.0), arrival + ros::Duration(0.05));
+
+  ackermann_msgs::AckermannDriveStamped ackermann;
+  sensor_msgs::Imu imu;
+  EXPECT_FALSE(synchronizer.nextPair(ackermann, imu, arrival + ros::Duration(0.1)));
+
+  ASSERT_TRUE(synchronizer.nextPair(ackermann, imu, arrival + ros::Duration(0.12)));
+  EXPECT_FLOAT_EQ(1.0, ackermann.drive.speed);
+  EXPECT_NEAR(0.2, yawOf(imu), 1e-9);
+  EXPECT_FALSE(synchronizer.nextPair(ackermann, imu, arrival + ros::Duration(0.12)));
+
+  ASSERT_TRUE(synchronizer.nextPair(ackermann, imu, arrival + ros::Duration(0.2)));
+  EXPECT_FLOAT_EQ(2.0, ackermann.drive.speed);
+  EXPECT_EQ(2u, synchronizer.held_pairs_);
+}
+
+// without any imu sample, a released sample gets the identity orientation
+TEST(AckermannImuSynchronizer, ReleasesWithoutImu)
+{
+  AckermannImuSynchronizer synchronizer;
+  ros::Time now(SYNC_START);
+  synchronizer.addAckermann(ackermannAt(0.0, 1.0), now);
+
+  ackermann_msgs::AckermannDriveStamped ackermann;
+  sensor_msgs::Imu imu;
+  ASSERT_TRUE(synchronizer.nextPair(ackermann, imu, now + ros::Duration(1.0)));
+  EXPECT_NEAR(1.0, imu.orientation.w, 1e-12);
+  EXPECT_EQ(1u, synchronizer.held_pairs_);
+}
+
+// imu samples not newer than the last one are dropped
+TEST(AckermannImuSynchronizer, DropsOldImu)
+{
+  AckermannImuSynchronizer synchronizer;
+  ros::Time now(SYNC_START);
+  synchronizer.addImu(imuAt(0.0, 0.0));
+  synchronizer.addImu(imuAt(0.1, 0.2));
+  synchronizer.addImu(imuAt(0.1, 1.0));
+  synchronizer.addImu(imuAt(0.05, 1.0));
+  EXPECT_EQ(2u, synchronizer.dropped_imu_samples_);
+
+  synchronizer.addAckermann(ackermannAt(0.05, 1.0), now);
+  ackermann_msgs::AckermannDriveStamped ackermann;
+  sensor_msgs::Imu imu;
+  ASSERT_TRUE(synchronizer.nextPair(ackermann, imu, now));
+  EXPECT_NEAR(0.1, yawOf(imu), 1e-9);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,292 @@
+#include "odometry_integrator.h"
+#include <gtest/gtest.h>
+#include <math.h>
+#include <stdlib.h>
+
+namespace
+{
+
+// synthetic drive on a circle, yaw read from the imu
+const double DRIVE_SPEED = 10.0;
+const double DRIVE_RADIUS = 1000.0;
+const double DRIVE_PERIOD = 0.01;
+const double DRIVE_START = 1000.0;
+
+/**
+ * \brief Integrates distance [m] of the circle drive and returns the distance
+ * between the integrated and the analytic position.
+ */
+double circleDriveError(OdometryIntegrator& integrator, double distance)
+{
+  const double yaw_rate = DRIVE_SPEED / DRIVE_RADIUS;
+  const long steps = (long)(distance / (DRIVE_SPEED * DRIVE_PERIOD));
+
+  integrator.setTiming(true, 0.5);
+  integrator.setKinematicModel(KINEMATIC_BICYCLE, true);
+  integrator.setIntegrationMethod(INTEGRATION_EXACT_ARC);
+  integrator.seed(0.0, 0.0, 0.0, ros::Time(DRIVE_START));
+
+  for (long step = 1; step <= steps; step++)
+  {
+    double t = step * DRIVE_PERIOD;
+    double yaw = atan2(sin(yaw_rate * t), cos(yaw_rate * t));
+    integrator.integrate(ros::Time(DRIVE_START + t), DRIVE_SPEED, 0.0, yaw, 0.0);
+  }
+
+  // the arc from the origin heading along x
+  double t = steps * DRIVE_PERIOD;
+  double x = DRIVE_RADIUS * sin(yaw_rate * t);
+  double y = DRIVE_RADIUS * (1.0 - cos(yaw_rate * t));
+  return hypot(integrator.getX() - x, integrator.getY() - y);
+}
+
+}
+
+// 50 km drive, the compensated sums keep the error of the analytic trajectory bounded
+TEST(OdometryIntegrator, LongMissionDrift)
+{
+  OdometryIntegrator long_mission;
+  long_mission.setLongMission(true);
+  double long_mission_error = circleDriveError(long_mission, 50000.0);
+  EXPECT_LT(long_mission_error, 0.01);
+
+  // the plain float sums round the 10 cm increments away far from the origin
+  OdometryIntegrator plain;
+  double plain_error = circleDriveError(plain, 50000.0);
+  EXPECT_LT(long_mission_error * 10.0, plain_error);
+}
+
+TEST(OdometryIntegrator, LongMissionReanchors)
+{
+  OdometryIntegrator integrator;
+  integrator.setLongMission(true);
+  integrator.setTiming(true, 0.5);
+  integrator.setKinematicModel(KINEMATIC_BICYCLE, true);
+  integrator.seed(1e6, -2e6, 0.0, ros::Time(DRIVE_START));
+
+  // straight along x, 1 km at 1 cm per step
+  for (int step = 1; step <= 100000; step++)
+    integrator.integrate(ros::Time(DRIVE_START + step * DRIVE_PERIOD), 1.0, 0.0, 0.0, 0.0);
+
+  EXPECT_NEAR(1e6 + 1000.0, integrator.getX(), 1e-3);
+  EXPECT_NEAR(-2e6, integrator.getY(), 1e-9);
+}
+
+// switching the mode keeps the position
+TEST(OdometryIntegrator, LongMissionToggle)
+{
+  OdometryIntegrator integrator;
+  integrator.setTiming(true, 0.5);
+  integrator.setKinematicModel(KINEMATIC_BICYCLE, true);
+  integrator.seed(0.0, 0.0, 0.0, ros::Time(DRIVE_START));
+  for (int step = 1; step <= 1000; step++)
+    integrator.integrate(ros::Time(DRIVE_START + step * DRIVE_PERIOD), 2.0, 0.0, 0.5, 0.0);
+
+  double x = integrator.getX();
+  double y = integrator.getY();
+  integrator.setLongMission(true);
+  EXPECT_DOUBLE_EQ(x, integrator.getX());
+  EXPECT_DOUBLE_EQ(y, integrator.getY());
+  integrator.setLongMission(false);
+  EXPECT_DOUBLE_EQ(x, integrator.getX());
+  EXPECT_DOUBLE_EQ(y, integrator.getY());
+}
+
+namespace
+{
+
+/**
+ * \brief Error of the position after 20 s on a circle at a constant steering
+ * angle, with the yaw integrated from the model, sampled at rate [Hz].
+ */
+double circleMethodError(IntegrationMethod method, int rate)
+{
+  const float wheelbase = 1.08;
+  const float speed = 5.0;
+  const float steering = 0.3;
+  const double radius = wheelbase / tan(steering);
+
+  OdometryIntegrator integrator;
+  integrator.setTiming(true, 1.0);
+  integrator.setWheelbase(wheelbase);
+  integrator.setKinematicModel(KINEMATIC_BICYCLE, false);
+  integrator.setIntegrationMethod(method);
+  integrator.seed(0.0, 0.0, 0.0, ros::Time(DRIVE_START));
+  for (int step = 1; step <= 20 * rate; step++)
+    integrator.integrate(ros::Time(DRIVE_START + step / (double)rate), speed, steering, 0.0, 0.0);
+
+  double yaw = speed / radius * 20.0;
+  return hypot(integrator.getX() - radius * sin(yaw), integrator.getY() - radius * (1.0 - cos(yaw)));
+}
+
+}
+
+// at 5 Hz the steps are 1 m long, the arc is exact and the higher order methods stay close
+TEST(OdometryIntegrator, IntegrationMethodsAtLowRate)
+{
+  double euler = circleMethodError(INTEGRATION_EULER, 5);
+  double midpoint = circleMethodError(INTEGRATION_MIDPOINT, 5);
+  double rk4 = circleMethodError(INTEGRATION_RK4, 5);
+  double exact_arc = circleMethodError(INTEGRATION_EXACT_ARC, 5);
+
+  EXPECT_LT(exact_arc, 1e-3);
+  EXPECT_LT(rk4, 1e-3);
+  EXPECT_LT(midpoint, 0.05);
+  EXPECT_GT(euler, 0.5);
+}
+
+// euler is first order, the error halves with the step
+TEST(OdometryIntegrator, EulerConvergence)
+{
+  double coarse = circleMethodError(INTEGRATION_EULER, 10);
+  double fine = circleMethodError(INTEGRATION_EULER, 20);
+  EXPECT_NEAR(2.0, coarse / fine, 0.1);
+}
+
+// the methods only differ when the heading changes along the step
+TEST(OdometryIntegrator, IntegrationMethodsOnAStraightLine)
+{
+  const IntegrationMethod methods[] = {INTEGRATION_EULER, INTEGRATION_MIDPOINT, INTEGRATION_RK4,
+                                       INTEGRATION_EXACT_ARC};
+  for (int i = 0; i < 4; i++)
+  {
+    OdometryIntegrator integrator;
+    integrator.setTiming(true, 1.0);
+    integrator.setKinematicModel(KINEMATIC_BICYCLE, true);
+    integrator.setIntegrationMethod(methods[i]);
+    integrator.seed(0.0, 0.0, M_PI / 4.0, ros::Time(DRIVE_START));
+    for (int step = 1; step <= 100; step++)
+      integrator.integrate(ros::Time(DRIVE_START + 0.1 * step), 3.0, 0.0, M_PI / 4.0, 0.0);
+
+    EXPECT_NEAR(30.0 / sqrt(2.0), integrator.getX(), 1e-4) << "method " << methods[i];
+    EXPECT_NEAR(30.0 / sqrt(2.0), integrator.getY(), 1e-4) << "method " << methods[i];
+  }
+}
+
+// the first order covariance matches the spread of noisy drives
+TEST(OdometryIntegrator, CovarianceMatchesMonteCarlo)
+{
+  const double speed_variance = 0.04;
+  const double steering_variance = 0.0004;
+  const int runs = 4000;
+  const int steps = 100;
+
+  OdometryIntegrator nominal;
+  nominal.setTiming(true, 1.0);
+  nominal.setKinematicModel(KINEMATIC_BICYCLE, false);
+  nominal.setInputVariances(speed_variance, steering_variance);
+  nominal.setIntegrationMethod(INTEGRATION_MIDPOINT);
+  nominal.seed(0.0, 0.0, 0.0, ros::Time(DRIVE_START));
+  for (int step = 1; step <= steps; step++)
+    nominal.integrate(ros::Time(DRIVE_START + 0.1 * step), 2.0, 0.1, 0.0, 0.0);
+
+  // gaussian samples of the inputs from the Box-Muller transform
+  srand(13);
+  Eigen::Vector3d mean = Eigen::Vector3d::Zero();
+  Eigen::Matrix3d second_moment = Eigen::Matrix3d::Zero();
+  for (int run = 0; run < runs; run++)
+  {
+    OdometryIntegrator integrator;
+    integrator.setTiming(true, 1.0);
+    integrator.setKinematicModel(KINEMATIC_BICYCLE, false);
+    integrator.setIntegrationMethod(INTEGRATION_MIDPOINT);
+    integrator.seed(0.0, 0.0, 0.0, ros::Time(DRIVE_START));
+    for (int step = 1; step <= steps; step++)
+    {
+      double u1 = (rand() + 1.0) / (RAND_MAX + 2.0);
+      double u2 = (rand() + 1.0) / (RAND_MAX + 2.0);
+      double radius = sqrt(-2.0 * log(u1));
+      float speed = 2.0 + sqrt(speed_variance) * radius * cos(2.0 * M_PI * u2);
+      float steering = 0.1 + sqrt(steering_variance) * radius * sin(2.0 * M_PI * u2);
+      integrator.integrate(ros::Time(DRIVE_START + 0.1 * step), speed, steering, 0.0, 0.0);
+    }
+    Eigen::Vector3d pose(integrator.getX(), integrator.getY(), integrator.getYaw());
+    mean += pose / runs;
+    second_moment += pose * pose.transpose() / runs;
+  }
+  Eigen::Matrix3d sampled = second_moment - mean * mean.transpose();
+
+  const Eigen::Matrix3d& covariance = nominal.getCovariance();
+  for (int i = 0; i < 3; i++)
+    EXPECT_NEAR(sampled(i, i), covariance(i, i), 0.1 * covariance(i, i)) << "diagonal " << i;
+  // correlation between y and yaw
+  EXPECT_NEAR(sampled(1, 2) / sqrt(sampled(1, 1) * sampled(2, 2)),
+              covariance(1, 2) / sqrt(covariance(1, 1) * covariance(2, 2)), 0.05);
+}
+
+// the imu yaw variance enters the yaw directly and the position through the heading
+TEST(OdometryIntegrator, CovarianceWithImuYaw)
+{
+  OdometryIntegrator integrator;
+  integrator.setTiming(true, 1.0);
+  integrator.setKinematicModel(KINEMATIC_BICYCLE, true);
+  integrator.setInputVariances(0.01, 0.0);
+  integrator.seed(0.0, 0.0, 0.0, ros::Time(DRIVE_START));
+  for (int step = 1; step <= 10; step++)
+    integrator.integrate(ros::Time(DRIVE_START + 0.1 * step), 1.0, 0.0, 0.0, 1e-4);
+
+  const Eigen::Matrix3d& covariance = integrator.getCovariance();
+  EXPECT_NEAR(1e-4, covariance(2, 2), 1e-12);
+  // x only from the speed, 10 steps of 0.1 s (float)
+  EXPECT_NEAR(10 * 0.01 * 0.01, covariance(0, 0), 1e-9);
+  EXPECT_GT(covariance(1, 1), 0.0);
+  EXPECT_TRUE(covariance.isApprox(covariance.transpose(), 1e-12));
+}
+
+namespace
+{
+
+/**
+ * \brief Distance driven along x in duration [s] at a constant speed, with
+ * samples at rate [Hz].
+ */
+double straightDrive(double rate, float speed, double duration)
+{
+  OdometryIntegrator integrator;
+  integrator.setTiming(true, 1.0);
+  integrator.setKinematicModel(KINEMATIC_BICYCLE, true);
+  integrator.seed(0.0, 0.0, 0.0, ros::Time(DRIVE_START));
+  for (int step = 1; step <= (int)(duration * rate + 0.5); step++)
+    integrator.integrate(ros::Time(DRIVE_START + step / rate), speed, 0.0, 0.0, 0.0);
+  return integrator.getX();
+}
+
+}
+
+// the jump limit scales with the time of the step, so low rates and high speeds are integrated
+TEST(OdometryIntegrator, LowRateAndHighSpeed)
+{
+  // 2.5 m steps at 2 Hz and 5 m/s
+  EXPECT_NEAR(50.0, straightDrive(2.0, 5.0, 10.0), 1e-3);
+  // 4 m steps at 10 Hz and 40 m/s
+  EXPECT_NEAR(400.0, straightDrive(10.0, 40.0, 10.0), 1e-2);
+  // 1 m steps at 1 Hz and 1 m/s
+  EXPECT_NEAR(10.0, straightDrive(1.0, 1.0, 10.0), 1e-3);
+}
+
+// a step faster than the maximum speed is discarded, and the drive goes on from the next sample
+TEST(OdometryIntegrator, DiscardsJumps)
+{
+  OdometryIntegrator integrator;
+  integrator.setTiming(true, 1.0);
+  integrator.setMaxSpeed(20.0);
+  integrator.setKinematicModel(KINEMATIC_BICYCLE, true);
+  integrator.seed(0.0, 0.0, 0.0, ros::Time(DRIVE_START));
+  for (int step = 1; step <= 10; step++)
+    integrator.integrate(ros::Time(DRIVE_START + 0.1 * step), 5.0, 0.0, 0.0, 0.0);
+  EXPECT_NEAR(5.0, integrator.getX(), 1e-4);
+
+  // a 100 m/s speed reading
+  EXPECT_TRUE(integrator.integrate(ros::Time(DRIVE_START + 1.1), 100.0, 0.0, 0.0, 0.0));
+  EXPECT_NEAR(5.0, integrator.getX(), 1e-4);
+
+  for (int step = 12; step <= 20; step++)
+    integrator.integrate(ros::Time(DRIVE_START + 0.1 * step), 5.0, 0.0, 0.0, 0.0);
+  EXPECT_NEAR(9.5, integrator.getX(), 1e-4);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,192 @@
+#include "pose_history.h"
+#include <gtest/gtest.h>
+#include <boost/thread.hpp>
+#include <math.h>
+
+namespace
+{
+
+const double HISTORY_START = 1000.0;
+const double HISTORY_PERIOD = 0.02;
+
+/**
+ * \brief Pose of the k-th sample, moving along x at 1 m per sample, with y
+ * twice x and the yaw turning 0.1 rad per sample.
+ */
+Pose3D poseAt(uint64_t k)
+{
+  Pose3D pose;
+  pose.stamp = ros::Time(HISTORY_START + k * HISTORY_PERIOD);
+  pose.x = k;
+  pose.y = 2.0 * k;
+  pose.z = -1.0;
+  pose.qx = 0.0;
+  pose.qy = 0.0;
+  pose.qz = sin(0.05 * k);
+  pose.qw = cos(0.05 * k);
+  return pose;
+}
+
+double yawOf(const Pose3D& pose)
+{
+  return 2.0 * atan2(pose.qz, pose.qw);
+}
+
+struct ReaderResult
+{
+  unsigned long queries;
+  unsigned long found;
+  unsigned long inconsistent;
+};
+
+/**
+ * \brief Queries times near the newest pose until the writer is done, and
+ * counts the results that do not lie on the trajectory.
+ */
+void reader(const PoseHistory* history, const boost::atomic<uint64_t>* pushed, const boost::atomic<bool>* done,
+            ReaderResult* result)
+{
+  result->queries = 0;
+  result->found = 0;
+  result->inconsistent = 0;
+  unsigned int seed = 7;
+  while (!done->load())
+  {
+    uint64_t newest = pushed->load();
+    if (newest < 2)
+      continue;
+    // up to twice the capacity back, so some queries fall on overwritten entries
+    double back = (rand_r(&seed) % 1000) / 1000.0 * 128.0;
+    double k = newest - 1 - back;
+    if (k < 0.0)
+      k = 0.0;
+    Pose3D pose;
+    result->queries++;
+    if (!history->query(ros::Time(HISTORY_START + k * HISTORY_PERIOD), pose))
+      continue;
+    result->found++;
+    double yaw_error = yawOf(pose) - 0.1 * k;
+    if (fabs(pose.x - k) > 1e-6 || fabs(pose.y - 2.0 * pose.x) > 1e-6 || pose.z != -1.0
+        || fabs(atan2(sin(yaw_error), cos(yaw_error))) > 1e-6)
+      result->inconsistent++;
+  }
+}
+
+}
+
+// nothing is found in an empty history
+TEST(PoseHistory, Empty)
+{
+  PoseHistory history(16);
+  Pose3D pose;
+  EXPECT_EQ(0u, history.size());
+  EXPECT_FALSE(history.query(ros::Time(HISTORY_START), pose));
+}
+
+// position interpolated linearly and orientation by slerp between the two closest poses
+TEST(PoseHistory, Interpolates)
+{
+  PoseHistory history(16);
+  for (uint64_t k = 0; k < 10; k++)
+    ASSERT_TRUE(history.push(poseAt(k)));
+  EXPECT_EQ(10u, history.size());
+
+  Pose3D pose;
+  ros::Time stamp(HISTORY_START + 2.25 * HISTORY_PERIOD);
+  ASSERT_TRUE(history.query(stamp, pose));
+  EXPECT_EQ(stamp, pose.stamp);
+  EXPECT_NEAR(2.25, pose.x, 1e-6);
+  EXPECT_NEAR(4.5, pose.y, 1e-6);
+  EXPECT_NEAR(-1.0, pose.z, 1e-12);
+  EXPECT_NEAR(0.225, yawOf(pose), 1e-6);
+  EXPECT_NEAR(1.0, pose.qz * pose.qz + pose.qw * pose.qw, 1e-12);
+
+  // the stamps of the first and the last poses are covered
+  ASSERT_TRUE(history.query(poseAt(0).stamp, pose));
+  EXPECT_NEAR(0.0, pose.x, 1e-9);
+  ASSERT_TRUE(history.query(poseAt(9).stamp, pose));
+  EXPECT_NEAR(9.0, pose.x, 1e-9);
+}
+
+// times before the first and after the last pose are not answered, and old poses are not pushed
+TEST(PoseHistory, OutOfRange)
+{
+  PoseHistory history(16);
+  for (uint64_t k = 1; k < 5; k++)
+    ASSERT_TRUE(history.push(poseAt(k)));
+
+  Pose3D pose;
+  EXPECT_FALSE(history.query(ros::Time(HISTORY_START + 0.5 * HISTORY_PERIOD), pose));
+  EXPECT_FALSE(history.query(ros::Time(HISTORY_START + 4.5 * HISTORY_PERIOD), pose));
+
+  EXPECT_FALSE(history.push(poseAt(4)));
+  EXPECT_FALSE(history.push(poseAt(2)));
+  EXPECT_EQ(4u, history.size());
+}
+
+// once the ring wraps, the oldest poses are forgotten and the newest still interpolate
+TEST(PoseHistory, WrapsAround)
+{
+  PoseHistory history(8);
+  for (uint64_t k = 0; k < 21; k++)
+    ASSERT_TRUE(history.push(poseAt(k)));
+
+  // the slot to be overwritten next is not searched
+  EXPECT_EQ(7u, history.size());
+  Pose3D pose;
+  EXPECT_FALSE(history.query(poseAt(13).stamp, pose));
+  EXPECT_FALSE(history.query(ros::Time(HISTORY_START + 13.5 * HISTORY_PERIOD), pose));
+  ASSERT_TRUE(history.query(poseAt(14).stamp, pose));
+  EXPECT_NEAR(14.0, pose.x, 1e-9);
+  ASSERT_TRUE(history.query(ros::Time(HISTORY_START + 17.5 * HISTORY_PERIOD), pose));
+  EXPECT_NEAR(17.5, pose.x, 1e-6);
+  EXPECT_NEAR(1.75, yawOf(pose), 1e-6);
+}
+
+// a writer wrapping a small ring, readers never get a pose mixed from different writes
+TEST(PoseHistory, ConcurrentReaders)
+{
+  const int readers = 3;
+  const uint64_t poses = 200000;
+
+  PoseHistory history(64);
+  boost::atomic<uint64_t> pushed(0);
+  boost::atomic<bool> done(false);
+  ReaderResult results[readers];
+  boost::thread_group threads;
+  for (int i = 0; i < readers; i++)
+    threads.create_thread(boost::bind(reader, &history, &pushed, &done, &results[i]));
+
+  for (uint64_t k = 0; k < poses; k++)
+  {
+    history.push(poseAt(k));
+    pushed.store(k + 1);
+    // lets the readers run on a single core
+    if (k % 256 == 0)
+      boost::this_thread::yield();
+  }
+  done.store(true);
+  threads.join_all();
+
+  for (int i = 0; i < readers; i++)
+  {
+    EXPECT_EQ(0u, results[i].inconsistent) << "reader " << i;
+    EXPECT_GT(results[i].found, 0u) << "reader " << i;
+  }
+}
+
+// the shared histories are per name
+TEST(PoseHistory, InstancePerName)
+{
+  boost::shared_ptr<PoseHistory> first = PoseHistory::instance("/first_odometry_node");
+  boost::shared_ptr<PoseHistory> second = PoseHistory::instance("/second_odometry_node");
+  EXPECT_TRUE(first);
+  EXPECT_NE(first.get(), second.get());
+  EXPECT_EQ(first.get(), PoseHistory::instance("/first_odometry_node").get());
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,120 @@
+#include "trajectory_rollout.h"
+#include "odometry_integrator.h"
+#include <gtest/gtest.h>
+#include <stdlib.h>
+
+namespace
+{
+
+const float ROLLOUT_WHEELBASE = 1.08;
+const float ROLLOUT_DELTA_T = 0.05;
+
+float uniform(float min, float max)
+{
+  return min + (max - min) * rand() / (float)RAND_MAX;
+}
+
+/**
+ * \brief Random controls, smooth along every sequence.
+ */
+void randomControls(RolloutBatch& batch)
+{
+  for (int k = 0; k < batch.rollouts(); k++)
+  {
+    float speed = uniform(-1.0, 5.0);
+    float steering = uniform(-0.4, 0.4);
+    for (int step = 0; step < batch.steps(); step++)
+    {
+      speed += uniform(-0.1, 0.1);
+      steering += uniform(-0.02, 0.02);
+      batch.speed(step)[k] = speed;
+      batch.steering(step)[k] = steering;
+    }
+  }
+}
+
+/**
+ * \brief Integrates every sequence of the batch with OdometryIntegrator, yaw
+ * from the model, and compares the trajectories.
+ */
+void expectSameAsOdometry(KinematicModel model, IntegrationMethod method, const RolloutBatch& batch, float x,
+                          float y, float yaw)
+{
+  for (int k = 0; k < batch.rollouts(); k++)
+  {
+    OdometryIntegrator integrator;
+    integrator.setTiming(true, 1.0);
+    integrator.setWheelbase(ROLLOUT_WHEELBASE);
+    integrator.setKinematicModel(model, false);
+    integrator.setIntegrationMethod(method);
+    integrator.seed(x, y, yaw, ros::Time(1000.0));
+
+    for (int step = 0; step < batch.steps(); step++)
+    {
+      integrator.integrate(ros::Time(1000.0 + (step + 1) * ROLLOUT_DELTA_T), batch.speed(step)[k],
+                           batch.steering(step)[k], 0.0, 0.0);
+      ASSERT_NEAR(integrator.getX(), batch.x(step)[k], 1e-3) << "rollout " << k << " step " << step;
+      ASSERT_NEAR(integrator.getY(), batch.y(step)[k], 1e-3) << "rollout " << k << " step " << step;
+      ASSERT_NEAR(integrator.getYaw(), batch.yaw(step)[k], 1e-4) << "rollout " << k << " step " << step;
+    }
+  }
+}
+
+}
+
+// the planner predicts the motion the odometry measures, for every model and method
+TEST(TrajectoryRollout, MatchesOdometryIntegrator)
+{
+  const KinematicModel models[] = {KINEMATIC_TRICYCLE, KINEMATIC_BICYCLE, KINEMATIC_FOUR_WHEEL_ACKERMANN,
+                                   KINEMATIC_SKID_STEER};
+  const IntegrationMethod methods[] = {INTEGRATION_EULER, INTEGRATION_MIDPOINT, INTEGRATION_RK4,
+                                       INTEGRATION_EXACT_ARC};
+
+  // not a multiple of ROLLOUT_BLOCK, so the padding is integrated too
+  srand(19);
+  RolloutBatch batch(37, 60);
+  randomControls(batch);
+
+  for (int m = 0; m < 4; m++)
+  {
+    for (int i = 0; i < 4; i++)
+    {
+      SCOPED_TRACE(testing::Message() << "model " << models[m] << " method " << methods[i]);
+      TrajectoryRollout rollout(models[m], ROLLOUT_WHEELBASE, methods[i], 1);
+      rollout.rollout(2.0, -1.0, 0.5, ROLLOUT_DELTA_T, batch);
+      expectSameAsOdometry(models[m], methods[i], batch, 2.0, -1.0, 0.5);
+    }
+  }
+}
+
+// the blocks are independent, the thread pool gives the same bits as a single thread
+TEST(TrajectoryRollout, ThreadsGiveSameTrajectories)
+{
+  srand(7);
+  RolloutBatch single(1000, 40);
+  randomControls(single);
+  RolloutBatch pooled = single;
+
+  TrajectoryRollout single_thread(KINEMATIC_TRICYCLE, ROLLOUT_WHEELBASE, INTEGRATION_EXACT_ARC, 1);
+  TrajectoryRollout thread_pool(KINEMATIC_TRICYCLE, ROLLOUT_WHEELBASE, INTEGRATION_EXACT_ARC, 4);
+  single_thread.rollout(0.0, 0.0, 0.0, ROLLOUT_DELTA_T, single);
+  // twice, so the workers are woken for a second job
+  thread_pool.rollout(0.0, 0.0, 0.0, ROLLOUT_DELTA_T, pooled);
+  thread_pool.rollout(0.0, 0.0, 0.0, ROLLOUT_DELTA_T, pooled);
+
+  for (int step = 0; step < single.steps(); step++)
+  {
+    for (int k = 0; k < single.rollouts(); k++)
+    {
+      ASSERT_EQ(single.x(step)[k], pooled.x(step)[k]) << "rollout " << k << " step " << step;
+      ASSERT_EQ(single.y(step)[k], pooled.y(step)[k]) << "rollout " << k << " step " << step;
+      ASSERT_EQ(single.yaw(step)[k], pooled.yaw(step)[k]) << "rollout " << k << " step " << step;
+    }
+  }
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
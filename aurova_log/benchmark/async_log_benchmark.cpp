@@ -0,0 +1,156 @@
+/**
+ * \file async_log_benchmark.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: m.a.munoz
+ *
+ * Time a callback spends in a log call with AsyncLog, from one thread and
+ * from concurrent threads, against a synchronous fprintf and fflush of the
+ * same record. The records go to /dev/null, so the synchronous cost is the
+ * least a callback could pay, without a terminal or a file behind it. The
+ * cost of formatting the record alone is the floor of both. Then the delay
+ * from a log call to its record being written out, for records far enough
+ * apart that the writer waits for each of them, read back through a pipe.
+ */
+
+#include "aurova_log/async_log.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+
+// records per burst, under the ring size so the writer drains them without drops
+const int BENCHMARK_BURST = 256;
+const int BENCHMARK_BURSTS = 200;
+const int BENCHMARK_THREADS = 4;
+
+const int LATENCY_RECORDS = 500;
+// pause between the records of the latency run, longer than the writer needs to drain one [s]
+const double LATENCY_PAUSE = 0.002;
+
+enum LogCall
+{
+  LOG_FORMAT_ONLY,
+  LOG_SYNCHRONOUS,
+  LOG_ASYNCHRONOUS
+};
+
+/**
+ * \brief Mean time of a log call in [ns], over bursts separated by pauses in
+ * which the writer drains the ring.
+ */
+double burstCost(LogCall call, int thread)
+{
+  char text[ASYNC_LOG_RECORD_SIZE];
+  double elapsed = 0.0;
+  for (int burst = 0; burst < BENCHMARK_BURSTS; burst++)
+  {
+    ros::WallTime start = ros::WallTime::now();
+    for (int i = 0; i < BENCHMARK_BURST; i++)
+    {
+      if (call == LOG_ASYNCHRONOUS)
+        ASYNC_LOG_INFO("thread %d burst %d record %d: speed %.3f m/s", thread, burst, i, 0.001 * i);
+      else if (call == LOG_FORMAT_ONLY)
+        snprintf(text, ASYNC_LOG_RECORD_SIZE, "thread %d burst %d record %d: speed %.3f m/s", thread, burst, i,
+                 0.001 * i);
+      else
+      {
+        fprintf(stdout, "[ INFO] [%u.%09u]: thread %d burst %d record %d: speed %.3f m/s\n", start.sec, start.nsec,
+                thread, burst, i, 0.001 * i);
+        fflush(stdout);
+      }
+    }
+    elapsed += (ros::WallTime::now() - start).toSec();
+    // keeps the formatting
+    if (call == LOG_FORMAT_ONLY && text[0] != 't')
+      fprintf(stderr, "%s\n", text);
+    boost::this_thread::sleep(boost::posix_time::microseconds((long)(4 * ASYNC_LOG_WRITER_PERIOD * 1e6)));
+  }
+  return elapsed / (BENCHMARK_BURSTS * BENCHMARK_BURST) * 1e9;
+}
+
+void concurrentCost(double* cost, int thread)
+{
+  *cost = burstCost(LOG_ASYNCHRONOUS, thread);
+}
+
+/**
+ * \brief Reads the records until the pipe is closed, and keeps the time in
+ * [us] from the stamp of every latency record, the time of its log call, to
+ * its read.
+ */
+void latencyReader(FILE* pipe, std::vector<double>* latencies)
+{
+  char line[2 * ASYNC_LOG_RECORD_SIZE];
+  while (fgets(line, sizeof(line), pipe) != NULL)
+  {
+    ros::WallTime now = ros::WallTime::now();
+    unsigned int sec, nsec;
+    if (sscanf(line, "[ INFO] [%u.%u]: latency", &sec, &nsec) == 2)
+      latencies->push_back(((double)now.sec - sec) * 1e6 + ((double)now.nsec - nsec) * 1e-3);
+  }
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+  // the results go to stderr, which the writer only uses for warnings and errors
+  if (freopen("/dev/null", "w", stdout) == NULL)
+    return 1;
+
+  // warm up, and starts the writer
+  burstCost(LOG_ASYNCHRONOUS, 0);
+
+  double format = burstCost(LOG_FORMAT_ONLY, 0);
+  double synchronous = burstCost(LOG_SYNCHRONOUS, 0);
+  double single = burstCost(LOG_ASYNCHRONOUS, 0);
+
+  double costs[BENCHMARK_THREADS];
+  boost::thread_group threads;
+  for (int thread = 0; thread < BENCHMARK_THREADS; thread++)
+    threads.create_thread(boost::bind(concurrentCost, &costs[thread], thread));
+  threads.join_all();
+  double concurrent = 0.0;
+  for (int thread = 0; thread < BENCHMARK_THREADS; thread++)
+    concurrent += costs[thread] / BENCHMARK_THREADS;
+
+  fprintf(stderr, "log call [ns]: formatting only %.1f, fprintf and fflush %.1f, AsyncLog %.1f, "
+          "AsyncLog from %d threads %.1f\n", format, synchronous, single, BENCHMARK_THREADS, concurrent);
+
+  // stdout to a pipe, until /dev/null replaces its write end and the reader sees the end
+  int pipe_ends[2];
+  if (pipe(pipe_ends) != 0)
+    return 1;
+  fflush(stdout);
+  dup2(pipe_ends[1], STDOUT_FILENO);
+  close(pipe_ends[1]);
+  FILE* pipe_in = fdopen(pipe_ends[0], "r");
+  std::vector<double> latencies;
+  boost::thread reader(latencyReader, pipe_in, &latencies);
+  for (int i = 0; i < LATENCY_RECORDS; i++)
+  {
+    ASYNC_LOG_INFO("latency %d", i);
+    boost::this_thread::sleep(boost::posix_time::microseconds((long)(LATENCY_PAUSE * 1e6)));
+  }
+  boost::this_thread::sleep(boost::posix_time::microseconds((long)(4 * ASYNC_LOG_WRITER_PERIOD * 1e6)));
+  int null_output = open("/dev/null", O_WRONLY);
+  dup2(null_output, STDOUT_FILENO);
+  close(null_output);
+  reader.join();
+  fclose(pipe_in);
+
+  if (!latencies.empty())
+  {
+    std::sort(latencies.begin(), latencies.end());
+    fprintf(stderr, "log call to output [us] over %lu records: median %.1f, 99%% %.1f, max %.1f\n",
+            (unsigned long)latencies.size(), latencies[latencies.size() / 2],
+            latencies[latencies.size() * 99 / 100], latencies.back());
+  }
+  fprintf(stderr, "dropped records: %lu\n", AsyncLog::instance().droppedRecords());
+  return 0;
+}
@@ -0,0 +1,189 @@
+/**
+ * \file async_log.h
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: m.a.munoz
+ */
+
+#ifndef _async_log_h_
+#define _async_log_h_
+
+#include <ros/time.h>
+#include <boost/atomic.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/thread.hpp>
+
+// severities, same order as rosconsole
+#define ASYNC_LOG_DEBUG_LEVEL 0
+#define ASYNC_LOG_INFO_LEVEL 1
+#define ASYNC_LOG_WARN_LEVEL 2
+#define ASYNC_LOG_ERROR_LEVEL 3
+#define ASYNC_LOG_NONE_LEVEL 4
+
+// minimum severity compiled in, the sites below it are removed
+// (build with -DASYNC_LOG_LEVEL=0 to keep the debug sites)
+#ifndef ASYNC_LOG_LEVEL
+#define ASYNC_LOG_LEVEL ASYNC_LOG_INFO_LEVEL
+#endif
+
+// number of records in the ring, a power of 2
+#define ASYNC_LOG_RING_SIZE 1024
+
+// maximum length of a record, longer messages are truncated
+#define ASYNC_LOG_RECORD_SIZE 256
+
+// longest time the writer waits for a wake up when the ring is empty [s]
+#define ASYNC_LOG_WRITER_PERIOD 0.005
+
+/**
+ * \brief Asynchronous logger shared by all the nodes and nodelets of a process
+ *
+ * The records are formatted by the caller into a fixed-size ring (bounded
+ * multi-producer queue, one sequence number per slot), and a background
+ * thread writes them to stdout (debug and info) or stderr (warn and error),
+ * so the callbacks never wait for the terminal. A caller never blocks: when
+ * the ring is full the record is dropped, and the writer reports the number
+ * of dropped records. The writer waits on a condition variable when the ring
+ * is empty, and the first record after an idle period wakes it, so a record
+ * is written out as soon as the writer is scheduled; only that record takes
+ * the writer mutex.
+ *
+ * The records are stamped with the wall time of the call. Use the
+ * ASYNC_LOG_* macros, which remove the sites below ASYNC_LOG_LEVEL at compile
+ * time and keep the throttle state of every site.
+ */
+class AsyncLog
+{
+private:
+
+  struct Record
+  {
+    boost::atomic<unsigned long> sequence;
+    int level;
+    ros::WallTime stamp;
+    char text[ASYNC_LOG_RECORD_SIZE];
+  };
+
+  Record ring_[ASYNC_LOG_RING_SIZE];
+  boost::atomic<unsigned long> enqueue_position_;
+  // only used by the writer thread
+  unsigned long dequeue_position_;
+
+  boost::atomic<unsigned long> dropped_records_;
+  unsigned long reported_drops_;
+
+  boost::atomic<bool> running_;
+  // set by the writer before it waits, cleared by the record that wakes it
+  boost::atomic<bool> writer_waiting_;
+  boost::mutex writer_mutex_;
+  boost::condition_variable writer_wake_;
+  boost::thread writer_;
+
+  AsyncLog(void);
+  AsyncLog(const AsyncLog&);
+  AsyncLog& operator=(const AsyncLog&);
+
+  /**
+   * \brief Writes out the pending records.
+   *
+   * \return false if the ring was empty.
+   */
+  bool drain(void);
+
+  /**
+   * \brief Wakes the writer if it waits for records.
+   */
+  void wakeWriter(void);
+
+  /**
+   * \brief Writer thread, drains the ring until the logger is destroyed, and
+   * waits for a record when the ring is empty.
+   */
+  void writerThread(void);
+
+public:
+
+  /**
+   * \brief Destructor of AsyncLog class
+   *
+   * Stops the writer thread and writes out the pending records.
+   */
+  ~AsyncLog(void);
+
+  /**
+   * \brief The logger of the process, the writer thread starts on the first call.
+   */
+  static AsyncLog& instance(void);
+
+  /**
+   * \brief Adds a record, formatted as printf.
+   *
+   * @param level is the severity, one of ASYNC_LOG_*_LEVEL.
+   * \return false if the ring was full and the record was dropped.
+   */
+  bool write(int level, const char* format, ...) __attribute__((format(printf, 3, 4)));
+
+  /**
+   * \brief Rate limit of a log site.
+   *
+   * Concurrent calls of a site race for the window with a compare and
+   * exchange, so exactly one of them logs.
+   *
+   * @param last is the wall time in [ns] of the last record of the site,
+   * updated when this function returns true.
+   * @param period is the minimum time between records of the site in [s].
+   * \return true if the site can log now.
+   */
+  static bool throttle(boost::atomic<boost::int64_t>& last, double period);
+
+  /**
+   * \brief Records dropped because the ring was full.
+   */
+  unsigned long droppedRecords(void) const;
+};
+
+#define ASYNC_LOG_SITE(level, ...) AsyncLog::instance().write(level, __VA_ARGS__)
+
+#define ASYNC_LOG_SITE_THROTTLE(level, period, ...) \
+  do \
+  { \
+    static boost::atomic<boost::int64_t> async_log_last_(0); \
+    if (AsyncLog::throttle(async_log_last_, period)) \
+      AsyncLog::instance().write(level, __VA_ARGS__); \
+  } while (0)
+
+#define ASYNC_LOG_REMOVED do {} while (0)
+
+#if ASYNC_LOG_LEVEL <= ASYNC_LOG_DEBUG_LEVEL
+#define ASYNC_LOG_DEBUG(...) ASYNC_LOG_SITE(ASYNC_LOG_DEBUG_LEVEL, __VA_ARGS__)
+#define ASYNC_LOG_DEBUG_THROTTLE(period, ...) ASYNC_LOG_SITE_THROTTLE(ASYNC_LOG_DEBUG_LEVEL, period, __VA_ARGS__)
+#else
+#define ASYNC_LOG_DEBUG(...) ASYNC_LOG_REMOVED
+#define ASYNC_LOG_DEBUG_THROTTLE(period, ...) ASYNC_LOG_REMOVED
+#endif
+
+#if ASYNC_LOG_LEVEL <= ASYNC_LOG_INFO_LEVEL
+#define ASYNC_LOG_INFO(...) ASYNC_LOG_SITE(ASYNC_LOG_INFO_LEVEL, __VA_ARGS__)
+#define ASYNC_LOG_INFO_THROTTLE(period, ...) ASYNC_LOG_SITE_THROTTLE(ASYNC_LOG_INFO_LEVEL, period, __VA_ARGS__)
+#else
+#define ASYNC_LOG_INFO(...) ASYNC_LOG_REMOVED
+#define ASYNC_LOG_INFO_THROTTLE(period, ...) ASYNC_LOG_REMOVED
+#endif
+
+#if ASYNC_LOG_LEVEL <= ASYNC_LOG_WARN_LEVEL
+#define ASYNC_LOG_WARN(...) ASYNC_LOG_SITE(ASYNC_LOG_WARN_LEVEL, __VA_ARGS__)
+#define ASYNC_LOG_WARN_THROTTLE(period, ...) ASYNC_LOG_SITE_THROTTLE(ASYNC_LOG_WARN_LEVEL, period, __VA_ARGS__)
+#else
+#define ASYNC_LOG_WARN(...) ASYNC_LOG_REMOVED
+#define ASYNC_LOG_WARN_THROTTLE(period, ...) ASYNC_LOG_REMOVED
+#endif
+
+#if ASYNC_LOG_LEVEL <= ASYNC_LOG_ERROR_LEVEL
+#define ASYNC_LOG_ERROR(...) ASYNC_LOG_SITE(ASYNC_LOG_ERROR_LEVEL, __VA_ARGS__)
+#define ASYNC_LOG_ERROR_THROTTLE(period, ...) ASYNC_LOG_SITE_THROTTLE(ASYNC_LOG_ERROR_LEVEL, period, __VA_ARGS__)
+#else
+#define ASYNC_LOG_ERROR(...) ASYNC_LOG_REMOVED
+#define ASYNC_LOG_ERROR_THROTTLE(period, ...) ASYNC_LOG_REMOVED
+#endif
+
+#endif /* _async_log_h_ */
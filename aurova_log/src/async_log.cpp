@@ -0,0 +1,155 @@
+#include "aurova_log/async_log.h"
+#include <stdarg.h>
+#include <stdio.h>
+
+static const char* const LEVEL_NAMES[] = {"DEBUG", " INFO", " WARN", "ERROR"};
+
+AsyncLog::AsyncLog(void)
+{
+  for (unsigned long i = 0; i < ASYNC_LOG_RING_SIZE; i++)
+    this->ring_[i].sequence.store(i, boost::memory_order_relaxed);
+  this->enqueue_position_.store(0, boost::memory_order_relaxed);
+  this->dequeue_position_ = 0;
+
+  this->dropped_records_.store(0, boost::memory_order_relaxed);
+  this->reported_drops_ = 0;
+
+  this->running_.store(true);
+  this->writer_waiting_.store(false);
+  this->writer_ = boost::thread(&AsyncLog::writerThread, this);
+}
+
+AsyncLog::~AsyncLog(void)
+{
+  this->running_.store(false);
+  {
+    boost::lock_guard<boost::mutex> lock(this->writer_mutex_);
+    this->writer_wake_.notify_one();
+  }
+  this->writer_.join();
+}
+
+AsyncLog& AsyncLog::instance(void)
+{
+  static AsyncLog log;
+  return log;
+}
+
+bool AsyncLog::write(int level, const char* format, ...)
+{
+  // claim the next slot, it is free when its sequence equals the position
+  Record* record;
+  unsigned long position = this->enqueue_position_.load(boost::memory_order_relaxed);
+  for (;;)
+  {
+    record = &this->ring_[position & (ASYNC_LOG_RING_SIZE - 1)];
+    long difference = (long)record->sequence.load(boost::memory_order_acquire) - (long)position;
+    if (difference == 0)
+    {
+      if (this->enqueue_position_.compare_exchange_weak(position, position + 1, boost::memory_order_relaxed))
+        break;
+    }
+    else if (difference < 0)
+    {
+      this->dropped_records_.fetch_add(1, boost::memory_order_relaxed);
+      return false;
+    }
+    else
+      position = this->enqueue_position_.load(boost::memory_order_relaxed);
+  }
+
+  record->level = level;
+  record->stamp = ros::WallTime::now();
+  va_list arguments;
+  va_start(arguments, format);
+  vsnprintf(record->text, ASYNC_LOG_RECORD_SIZE, format, arguments);
+  va_end(arguments);
+
+  // publish the slot to the writer
+  record->sequence.store(position + 1, boost::memory_order_release);
+  this->wakeWriter();
+  return true;
+}
+
+void AsyncLog::wakeWriter(void)
+{
+  // orders the publication of the slot before the check of the flag, against
+  // the writer setting the flag before its last look at the ring
+  boost::atomic_thread_fence(boost::memory_order_seq_cst);
+  if (!this->writer_waiting_.load(boost::memory_order_relaxed) || !this->writer_waiting_.exchange(false))
+    return;
+  // the writer holds the mutex from its last look at the ring until it waits
+  boost::lock_guard<boost::mutex> lock(this->writer_mutex_);
+  this->writer_wake_.notify_one();
+}
+
+bool AsyncLog::drain(void)
+{
+  bool written = false;
+  for (;;)
+  {
+    Record& record = this->ring_[this->dequeue_position_ & (ASYNC_LOG_RING_SIZE - 1)];
+    if (record.sequence.load(boost::memory_order_acquire) != this->dequeue_position_ + 1)
+      break;
+
+    int level = record.level < ASYNC_LOG_DEBUG_LEVEL ? ASYNC_LOG_DEBUG_LEVEL :
+                record.level > ASYNC_LOG_ERROR_LEVEL ? ASYNC_LOG_ERROR_LEVEL : record.level;
+    fprintf(level >= ASYNC_LOG_WARN_LEVEL ? stderr : stdout, "[%s] [%u.%09u]: %s\n", LEVEL_NAMES[level],
+            record.stamp.sec, record.stamp.nsec, record.text);
+
+    // free the slot for the next lap of the ring
+    record.sequence.store(this->dequeue_position_ + ASYNC_LOG_RING_SIZE, boost::memory_order_release);
+    this->dequeue_position_++;
+    written = true;
+  }
+
+  unsigned long dropped = this->dropped_records_.load(boost::memory_order_relaxed);
+  if (dropped != this->reported_drops_)
+  {
+    fprintf(stderr, "[ WARN]: %lu log records dropped, the ring was full\n", dropped - this->reported_drops_);
+    this->reported_drops_ = dropped;
+    written = true;
+  }
+
+  if (written)
+  {
+    fflush(stdout);
+    fflush(stderr);
+  }
+  return written;
+}
+
+void AsyncLog::writerThread(void)
+{
+  while (this->running_.load())
+  {
+    if (this->drain())
+      continue;
+
+    boost::unique_lock<boost::mutex> lock(this->writer_mutex_);
+    this->writer_waiting_.store(true);
+    boost::atomic_thread_fence(boost::memory_order_seq_cst);
+    // either this look sees a record published before the flag, or its
+    // producer sees the flag and wakes the writer; the timeout is only a bound
+    Record& record = this->ring_[this->dequeue_position_ & (ASYNC_LOG_RING_SIZE - 1)];
+    if (record.sequence.load(boost::memory_order_acquire) != this->dequeue_position_ + 1 && this->running_.load())
+      this->writer_wake_.timed_wait(lock, boost::posix_time::microseconds((long)(ASYNC_LOG_WRITER_PERIOD * 1e6)));
+    this->writer_waiting_.store(false);
+  }
+  this->drain();
+}
+
+bool AsyncLog::throttle(boost::atomic<boost::int64_t>& last, double period)
+{
+  boost::int64_t now = ros::WallTime::now().toNSec();
+  boost::int64_t previous = last.load(boost::memory_order_relaxed);
+  if (now - previous < (boost::int64_t)(period * 1e9))
+    return false;
+  // only the call that still sees the previous record takes the window
+  return last.compare_exchange_strong(previous, now, boost::memory_order_relaxed);
+}
+
+unsigned long AsyncLog::droppedRecords(void) const
+{
+  return this->dropped_records_.load(boost::memory_order_relaxed);
+}
@@ -0,0 +1,308 @@
+#include "aurova_log/async_log.h"
+#include <gtest/gtest.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+const int LOG_PRODUCERS = 4;
+const int LOG_RECORDS = 200;
+const int THROTTLE_CALLERS = 8;
+const int THROTTLE_ROUNDS = 200;
+
+/**
+ * \brief Redirects stdout and stderr to temporary files, the writer thread
+ * writes there until finish() is called.
+ */
+class OutputCapture
+{
+private:
+
+  int saved_out_;
+  int saved_err_;
+  FILE* out_;
+  FILE* err_;
+  int markers_;
+
+  /**
+   * \brief Adds a marker record and waits for the writer to write it out.
+   */
+  bool waitForWriter(void)
+  {
+    std::ostringstream marker;
+    marker << "capture marker " << this->markers_++;
+    while (!AsyncLog::instance().write(ASYNC_LOG_ERROR_LEVEL, "%s", marker.str().c_str()))
+      usleep(1000);
+    for (int i = 0; i < 1000; i++)
+    {
+      if (read(this->err_).find(marker.str()) != std::string::npos)
+        return true;
+      usleep(1000);
+    }
+    return false;
+  }
+
+  static std::string read(FILE* file)
+  {
+    std::string text;
+    char buffer[4096];
+    size_t size;
+    rewind(file);
+    while ((size = fread(buffer, 1, sizeof(buffer), file)) > 0)
+      text.append(buffer, size);
+    return text;
+  }
+
+public:
+
+  OutputCapture(void)
+  {
+    fflush(stdout);
+    fflush(stderr);
+    this->saved_out_ = dup(STDOUT_FILENO);
+    this->saved_err_ = dup(STDERR_FILENO);
+    this->out_ = tmpfile();
+    this->err_ = tmpfile();
+    dup2(fileno(this->out_), STDOUT_FILENO);
+    dup2(fileno(this->err_), STDERR_FILENO);
+    this->markers_ = 0;
+  }
+
+  /**
+   * \brief Waits for the writer and restores stdout and stderr.
+   *
+   * A second marker is waited for, so the drop report of the pass that wrote
+   * the first one is complete.
+   * \return false if the writer did not write the markers in time.
+   */
+  bool finish(std::string& out, std::string& err)
+  {
+    bool written = this->waitForWriter() && this->waitForWriter();
+    fflush(stdout);
+    fflush(stderr);
+    out = read(this->out_);
+    err = read(this->err_);
+    dup2(this->saved_out_, STDOUT_FILENO);
+    dup2(this->saved_err_, STDERR_FILENO);
+    close(this->saved_out_);
+    close(this->saved_err_);
+    fclose(this->out_);
+    fclose(this->err_);
+    return written;
+  }
+};
+
+std::vector<std::string> lines(const std::string& text)
+{
+  std::vector<std::string> result;
+  std::istringstream stream(text);
+  std::string line;
+  while (std::getline(stream, line))
+    result.push_back(line);
+  return result;
+}
+
+/**
+ * \brief Sum of the dropped records reported by the writer.
+ */
+unsigned long reportedDrops(const std::string& err)
+{
+  unsigned long sum = 0;
+  std::vector<std::string> all = lines(err);
+  for (size_t i = 0; i < all.size(); i++)
+  {
+    unsigned long dropped;
+    if (sscanf(all[i].c_str(), "[ WARN]: %lu log records dropped", &dropped) == 1)
+      sum += dropped;
+  }
+  return sum;
+}
+
+void producer(int id)
+{
+  for (int record = 0; record < LOG_RECORDS; record++)
+    AsyncLog::instance().write(ASYNC_LOG_INFO_LEVEL, "producer %d record %d", id, record);
+}
+
+/**
+ * \brief Calls the throttle of a fresh site once per round, together with the
+ * other callers, and counts the calls that may log.
+ */
+void throttleCaller(boost::atomic<boost::int64_t>* sites, boost::barrier* start, int* allowed)
+{
+  *allowed = 0;
+  for (int round = 0; round < THROTTLE_ROUNDS; round++)
+  {
+    start->wait();
+    if (AsyncLog::throttle(sites[round], 1000.0))
+      (*allowed)++;
+  }
+}
+
+}
+
+// every record of concurrent producers is written once, in the order of each producer
+TEST(AsyncLog, WritesInOrderPerProducer)
+{
+  unsigned long dropped = AsyncLog::instance().droppedRecords();
+  OutputCapture capture;
+  boost::thread_group producers;
+  for (int id = 0; id < LOG_PRODUCERS; id++)
+    producers.create_thread(boost::bind(producer, id));
+  producers.join_all();
+  std::string out, err;
+  ASSERT_TRUE(capture.finish(out, err));
+
+  ASSERT_EQ(dropped, AsyncLog::instance().droppedRecords());
+  std::vector<int> next(LOG_PRODUCERS, 0);
+  std::vector<std::string> all = lines(out);
+  for (size_t i = 0; i < all.size(); i++)
+  {
+    int id, record;
+    ASSERT_EQ(2, sscanf(all[i].c_str(), "[ INFO] [%*u.%*u]: producer %d record %d", &id, &record)) << all[i];
+    ASSERT_EQ(next[id], record) << "producer " << id;
+    next[id]++;
+  }
+  for (int id = 0; id < LOG_PRODUCERS; id++)
+    EXPECT_EQ(LOG_RECORDS, next[id]) << "producer " << id;
+}
+
+// debug and info go to stdout, warn and error to stderr, with the severity and the wall time
+TEST(AsyncLog, RoutesSeverities)
+{
+  ros::WallTime start = ros::WallTime::now();
+  OutputCapture capture;
+  AsyncLog::instance().write(ASYNC_LOG_DEBUG_LEVEL, "debug %d", 1);
+  AsyncLog::instance().write(ASYNC_LOG_INFO_LEVEL, "info %s", "two");
+  AsyncLog::instance().write(ASYNC_LOG_WARN_LEVEL, "warn %.1f", 3.0);
+  AsyncLog::instance().write(ASYNC_LOG_ERROR_LEVEL, "error");
+  AsyncLog::instance().write(-1, "below debug");
+  AsyncLog::instance().write(ASYNC_LOG_NONE_LEVEL, "above error");
+  std::string out, err;
+  ASSERT_TRUE(capture.finish(out, err));
+
+  std::vector<std::string> out_lines = lines(out);
+  std::vector<std::string> err_lines = lines(err);
+  ASSERT_EQ(3u, out_lines.size());
+  ASSERT_LE(3u, err_lines.size());
+  EXPECT_NE(std::string::npos, out_lines[0].find("[DEBUG] ["));
+  EXPECT_NE(std::string::npos, out_lines[0].find("]: debug 1"));
+  EXPECT_NE(std::string::npos, out_lines[1].find("[ INFO] ["));
+  EXPECT_NE(std::string::npos, out_lines[1].find("]: info two"));
+  EXPECT_NE(std::string::npos, out_lines[2].find("[DEBUG] ["));
+  EXPECT_NE(std::string::npos, out_lines[2].find("]: below debug"));
+  EXPECT_NE(std::string::npos, err_lines[0].find("[ WARN] ["));
+  EXPECT_NE(std::string::npos, err_lines[0].find("]: warn 3.0"));
+  EXPECT_NE(std::string::npos, err_lines[1].find("[ERROR] ["));
+  EXPECT_NE(std::string::npos, err_lines[1].find("]: error"));
+  EXPECT_NE(std::string::npos, err_lines[2].find("[ERROR] ["));
+  EXPECT_NE(std::string::npos, err_lines[2].find("]: above error"));
+
+  unsigned int sec, nsec;
+  ASSERT_EQ(2, sscanf(out_lines[0].c_str(), "[DEBUG] [%u.%u]", &sec, &nsec));
+  EXPECT_GE(sec + 1e-9 * nsec, start.toSec() - 1e-6);
+  EXPECT_LE(sec + 1e-9 * nsec, ros::WallTime::now().toSec());
+}
+
+// a record longer than ASYNC_LOG_RECORD_SIZE is truncated
+TEST(AsyncLog, TruncatesLongRecords)
+{
+  std::string text(2 * ASYNC_LOG_RECORD_SIZE, 'x');
+  OutputCapture capture;
+  AsyncLog::instance().write(ASYNC_LOG_INFO_LEVEL, "%s", text.c_str());
+  std::string out, err;
+  ASSERT_TRUE(capture.finish(out, err));
+
+  std::vector<std::string> out_lines = lines(out);
+  ASSERT_EQ(1u, out_lines.size());
+  size_t start = out_lines[0].find("]: ") + 3;
+  EXPECT_EQ(ASYNC_LOG_RECORD_SIZE - 1, (int)(out_lines[0].size() - start));
+}
+
+// a burst larger than the ring drops records without blocking, and the writer reports them
+TEST(AsyncLog, DropsWhenFull)
+{
+  unsigned long dropped = AsyncLog::instance().droppedRecords();
+  OutputCapture capture;
+  int written = 0;
+  int failed = 0;
+  for (int i = 0; i < 4 * ASYNC_LOG_RING_SIZE; i++)
+  {
+    if (AsyncLog::instance().write(ASYNC_LOG_INFO_LEVEL, "burst %d", i))
+      written++;
+    else
+      failed++;
+  }
+  unsigned long burst_drops = AsyncLog::instance().droppedRecords() - dropped;
+  std::string out, err;
+  ASSERT_TRUE(capture.finish(out, err));
+
+  EXPECT_GE(written, ASYNC_LOG_RING_SIZE);
+  EXPECT_GT(failed, 0);
+  EXPECT_EQ((unsigned long)failed, burst_drops);
+  EXPECT_EQ((size_t)written, lines(out).size());
+  // the markers of the capture may be dropped too while the ring drains
+  EXPECT_EQ(AsyncLog::instance().droppedRecords() - dropped, reportedDrops(err));
+  EXPECT_GE(reportedDrops(err), burst_drops);
+}
+
+// a site logs again once the period has elapsed since its last record
+TEST(AsyncLog, Throttle)
+{
+  boost::atomic<boost::int64_t> last(0);
+  EXPECT_TRUE(AsyncLog::throttle(last, 1000.0));
+  EXPECT_NEAR(ros::WallTime::now().toSec(), 1e-9 * last.load(), 1.0);
+  boost::int64_t first = last.load();
+  EXPECT_FALSE(AsyncLog::throttle(last, 1000.0));
+  EXPECT_EQ(first, last.load());
+  EXPECT_TRUE(AsyncLog::throttle(last, 0.0));
+}
+
+// concurrent calls of a site in the same window, exactly one of them logs
+TEST(AsyncLog, ThrottleConcurrentCalls)
+{
+  boost::atomic<boost::int64_t> sites[THROTTLE_ROUNDS];
+  for (int round = 0; round < THROTTLE_ROUNDS; round++)
+    sites[round].store(0);
+  boost::barrier start(THROTTLE_CALLERS);
+  int allowed[THROTTLE_CALLERS];
+  boost::thread_group callers;
+  for (int caller = 0; caller < THROTTLE_CALLERS; caller++)
+    callers.create_thread(boost::bind(throttleCaller, sites, &start, &allowed[caller]));
+  callers.join_all();
+
+  int sum = 0;
+  for (int caller = 0; caller < THROTTLE_CALLERS; caller++)
+    sum += allowed[caller];
+  EXPECT_EQ(THROTTLE_ROUNDS, sum);
+}
+
+// the sites below ASYNC_LOG_LEVEL are removed with their arguments, and the throttle is per site
+TEST(AsyncLog, Macros)
+{
+  int evaluated = 0;
+  OutputCapture capture;
+  ASYNC_LOG_DEBUG("removed %d", ++evaluated);
+  for (int i = 0; i < 10; i++)
+    ASYNC_LOG_INFO_THROTTLE(1000.0, "throttled %d", i);
+  ASYNC_LOG_INFO("kept");
+  std::string out, err;
+  ASSERT_TRUE(capture.finish(out, err));
+
+  EXPECT_EQ(0, evaluated);
+  std::vector<std::string> out_lines = lines(out);
+  ASSERT_EQ(2u, out_lines.size());
+  EXPECT_NE(std::string::npos, out_lines[0].find("throttled 0"));
+  EXPECT_NE(std::string::npos, out_lines[1].find("kept"));
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -30,6 +30,7 @@
 #include "sensor_msgs/Imu.h"
 #include "geometry_msgs/TwistWithCovarianceStamped.h"
 #include <fstream>
+#include <aurova_log/async_log.h>
 
 // [publisher subscriber headers]
 
@@ -18,7 +18,7 @@ DumpImuDataForCalibrationWithImutkAlgNode::DumpImuDataForCalibrationWithImutkAlg
   // [init action servers]
   
   // [init action clients]
-  std::cout << "Creating output files " << std::endl;
+  ASYNC_LOG_INFO("Creating output files");
 
   std::string acc_filename;
   this->public_node_handle_.getParam("/dump_imu_data_for_calibration_with_imutk/accelerometer_output_file_path", acc_filename);
@@ -31,7 +31,7 @@ DumpImuDataForCalibrationWithImutkAlgNode::DumpImuDataForCalibrationWithImutkAlg
   acc_results_file_.open(acc_filename.c_str(), std::ofstream::trunc);
   gyro_results_file_.open(gyro_filename.c_str(), std::ofstream::trunc);
 
-  std::cout << "Output files created!" << std::endl;
+  ASYNC_LOG_INFO("Output files created!");
 
   flag_first_time_stamp_received_ = false;
   first_timestamp_ = 0.0;
@@ -52,9 +52,7 @@ DumpImuDataForCalibrationWithImutkAlgNode::~DumpImuDataForCalibrationWithImutkAl
   acc_results_file_  << acc_data_ready_to_be_written_to_file_;
   gyro_results_file_ << gyro_data_ready_to_be_written_to_file_;
 
-  std::cout << acc_data_ready_to_be_written_to_file_;
-
-  std::cout << "Closing output files " << std::endl;
+  ASYNC_LOG_INFO("Closing output files");
 
   acc_results_file_.close();
   gyro_results_file_.close();
@@ -76,15 +74,15 @@ void DumpImuDataForCalibrationWithImutkAlgNode::mainNodeThread(void)
     ROS_WARN_STREAM("Waiting for imu data...");
   }
 
-  if (flag_recording_data_ && number_of_static_samples_in_current_interval_ % 10 <= 2)
+  if (flag_recording_data_)
   {
-    std::cout << "Static IMU samples gathered in current interval: " << number_of_static_samples_in_current_interval_ << std::endl;
+    ASYNC_LOG_INFO_THROTTLE(1.0, "Static IMU samples gathered in current interval: %d",
+                            number_of_static_samples_in_current_interval_);
   }
-
-
-  if (!flag_recording_data_ && number_of_transient_samples_in_current_interval_ % 10 <= 2)
+  else
   {
-    std::cout << "Transient IMU samples between static intervals: " << number_of_transient_samples_in_current_interval_ << std::endl;
+    ASYNC_LOG_INFO_THROTTLE(1.0, "Transient IMU samples between static intervals: %d",
+                            number_of_transient_samples_in_current_interval_);
   }
 }
 
@@ -97,7 +95,7 @@ void DumpImuDataForCalibrationWithImutkAlgNode::cb_imuData(const sensor_msgs::Im
   {
     flag_first_time_stamp_received_ = true;
     first_timestamp_ = Imu_msg.header.stamp.sec + (Imu_msg.header.stamp.nsec * 1e-9);
-    std::cout << "First imu data received!!" << std::endl;
+    ASYNC_LOG_INFO("First imu data received!!");
   }
 
 
@@ -138,8 +136,6 @@ void DumpImuDataForCalibrationWithImutkAlgNode::cb_imuData(const sensor_msgs::Im
     number_of_transient_samples_in_current_interval_++;
   }
 
-  //std::cout << s_acc.str();
-
   this->alg_.unlock();
 }
 
@@ -161,13 +157,13 @@ void DumpImuDataForCalibrationWithImutkAlgNode::node_config_update(Config &confi
     if(flag_recording_data_)
     {
       static_interval_id_++;
-      std::cout << "Recording static interval number " << static_interval_id_ << std::endl;
+      ASYNC_LOG_INFO("Recording static interval number %d", static_interval_id_);
       number_of_transient_samples_in_current_interval_ = 0;
     }
     else
     {
-      std::cout << "Stop recording, static interval number " << static_interval_id_
-          << " finished with " << number_of_static_samples_in_current_interval_ << " IMU samples" << std::endl;
+      ASYNC_LOG_INFO("Stop recording, static interval number %d finished with %d IMU samples", static_interval_id_,
+                     number_of_static_samples_in_current_interval_);
       number_of_static_samples_in_current_interval_ = 0;
     }
   }
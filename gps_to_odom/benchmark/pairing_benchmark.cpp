@@ -0,0 +1,95 @@
+/**
+ * \file pairing_benchmark.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: m.a.munoz
+ *
+ * Epochs paired by FixVelocityPairing on a simulated 20 Hz receiver, whose
+ * fixes and velocities reach the node with different random delays, and the
+ * cost of adding a sample and popping the pairs.
+ */
+
+#include "fix_velocity_pairing.h"
+#include "ros/time.h"
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+namespace
+{
+
+const int BENCHMARK_EPOCHS = 200000;
+const double RECEIVER_PERIOD = 0.05;
+
+struct Arrival
+{
+  double time;
+  bool fix;
+  nav_msgs::Odometry sample;
+
+  bool operator<(const Arrival& other) const
+  {
+    return time < other.time;
+  }
+};
+
+double uniform(double min, double max)
+{
+  return min + (max - min) * rand() / (double)RAND_MAX;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+  // fixes delayed 80 to 120 ms, velocities 30 to 70 ms, so each stream stays
+  // ordered but the velocity of an epoch arrives before its fix, a velocity
+  // stamp jitter of 5 ms and 1 % of the messages lost
+  std::vector<Arrival> arrivals;
+  arrivals.reserve(2 * BENCHMARK_EPOCHS);
+  for (int epoch = 0; epoch < BENCHMARK_EPOCHS; epoch++)
+  {
+    double stamp = 1000.0 + epoch * RECEIVER_PERIOD;
+    Arrival fix;
+    fix.fix = true;
+    fix.time = stamp + uniform(0.08, 0.12);
+    fix.sample.header.stamp = ros::Time(stamp);
+    fix.sample.pose.pose.position.x = epoch;
+    if (uniform(0.0, 1.0) > 0.01)
+      arrivals.push_back(fix);
+
+    Arrival velocity;
+    velocity.fix = false;
+    velocity.time = stamp + uniform(0.03, 0.07);
+    velocity.sample.header.stamp = ros::Time(stamp + uniform(-0.005, 0.005));
+    if (uniform(0.0, 1.0) > 0.01)
+      arrivals.push_back(velocity);
+  }
+  std::stable_sort(arrivals.begin(), arrivals.end());
+
+  FixVelocityPairing pairing;
+  nav_msgs::Odometry odometry;
+  unsigned long mismatched = 0;
+  ros::WallTime start = ros::WallTime::now();
+  for (size_t i = 0; i < arrivals.size(); i++)
+  {
+    if (arrivals[i].fix)
+      pairing.addFix(arrivals[i].sample);
+    else
+      pairing.addVelocity(arrivals[i].sample);
+    while (pairing.nextPair(odometry))
+    {
+      if (fabs(odometry.header.stamp.toSec() - 1000.0 - odometry.pose.pose.position.x * RECEIVER_PERIOD) > 1e-6)
+        mismatched++;
+    }
+  }
+  double elapsed = (ros::WallTime::now() - start).toSec();
+
+  printf("paired %lu of %d epochs (%.2f %%), %lu unpaired fixes, %lu unpaired velocities, %lu mismatched\n",
+         pairing.paired_epochs_, BENCHMARK_EPOCHS, 100.0 * pairing.paired_epochs_ / BENCHMARK_EPOCHS,
+         pairing.unpaired_fixes_, pairing.unpaired_velocities_, mismatched);
+  printf("%.1f ns per sample\n", elapsed / arrivals.size() * 1e9);
+  return 0;
+}
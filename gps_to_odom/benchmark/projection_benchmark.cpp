@@ -0,0 +1,83 @@
+/**
+ * \file projection_benchmark.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: m.a.munoz
+ *
+ * Cost of a UTM and of a local ENU projection, one fix at a time and in
+ * batches.
+ */
+
+#include "geodetic_projection.h"
+#include "ros/time.h"
+#include <stdio.h>
+#include <vector>
+
+namespace
+{
+
+const size_t BENCHMARK_FIXES = 4096;
+const int BENCHMARK_REPEATS = 500;
+
+}
+
+int main(int argc, char *argv[])
+{
+  // fixes spread over a 20 km square around Alicante
+  std::vector<double> latitude(BENCHMARK_FIXES), longitude(BENCHMARK_FIXES), altitude(BENCHMARK_FIXES);
+  for (size_t i = 0; i < BENCHMARK_FIXES; i++)
+  {
+    latitude[i] = 38.3 + 0.2 * (i % 64) / 64.0;
+    longitude[i] = -0.6 + 0.2 * (i / 64) / 64.0;
+    altitude[i] = 100.0 + (i % 7);
+  }
+  std::vector<double> x(BENCHMARK_FIXES), y(BENCHMARK_FIXES), z(BENCHMARK_FIXES);
+
+  UtmProjection utm;
+  utm.setZone(UtmProjection::zoneOf(latitude[0], longitude[0]), true);
+  LocalEnuProjection enu;
+  enu.setOrigin(latitude[0], longitude[0], altitude[0]);
+
+  // the checksum keeps the loops
+  double checksum = 0.0;
+  double fixes = (double)BENCHMARK_FIXES * BENCHMARK_REPEATS;
+
+  ros::WallTime start = ros::WallTime::now();
+  for (int repeat = 0; repeat < BENCHMARK_REPEATS; repeat++)
+  {
+    for (size_t i = 0; i < BENCHMARK_FIXES; i++)
+      utm.project(latitude[i], longitude[i], x[i], y[i]);
+    checksum += x[repeat % BENCHMARK_FIXES];
+  }
+  double utm_single = (ros::WallTime::now() - start).toSec() / fixes * 1e9;
+
+  start = ros::WallTime::now();
+  for (int repeat = 0; repeat < BENCHMARK_REPEATS; repeat++)
+  {
+    utm.project(&latitude[0], &longitude[0], BENCHMARK_FIXES, &x[0], &y[0]);
+    checksum += y[repeat % BENCHMARK_FIXES];
+  }
+  double utm_batch = (ros::WallTime::now() - start).toSec() / fixes * 1e9;
+
+  start = ros::WallTime::now();
+  for (int repeat = 0; repeat < BENCHMARK_REPEATS; repeat++)
+  {
+    for (size_t i = 0; i < BENCHMARK_FIXES; i++)
+      enu.project(latitude[i], longitude[i], altitude[i], x[i], y[i], z[i]);
+    checksum += z[repeat % BENCHMARK_FIXES];
+  }
+  double enu_single = (ros::WallTime::now() - start).toSec() / fixes * 1e9;
+
+  start = ros::WallTime::now();
+  for (int repeat = 0; repeat < BENCHMARK_REPEATS; repeat++)
+  {
+    enu.project(&latitude[0], &longitude[0], &altitude[0], BENCHMARK_FIXES, &x[0], &y[0], &z[0]);
+    checksum += x[repeat % BENCHMARK_FIXES];
+  }
+  double enu_batch = (ros::WallTime::now() - start).toSec() / fixes * 1e9;
+
+  printf("projection of %.0f fixes [ns per fix]: utm %.1f, utm batch %.1f, local enu %.1f, local enu batch %.1f"
+         " (checksum %.3f)\n",
+         fixes, utm_single, utm_batch, enu_single, enu_batch, checksum);
+  return 0;
+}
@@ -0,0 +1,134 @@
+/**
+ * \file propagator_benchmark.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: m.a.munoz
+ *
+ * Position error of the fixes published by FixPropagator on a simulated
+ * 20 Hz receiver driving a slalom, whose fixes reach the node 50 to 150 ms
+ * late, without compensation and with each motion model, and the cost of a
+ * velocity update and a propagation. The cost includes the copy of the
+ * odometry, which is all of it with the compensation off.
+ */
+
+#include "fix_propagator.h"
+#include "ros/time.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+namespace
+{
+
+const int BENCHMARK_EPOCHS = 200000;
+const double RECEIVER_PERIOD = 0.05;
+const double DRIVE_SPEED = 10.0;
+
+struct Epoch
+{
+  nav_msgs::Odometry fix;
+  ros::Time publish;
+  double true_x;
+  double true_y;
+};
+
+double uniform(double min, double max)
+{
+  return min + (max - min) * rand() / (double)RAND_MAX;
+}
+
+/**
+ * \brief Heading of the slalom at the given time in [rad], it swings 0.5 rad
+ * with a 10 s period.
+ */
+double slalomHeading(double t)
+{
+  return 0.5 * sin(2.0 * M_PI * t / 10.0);
+}
+
+/**
+ * \brief Moves along the slalom from time t for the given duration, with the
+ * midpoint rule at 1 ms.
+ */
+void drive(double t, double duration, double& x, double& y)
+{
+  while (duration > 0.0)
+  {
+    double step = duration < 0.001 ? duration : 0.001;
+    x += step * DRIVE_SPEED * cos(slalomHeading(t + 0.5 * step));
+    y += step * DRIVE_SPEED * sin(slalomHeading(t + 0.5 * step));
+    t += step;
+    duration -= step;
+  }
+}
+
+/**
+ * \brief Root mean square position error in [m] of the published fixes, and
+ * the mean time of a velocity update and a propagation in [ns].
+ */
+double compensationError(PropagationModel model, const std::vector<Epoch>& epochs, double& cost)
+{
+  FixPropagator propagator;
+  propagator.setModel(model, 1.0, 0.5);
+  std::vector<nav_msgs::Odometry> published(epochs.size());
+
+  ros::WallTime start = ros::WallTime::now();
+  for (size_t i = 0; i < epochs.size(); i++)
+  {
+    const nav_msgs::Odometry& fix = epochs[i].fix;
+    published[i] = fix;
+    propagator.addVelocity(fix.header.stamp, fix.twist.twist.linear.x, fix.twist.twist.linear.y, 0.5);
+    propagator.propagate(published[i], epochs[i].publish);
+  }
+  cost = (ros::WallTime::now() - start).toSec() / epochs.size() * 1e9;
+
+  double squared_error = 0.0;
+  for (size_t i = 0; i < epochs.size(); i++)
+  {
+    double error_x = published[i].pose.pose.position.x - epochs[i].true_x;
+    double error_y = published[i].pose.pose.position.y - epochs[i].true_y;
+    squared_error += error_x * error_x + error_y * error_y;
+  }
+  return sqrt(squared_error / epochs.size());
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+  std::vector<Epoch> epochs(BENCHMARK_EPOCHS);
+  double x = 0.0, y = 0.0;
+  for (int i = 0; i < BENCHMARK_EPOCHS; i++)
+  {
+    double stamp = (i + 1) * RECEIVER_PERIOD;
+    drive(stamp - RECEIVER_PERIOD, RECEIVER_PERIOD, x, y);
+    double delay = uniform(0.05, 0.15);
+
+    Epoch& epoch = epochs[i];
+    epoch.fix.header.stamp = ros::Time(1000.0 + stamp);
+    epoch.fix.pose.pose.position.x = x;
+    epoch.fix.pose.pose.position.y = y;
+    epoch.fix.pose.pose.orientation.w = 1.0;
+    epoch.fix.twist.twist.linear.x = DRIVE_SPEED * cos(slalomHeading(stamp));
+    epoch.fix.twist.twist.linear.y = DRIVE_SPEED * sin(slalomHeading(stamp));
+    epoch.publish = ros::Time(1000.0 + stamp + delay);
+    epoch.true_x = x;
+    epoch.true_y = y;
+    drive(stamp, delay, epoch.true_x, epoch.true_y);
+  }
+
+  // warm up
+  double off_cost, velocity_cost, turn_rate_cost;
+  compensationError(PROPAGATION_CONSTANT_TURN_RATE, epochs, turn_rate_cost);
+
+  double off = compensationError(PROPAGATION_OFF, epochs, off_cost);
+  double velocity = compensationError(PROPAGATION_CONSTANT_VELOCITY, epochs, velocity_cost);
+  double turn_rate = compensationError(PROPAGATION_CONSTANT_TURN_RATE, epochs, turn_rate_cost);
+
+  printf("rms position error of %d fixes delayed 50 to 150 ms at %.0f m/s [m]: off %.4f, constant velocity %.4f, "
+         "constant turn rate %.4f\n", BENCHMARK_EPOCHS, DRIVE_SPEED, off, velocity, turn_rate);
+  printf("velocity update and propagation [ns]: off %.1f, constant velocity %.1f, constant turn rate %.1f\n",
+         off_cost, velocity_cost, turn_rate_cost);
+  return 0;
+}
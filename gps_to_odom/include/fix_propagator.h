@@ -0,0 +1,120 @@
+/**
+ * \file fix_propagator.h
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: m.a.munoz
+ */
+
+#ifndef _fix_propagator_h_
+#define _fix_propagator_h_
+
+#include "nav_msgs/Odometry.h"
+
+/**
+ * \brief Motion models of the latency compensation, same values as latency_compensation in GpsToOdom.cfg
+ */
+enum PropagationModel
+{
+  PROPAGATION_OFF = 0,
+  PROPAGATION_CONSTANT_VELOCITY = 1,
+  PROPAGATION_CONSTANT_TURN_RATE = 2
+};
+
+/**
+ * \brief Latency compensation of the gnss odometry
+ *
+ * Propagates a paired fix from its measurement epoch to the publish time with
+ * the velocity of its epoch, at constant velocity or at constant speed and
+ * turn rate, and inflates the covariance to first order: the velocity
+ * covariance through the displacement, a white acceleration noise and, with
+ * the turn rate, the turn rate noise across the heading.
+ *
+ * The turn rate is the rate of change of the heading of consecutive
+ * velocities, and its variance is estimated online from the differences of
+ * consecutive turn rates. The delay between the fix epoch and its arrival at
+ * the node is also measured online.
+ */
+class FixPropagator
+{
+private:
+
+  PropagationModel model_;
+  double acceleration_variance_;
+  double max_propagation_;
+
+  // heading of the last velocity above the minimum speed
+  bool heading_valid_;
+  ros::Time heading_stamp_;
+  double heading_;
+
+  // filtered turn rate and its variance
+  bool turn_rate_valid_;
+  double turn_rate_;
+  double turn_rate_variance_;
+
+public:
+
+  // delay from the fix epoch to its arrival [s]
+  unsigned long delay_samples_;
+  double last_delay_;
+  double mean_delay_;
+  double max_delay_;
+
+  // fixes older than the maximum propagation time when they were published
+  unsigned long stale_fixes_;
+
+  /**
+   * \brief Constructor of FixPropagator class
+   *
+   * The propagation is off until setModel() is called.
+   */
+  FixPropagator(void);
+
+  /**
+   * \brief Sets the propagation model.
+   *
+   * @param model is the motion model, or PROPAGATION_OFF.
+   * @param acceleration_variance is the variance of the white acceleration
+   * noise in [m^2/s^4].
+   * @param max_propagation is the maximum propagation time in [s], older
+   * fixes are published at their epoch.
+   */
+  void setModel(PropagationModel model, double acceleration_variance, double max_propagation);
+
+  /**
+   * \brief Forgets the turn rate and the delay statistics.
+   */
+  void reset(void);
+
+  /**
+   * \brief Measures the delay of a fix.
+   *
+   * @param stamp is the epoch of the fix.
+   * @param arrival is the time the fix was received.
+   */
+  void addDelay(const ros::Time& stamp, const ros::Time& arrival);
+
+  /**
+   * \brief Updates the turn rate with a velocity.
+   *
+   * @param stamp is the epoch of the velocity.
+   * @param velocity_x is the velocity along x in the map frame in [m/s].
+   * @param velocity_y is the velocity along y in the map frame in [m/s].
+   * @param min_speed is the speed in [m/s] under which the heading is not
+   * observable and the turn rate is reset.
+   */
+  void addVelocity(const ros::Time& stamp, double velocity_x, double velocity_y, double min_speed);
+
+  /**
+   * \brief Propagates the odometry of a pair to the given time.
+   *
+   * The position, the velocity, the orientation and their covariance are
+   * propagated, and the stamp is set to the given time.
+   *
+   * \return false if the odometry was not changed, because the propagation is
+   * off or the fix is not in the propagation window.
+   */
+  bool propagate(nav_msgs::Odometry& odometry, const ros::Time& time);
+};
+
+#endif /* _fix_propagator_h_ */
@@ -0,0 +1,92 @@
+/**
+ * \file fix_velocity_pairing.h
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: m.a.munoz
+ */
+
+#ifndef _fix_velocity_pairing_h_
+#define _fix_velocity_pairing_h_
+
+#include "nav_msgs/Odometry.h"
+#include <boost/circular_buffer.hpp>
+
+// capacity of the pending fixes and velocities (0.8 s at 20 Hz)
+#define PAIRING_BUFFER_SIZE 16
+
+/**
+ * \brief Gnss fix and velocity pairing
+ *
+ * Keeps the fixes and velocities waiting for their pair in short buffers
+ * ordered by header stamp, and pairs the fix and the velocity of the same
+ * epoch, whose stamps differ at most by the tolerance. Both streams are
+ * ordered, so a pending sample that is older than the oldest sample of the
+ * other stream by more than the tolerance can never be paired and is dropped.
+ * A pair is available as soon as its second sample is added.
+ *
+ * The samples are odometry messages: the fixes carry the header, the position
+ * and its covariance, and the velocities the orientation, the twist and their
+ * covariance.
+ */
+class FixVelocityPairing
+{
+private:
+
+  boost::circular_buffer<nav_msgs::Odometry> fix_buffer_;
+  boost::circular_buffer<nav_msgs::Odometry> velocity_buffer_;
+
+  // maximum difference between the stamps of a pair [s]
+  double tolerance_;
+
+  /**
+   * \brief Adds a sample to a buffer, dropping it if it is not newer than the last one.
+   *
+   * \return false if the sample, or the oldest one of a full buffer, was dropped.
+   */
+  bool add(boost::circular_buffer<nav_msgs::Odometry>& buffer, const nav_msgs::Odometry& sample);
+
+public:
+
+  // pairing statistics
+  unsigned long paired_epochs_;
+  unsigned long unpaired_fixes_;
+  unsigned long unpaired_velocities_;
+  // stamp of the fix minus stamp of the velocity of the last pair [s]
+  double last_offset_;
+
+  /**
+   * \brief Constructor of FixVelocityPairing class
+   */
+  FixVelocityPairing(void);
+
+  /**
+   * \brief Maximum difference in [s] between the stamps of a paired fix and velocity.
+   */
+  void setTolerance(double tolerance);
+
+  /**
+   * \brief Empties the buffers and the statistics.
+   */
+  void reset(void);
+
+  /**
+   * \brief Adds a fix, with the header, the position and its covariance.
+   */
+  void addFix(const nav_msgs::Odometry& fix);
+
+  /**
+   * \brief Adds a velocity, with the orientation, the twist and their covariance.
+   */
+  void addVelocity(const nav_msgs::Odometry& velocity);
+
+  /**
+   * \brief Pops the oldest pair.
+   *
+   * @param odometry gets the velocity message with the header, the position
+   * and the position covariance of the fix.
+   * \return false if no pair is complete yet.
+   */
+  bool nextPair(nav_msgs::Odometry& odometry);
+};
+
+#endif /* _fix_velocity_pairing_h_ */
@@ -0,0 +1,198 @@
+/**
+ * \file geodetic_projection.h
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: m.a.munoz
+ */
+
+#ifndef _geodetic_projection_h_
+#define _geodetic_projection_h_
+
+#include <stddef.h>
+
+// WGS84 ellipsoid
+#define WGS84_SEMI_MAJOR_AXIS 6378137.0
+#define WGS84_FLATTENING (1.0 / 298.257223563)
+
+// order of the Krueger series
+#define KRUEGER_ORDER 6
+
+// terms of the series of e atanh(e sin(phi)), exact in double for e < 0.1
+#define DELTA_TERMS 8
+
+/**
+ * \brief Projections of the gps fixes, same values as projection in GpsToOdom.cfg
+ */
+enum GeodeticProjection
+{
+  PROJECTION_UTM = 0,
+  PROJECTION_LOCAL_ENU = 1
+};
+
+/**
+ * \brief Projection of geodetic coordinates to UTM
+ *
+ * Transverse Mercator with the Krueger series in the third flattening
+ * (Karney, 2011), whose truncation error is far below a millimetre in the
+ * zone, in double precision. The series coefficients of the ellipsoid are
+ * computed in the constructor, and the central meridian and the false
+ * northing of the zone in setZone(), so a projection only evaluates the
+ * conformal latitude and the series, with four trigonometric functions, an
+ * arctangent and a logarithm.
+ *
+ * The zone is fixed, so the coordinates stay continuous when the vehicle
+ * crosses a zone border or the equator.
+ */
+class UtmProjection
+{
+private:
+
+  // coefficients of the series of e atanh(e sin(phi)) in sin(phi)
+  double delta_coefficients_[DELTA_TERMS];
+  // radius of the rectifying sphere times the scale factor
+  double scaled_radius_;
+  // series coefficients
+  double alpha_[KRUEGER_ORDER + 1];
+
+  // current zone
+  int zone_;
+  bool north_;
+  double central_meridian_;
+  double false_northing_;
+
+public:
+
+  /**
+   * \brief Constructor of UtmProjection class
+   *
+   * Has no zone until setZone() is called.
+   *
+   * @param semi_major_axis is the semi-major axis of the ellipsoid in [m].
+   * @param flattening is the flattening of the ellipsoid.
+   */
+  UtmProjection(double semi_major_axis = WGS84_SEMI_MAJOR_AXIS, double flattening = WGS84_FLATTENING);
+
+  /**
+   * \brief UTM zone of a geodetic position, with the Norway and Svalbard exceptions.
+   *
+   * @param latitude is the latitude in [deg].
+   * @param longitude is the longitude in [deg].
+   * \return the zone number, from 1 to 60.
+   */
+  static int zoneOf(double latitude, double longitude);
+
+  /**
+   * \brief Selects the zone of the projection.
+   *
+   * @param zone is the zone number, from 1 to 60, or 0 to leave the projection
+   * without zone.
+   * @param north selects the northern hemisphere (false northing of 0 m
+   * instead of 10000 km).
+   */
+  void setZone(int zone, bool north);
+
+  /**
+   * \brief Zone of the projection, 0 if it is not set.
+   */
+  int zone(void) const
+  {
+    return zone_;
+  }
+
+  bool north(void) const
+  {
+    return north_;
+  }
+
+  /**
+   * \brief Projects a geodetic position into the zone.
+   *
+   * @param latitude is the latitude in [deg].
+   * @param longitude is the longitude in [deg].
+   * @param easting is the UTM easting in [m].
+   * @param northing is the UTM northing in [m].
+   */
+  void project(double latitude, double longitude, double& easting, double& northing) const;
+
+  /**
+   * \brief Projects an array of geodetic positions into the zone.
+   *
+   * @param count is the number of positions.
+   */
+  void project(const double* latitude, const double* longitude, size_t count, double* easting,
+               double* northing) const;
+};
+
+/**
+ * \brief Local east, north, up coordinates
+ *
+ * Cartesian coordinates tangent to the ellipsoid at an origin, through the
+ * earth centred frame, exact at any distance. The earth centred origin and
+ * its rotation are computed once in setOrigin().
+ */
+class LocalEnuProjection
+{
+private:
+
+  double semi_major_axis_;
+  double eccentricity_squared_;
+
+  // earth centred coordinates of the origin
+  double origin_x_;
+  double origin_y_;
+  double origin_z_;
+
+  // sines and cosines of the origin latitude and longitude
+  double sin_latitude_;
+  double cos_latitude_;
+  double sin_longitude_;
+  double cos_longitude_;
+
+  /**
+   * \brief Earth centred coordinates of a geodetic position.
+   */
+  void toEarthCentred(double latitude, double longitude, double altitude, double& x, double& y, double& z) const;
+
+public:
+
+  /**
+   * \brief Constructor of LocalEnuProjection class
+   *
+   * The origin is at latitude and longitude 0 until setOrigin() is called.
+   *
+   * @param semi_major_axis is the semi-major axis of the ellipsoid in [m].
+   * @param flattening is the flattening of the ellipsoid.
+   */
+  LocalEnuProjection(double semi_major_axis = WGS84_SEMI_MAJOR_AXIS, double flattening = WGS84_FLATTENING);
+
+  /**
+   * \brief Sets the origin of the local coordinates.
+   *
+   * @param latitude is the latitude in [deg].
+   * @param longitude is the longitude in [deg].
+   * @param altitude is the height above the ellipsoid in [m].
+   */
+  void setOrigin(double latitude, double longitude, double altitude);
+
+  /**
+   * \brief Projects a geodetic position into the local coordinates.
+   *
+   * @param latitude is the latitude in [deg].
+   * @param longitude is the longitude in [deg].
+   * @param altitude is the height above the ellipsoid in [m].
+   * @param east is the east coordinate in [m].
+   * @param north is the north coordinate in [m].
+   * @param up is the up coordinate in [m].
+   */
+  void project(double latitude, double longitude, double altitude, double& east, double& north, double& up) const;
+
+  /**
+   * \brief Projects an array of geodetic positions into the local coordinates.
+   *
+   * @param count is the number of positions.
+   */
+  void project(const double* latitude, const double* longitude, const double* altitude, size_t count,
+               double* east, double* north, double* up) const;
+};
+
+#endif /* _geodetic_projection_h_ */
@@ -39,7 +39,7 @@
 #include "geometry_msgs/TwistWithCovarianceStamped.h"
 #include "geometry_msgs/Vector3Stamped.h"
 #include "math.h"
-#include "planning/graph.h"
+#include "geodetic_projection.h"
 
 //include gps_to_odom_alg main library
 
@@ -32,7 +32,13 @@
 #define _gps_to_odom_alg_node_h_
 
 #include <iri_base_algorithm/iri_base_algorithm.h>
+#include <dynamic_reconfigure/server.h>
 #include "gps_to_odom_alg.h"
+#include "fix_velocity_pairing.h"
+#include "fix_propagator.h"
+#include <aurova_log/async_log.h>
+#include <boost/atomic.hpp>
+#include <boost/make_shared.hpp>
 #include "tf_conversions/tf_eigen.h"
 #include <eigen_conversions/eigen_msg.h>
 #include <Eigen/Dense>
@@ -52,15 +58,33 @@ class GpsToOdomAlgNode : public algorithm_base::IriBaseAlgorithm<GpsToOdomAlgori
 private:
 
   bool flag_publish_odom_;
-  bool flag_gnss_position_received_;
-  bool flag_gnss_velocity_received_;
   float max_speed_;
   float min_speed_;
   std::string frame_id_;
   nav_msgs::Odometry odom_gps_;
-  tf::StampedTransform utm_trans_;
+
+  // orientation, twist and their covariance from the last velocity, kept
+  // while the speed is too low to update the orientation
+  nav_msgs::Odometry velocity_odom_;
+
+  // pairs the fixes and the velocities of the same epoch
+  FixVelocityPairing pairing_;
+
+  // latency compensation of the pairs and delay measurement of the fixes
+  FixPropagator propagator_;
   tf::TransformListener listener_;
 
+  // cached map <- utm transform and its rotation, refreshed by cb_utmTransformTimer
+  tf::StampedTransform utm_trans_;
+  Eigen::Matrix3d utm_rotation_;
+  Eigen::Matrix3d utm_rotation_transpose_;
+  bool utm_trans_resolved_;
+  ros::Timer utm_transform_timer_;
+
+  // projections of the gps fixes, set up in node_config_update
+  UtmProjection utm_projection_;
+  LocalEnuProjection enu_projection_;
+
   // [publisher attributes]
   ros::Publisher odom_gps_pub_;
 
@@ -71,6 +95,19 @@ private:
   ros::Subscriber bot_vel_sub_;
 
 
+  /**
+   * \brief Refreshes the cached map <- utm transform without blocking.
+   *
+   * The rotation and its transpose are only recomputed when the stamp of the
+   * transform changes, so a static transform is resolved once.
+   */
+  void cb_utmTransformTimer(const ros::TimerEvent& event);
+
+  /**
+   * \brief Publishes the odometry of every completed fix and velocity pair.
+   */
+  void publishPairs(void);
+
 	/**
    * \brief callback for read gps fix messages (from gazebo)
    * This message can be read from different localization sources by remapping in the
@@ -114,6 +151,35 @@ private:
    * Is updated everytime function config_update() is called.
    */
   Config config_;
+
+  // node loop when loaded as a nodelet, see startNodeLoop()
+  pthread_t node_loop_thread_;
+  boost::atomic<bool> node_loop_running_;
+
+  /**
+   * \brief Node loop thread
+   *
+   * Same loop as the one run by algorithm_base::main: mainNodeThread() and the
+   * diagnostics update at the loop rate.
+   */
+  static void *nodeLoopThread(void *param);
+
+  // dynamic reconfigure server on the private namespace of the nodelet
+  boost::shared_ptr<dynamic_reconfigure::Server<Config> > nodelet_reconfigure_server_;
+
+  /**
+   * \brief Dynamic reconfigure callback of the nodelet server
+   *
+   * Updates the algorithm and the node configuration, as the callback of the
+   * base class server.
+   */
+  void nodeletConfigUpdate(Config &config, uint32_t level);
+
+  /**
+   * \brief Initializes the node attributes and its ROS communications.
+   */
+  void init(void);
+
 public:
   /**
    * \brief Constructor
@@ -123,6 +189,18 @@ public:
    */
   GpsToOdomAlgNode(void);
 
+  /**
+   * \brief Nodelet constructor
+   *
+   * Same as the default constructor, with the node handles of the nodelet
+   * instead of the ones of the process, and a dynamic reconfigure server on
+   * the private namespace of the nodelet.
+   *
+   * @param node_handle is the nodelet node handle.
+   * @param private_node_handle is the nodelet private node handle.
+   */
+  GpsToOdomAlgNode(const ros::NodeHandle& node_handle, const ros::NodeHandle& private_node_handle);
+
   /**
    * \brief Destructor
    *
@@ -131,6 +209,20 @@ public:
    */
   ~GpsToOdomAlgNode(void);
 
+  /**
+   * \brief Starts the node loop
+   *
+   * Used by the nodelet, which can not block in algorithm_base::main. Adds the
+   * node diagnostics and runs mainNodeThread() in its own thread until
+   * stopNodeLoop() is called. The callbacks are served by the nodelet manager.
+   */
+  void startNodeLoop(void);
+
+  /**
+   * \brief Stops the node loop started with startNodeLoop().
+   */
+  void stopNodeLoop(void);
+
 protected:
   /**
    * \brief main node thread
@@ -170,6 +262,16 @@ protected:
 
   // [diagnostic functions]
 
+  /**
+   * \brief Pairing statistics of the fixes and velocities.
+   */
+  void pairingDiagnostic(diagnostic_updater::DiagnosticStatusWrapper &stat);
+
+  /**
+   * \brief Delay of the fixes and latency compensation statistics.
+   */
+  void latencyDiagnostic(diagnostic_updater::DiagnosticStatusWrapper &stat);
+
   // [test functions]
 };
 
@@ -0,0 +1,164 @@
+#include "fix_propagator.h"
+#include <tf/tf.h>
+#include <Eigen/Dense>
+#include <math.h>
+
+// weight of a new sample in the running means of the delay and the turn rate variance
+#define PROPAGATION_FILTER_WEIGHT 0.1
+
+// maximum time between two velocities to differentiate their headings [s]
+#define MAX_HEADING_GAP 1.0
+
+FixPropagator::FixPropagator(void)
+{
+  this->model_ = PROPAGATION_OFF;
+  this->acceleration_variance_ = 1.0;
+  this->max_propagation_ = 0.5;
+  this->reset();
+}
+
+void FixPropagator::setModel(PropagationModel model, double acceleration_variance, double max_propagation)
+{
+  this->model_ = model;
+  this->acceleration_variance_ = acceleration_variance;
+  this->max_propagation_ = max_propagation;
+}
+
+void FixPropagator::reset(void)
+{
+  this->heading_valid_ = false;
+  this->heading_ = 0.0;
+  this->turn_rate_valid_ = false;
+  this->turn_rate_ = 0.0;
+  this->turn_rate_variance_ = 0.0;
+
+  this->delay_samples_ = 0;
+  this->last_delay_ = 0.0;
+  this->mean_delay_ = 0.0;
+  this->max_delay_ = 0.0;
+  this->stale_fixes_ = 0;
+}
+
+void FixPropagator::addDelay(const ros::Time& stamp, const ros::Time& arrival)
+{
+  this->last_delay_ = (arrival - stamp).toSec();
+  if (this->delay_samples_ == 0)
+    this->mean_delay_ = this->last_delay_;
+  else
+    this->mean_delay_ += PROPAGATION_FILTER_WEIGHT * (this->last_delay_ - this->mean_delay_);
+  if (this->delay_samples_ == 0 || this->last_delay_ > this->max_delay_)
+    this->max_delay_ = this->last_delay_;
+  this->delay_samples_++;
+}
+
+void FixPropagator::addVelocity(const ros::Time& stamp, double velocity_x, double velocity_y, double min_speed)
+{
+  if (sqrt(velocity_x * velocity_x + velocity_y * velocity_y) <= min_speed)
+  {
+    this->heading_valid_ = false;
+    this->turn_rate_valid_ = false;
+    return;
+  }
+
+  double heading = atan2(velocity_y, velocity_x);
+  double elapsed = (stamp - this->heading_stamp_).toSec();
+  if (this->heading_valid_ && elapsed > 0.0 && elapsed < MAX_HEADING_GAP)
+  {
+    double turn_rate = atan2(sin(heading - this->heading_), cos(heading - this->heading_)) / elapsed;
+
+    // half the mean squared difference of consecutive turn rates, the noise
+    // variance of a turn rate that changes slowly between samples
+    if (this->turn_rate_valid_)
+    {
+      double difference = turn_rate - this->turn_rate_;
+      this->turn_rate_variance_ += PROPAGATION_FILTER_WEIGHT
+          * (0.5 * difference * difference - this->turn_rate_variance_);
+    }
+    this->turn_rate_ = turn_rate;
+    this->turn_rate_valid_ = true;
+  }
+  else
+    this->turn_rate_valid_ = false;
+
+  this->heading_valid_ = true;
+  this->heading_stamp_ = stamp;
+  this->heading_ = heading;
+}
+
+bool FixPropagator::propagate(nav_msgs::Odometry& odometry, const ros::Time& time)
+{
+  if (this->model_ == PROPAGATION_OFF)
+    return false;
+
+  double delta_t = (time - odometry.header.stamp).toSec();
+  if (delta_t <= 0.0)
+    return false;
+  if (delta_t > this->max_propagation_)
+  {
+    this->stale_fixes_++;
+    return false;
+  }
+
+  bool turning = this->model_ == PROPAGATION_CONSTANT_TURN_RATE && this->turn_rate_valid_;
+  double turn_rate = turning ? this->turn_rate_ : 0.0;
+  double turn_rate_variance = turning ? this->turn_rate_variance_ : 0.0;
+
+  // the displacement is the chord of the arc, the velocity times
+  // delta_t sin(h) / h rotated by half the heading increment h
+  double half_increment = 0.5 * turn_rate * delta_t;
+  double chord_factor = fabs(half_increment) < 1e-9 ? 1.0 : sin(half_increment) / half_increment;
+  Eigen::Matrix2d half_rotation;
+  half_rotation << cos(half_increment), -sin(half_increment), sin(half_increment), cos(half_increment);
+  Eigen::Matrix2d displacement_jacobian = delta_t * chord_factor * half_rotation;
+  Eigen::Matrix2d velocity_rotation = half_rotation * half_rotation;
+
+  Eigen::Vector2d velocity(odometry.twist.twist.linear.x, odometry.twist.twist.linear.y);
+  Eigen::Matrix2d velocity_covariance;
+  velocity_covariance << odometry.twist.covariance[0], odometry.twist.covariance[1], odometry.twist.covariance[6],
+      odometry.twist.covariance[7];
+  Eigen::Matrix2d position_covariance;
+  position_covariance << odometry.pose.covariance[0], odometry.pose.covariance[1], odometry.pose.covariance[6],
+      odometry.pose.covariance[7];
+
+  // position
+  Eigen::Vector2d displacement = displacement_jacobian * velocity;
+  odometry.pose.pose.position.x += displacement(0);
+  odometry.pose.pose.position.y += displacement(1);
+
+  // first order covariance, the turn rate moves the position across the heading
+  double delta_t2 = delta_t * delta_t;
+  Eigen::Vector2d across(-velocity(1), velocity(0));
+  position_covariance += displacement_jacobian * velocity_covariance * displacement_jacobian.transpose()
+      + 0.25 * delta_t2 * delta_t2 * this->acceleration_variance_ * Eigen::Matrix2d::Identity()
+      + 0.25 * delta_t2 * delta_t2 * turn_rate_variance * across * across.transpose();
+
+  // velocity, rotated by the heading increment
+  velocity = velocity_rotation * velocity;
+  velocity_covariance = velocity_rotation * velocity_covariance * velocity_rotation.transpose()
+      + delta_t2 * this->acceleration_variance_ * Eigen::Matrix2d::Identity()
+      + delta_t2 * turn_rate_variance * across * across.transpose();
+
+  // orientation, rotated about z by the heading increment
+  if (turning)
+  {
+    tf::Quaternion orientation;
+    tf::quaternionMsgToTF(odometry.pose.pose.orientation, orientation);
+    orientation = tf::createQuaternionFromYaw(2.0 * half_increment) * orientation;
+    tf::quaternionTFToMsg(orientation, odometry.pose.pose.orientation);
+    odometry.pose.covariance[35] += delta_t2 * turn_rate_variance;
+  }
+
+  odometry.twist.twist.linear.x = velocity(0);
+  odometry.twist.twist.linear.y = velocity(1);
+  odometry.pose.covariance[0] = position_covariance(0, 0);
+  odometry.pose.covariance[1] = position_covariance(0, 1);
+  odometry.pose.covariance[6] = position_covariance(1, 0);
+  odometry.pose.covariance[7] = position_covariance(1, 1);
+  odometry.twist.covariance[0] = velocity_covariance(0, 0);
+  odometry.twist.covariance[1] = velocity_covariance(0, 1);
+  odometry.twist.covariance[6] = velocity_covariance(1, 0);
+  odometry.twist.covariance[7] = velocity_covariance(1, 1);
+
+  odometry.header.stamp = time;
+  return true;
+}
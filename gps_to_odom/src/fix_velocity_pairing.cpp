@@ -0,0 +1,87 @@
+#include "fix_velocity_pairing.h"
+#include <math.h>
+
+FixVelocityPairing::FixVelocityPairing(void) :
+    fix_buffer_(PAIRING_BUFFER_SIZE), velocity_buffer_(PAIRING_BUFFER_SIZE)
+{
+  this->tolerance_ = 0.025;
+  this->reset();
+}
+
+void FixVelocityPairing::setTolerance(double tolerance)
+{
+  this->tolerance_ = tolerance;
+}
+
+void FixVelocityPairing::reset(void)
+{
+  this->fix_buffer_.clear();
+  this->velocity_buffer_.clear();
+
+  this->paired_epochs_ = 0;
+  this->unpaired_fixes_ = 0;
+  this->unpaired_velocities_ = 0;
+  this->last_offset_ = 0.0;
+}
+
+bool FixVelocityPairing::add(boost::circular_buffer<nav_msgs::Odometry>& buffer, const nav_msgs::Odometry& sample)
+{
+  if (!buffer.empty() && sample.header.stamp <= buffer.back().header.stamp)
+    return false;
+
+  bool full = buffer.full();
+  buffer.push_back(sample);
+  return !full;
+}
+
+void FixVelocityPairing::addFix(const nav_msgs::Odometry& fix)
+{
+  if (!this->add(this->fix_buffer_, fix))
+    this->unpaired_fixes_++;
+}
+
+void FixVelocityPairing::addVelocity(const nav_msgs::Odometry& velocity)
+{
+  if (!this->add(this->velocity_buffer_, velocity))
+    this->unpaired_velocities_++;
+}
+
+bool FixVelocityPairing::nextPair(nav_msgs::Odometry& odometry)
+{
+  while (!this->fix_buffer_.empty() && !this->velocity_buffer_.empty())
+  {
+    const nav_msgs::Odometry& fix = this->fix_buffer_.front();
+    const nav_msgs::Odometry& velocity = this->velocity_buffer_.front();
+    double offset = (fix.header.stamp - velocity.header.stamp).toSec();
+
+    // the oldest sample is older than anything left in the other stream
+    if (offset < -this->tolerance_)
+    {
+      this->fix_buffer_.pop_front();
+      this->unpaired_fixes_++;
+      continue;
+    }
+    if (offset > this->tolerance_)
+    {
+      this->velocity_buffer_.pop_front();
+      this->unpaired_velocities_++;
+      continue;
+    }
+
+    odometry = velocity;
+    odometry.header = fix.header;
+    odometry.pose.pose.position = fix.pose.pose.position;
+    for (int i = 0; i < 3; i++)
+    {
+      for (int j = 0; j < 3; j++)
+        odometry.pose.covariance[6 * i + j] = fix.pose.covariance[6 * i + j];
+    }
+
+    this->last_offset_ = offset;
+    this->paired_epochs_++;
+    this->fix_buffer_.pop_front();
+    this->velocity_buffer_.pop_front();
+    return true;
+  }
+  return false;
+}
@@ -0,0 +1,216 @@
+#include "geodetic_projection.h"
+#include <math.h>
+
+#define UTM_SCALE_FACTOR 0.9996
+#define UTM_FALSE_EASTING 500000.0
+#define UTM_SOUTH_FALSE_NORTHING 10000000.0
+
+/**
+ * \brief Angle in [deg] wrapped to [-180, 180).
+ */
+static inline double wrapDegrees(double angle)
+{
+  angle = fmod(angle + 180.0, 360.0);
+  if (angle < 0.0)
+    angle += 360.0;
+  return angle - 180.0;
+}
+
+UtmProjection::UtmProjection(double semi_major_axis, double flattening)
+{
+  // third flattening and its powers
+  double n = flattening / (2.0 - flattening);
+  double n2 = n * n;
+  double n3 = n2 * n;
+  double n4 = n3 * n;
+  double n5 = n4 * n;
+  double n6 = n5 * n;
+
+  // e atanh(e x) = sum of e^(2k + 2) x^(2k + 1) / (2k + 1)
+  double eccentricity_squared = flattening * (2.0 - flattening);
+  double power = eccentricity_squared;
+  for (int k = 0; k < DELTA_TERMS; k++)
+  {
+    this->delta_coefficients_[k] = power / (2 * k + 1);
+    power *= eccentricity_squared;
+  }
+  this->scaled_radius_ = UTM_SCALE_FACTOR * semi_major_axis / (1.0 + n) * (1.0 + n2 / 4.0 + n4 / 64.0 + n6 / 256.0);
+
+  this->alpha_[0] = 0.0;
+  this->alpha_[1] = n / 2.0 - 2.0 / 3.0 * n2 + 5.0 / 16.0 * n3 + 41.0 / 180.0 * n4 - 127.0 / 288.0 * n5
+      + 7891.0 / 37800.0 * n6;
+  this->alpha_[2] = 13.0 / 48.0 * n2 - 3.0 / 5.0 * n3 + 557.0 / 1440.0 * n4 + 281.0 / 630.0 * n5
+      - 1983433.0 / 1935360.0 * n6;
+  this->alpha_[3] = 61.0 / 240.0 * n3 - 103.0 / 140.0 * n4 + 15061.0 / 26880.0 * n5 + 167603.0 / 181440.0 * n6;
+  this->alpha_[4] = 49561.0 / 161280.0 * n4 - 179.0 / 168.0 * n5 + 6601661.0 / 7257600.0 * n6;
+  this->alpha_[5] = 34729.0 / 80640.0 * n5 - 3418889.0 / 1995840.0 * n6;
+  this->alpha_[6] = 212378941.0 / 319334400.0 * n6;
+
+  this->zone_ = 0;
+  this->north_ = true;
+  this->central_meridian_ = 0.0;
+  this->false_northing_ = 0.0;
+}
+
+int UtmProjection::zoneOf(double latitude, double longitude)
+{
+  longitude = wrapDegrees(longitude);
+
+  // south west Norway
+  if (latitude >= 56.0 && latitude < 64.0 && longitude >= 3.0 && longitude < 12.0)
+    return 32;
+
+  // Svalbard
+  if (latitude >= 72.0 && latitude < 84.0 && longitude >= 0.0 && longitude < 42.0)
+  {
+    if (longitude < 9.0)
+      return 31;
+    if (longitude < 21.0)
+      return 33;
+    if (longitude < 33.0)
+      return 35;
+    return 37;
+  }
+
+  int zone = (int)floor((longitude + 180.0) / 6.0) + 1;
+  return zone > 60 ? 60 : zone;
+}
+
+void UtmProjection::setZone(int zone, bool north)
+{
+  this->zone_ = zone;
+  this->north_ = north;
+  this->central_meridian_ = zone * 6.0 - 183.0;
+  this->false_northing_ = north ? 0.0 : UTM_SOUTH_FALSE_NORTHING;
+}
+
+void UtmProjection::project(double latitude, double longitude, double& easting, double& northing) const
+{
+  double phi = latitude * M_PI / 180.0;
+  double lambda = longitude - this->central_meridian_;
+  if (lambda >= 180.0)
+    lambda -= 360.0;
+  else if (lambda < -180.0)
+    lambda += 360.0;
+  lambda *= M_PI / 180.0;
+
+  // tangent of the conformal latitude, t = sinh(atanh(sin(phi)) - delta) with
+  // delta = e atanh(e sin(phi)), below 0.007, so delta and its hyperbolic
+  // functions are short polynomials
+  double sin_phi = sin(phi);
+  double cos_phi = cos(phi);
+  double sin_phi2 = sin_phi * sin_phi;
+  double delta = 0.0;
+  for (int k = DELTA_TERMS - 1; k >= 0; k--)
+    delta = delta * sin_phi2 + this->delta_coefficients_[k];
+  delta *= sin_phi;
+  double delta2 = delta * delta;
+  double sinh_delta = delta * (1.0 + delta2 / 6.0 * (1.0 + delta2 / 20.0));
+  double cosh_delta = 1.0 + delta2 / 2.0 * (1.0 + delta2 / 12.0 * (1.0 + delta2 / 30.0));
+  double t = (sin_phi * cosh_delta - sinh_delta) / cos_phi;
+
+  // transverse Mercator of the conformal sphere, zeta' = xi' + i eta'
+  double sin_lambda = sin(lambda);
+  double cos_lambda = cos(lambda);
+  double radius_squared = t * t + cos_lambda * cos_lambda;
+  double radius = sqrt(radius_squared);
+  double xi_prime = atan2(t, cos_lambda);
+  double sinh_eta_prime = sin_lambda / radius;
+  double eta_prime = asinh(sinh_eta_prime);
+
+  // sin(2 zeta') and cos(2 zeta') from the double angle formulas, without
+  // more transcendental functions
+  double sin_2xi = 2.0 * t * cos_lambda / radius_squared;
+  double cos_2xi = (cos_lambda * cos_lambda - t * t) / radius_squared;
+  double sinh_2eta = 2.0 * sinh_eta_prime * sqrt(1.0 + sinh_eta_prime * sinh_eta_prime);
+  double cosh_2eta = 1.0 + 2.0 * sinh_eta_prime * sinh_eta_prime;
+
+  // xi + i eta = zeta' + sum of alpha_j sin(2 j zeta'), summed with Clenshaw
+  // in complex arithmetic, c = 2 cos(2 zeta')
+  double c_real = 2.0 * cos_2xi * cosh_2eta;
+  double c_imag = -2.0 * sin_2xi * sinh_2eta;
+  double b1_real = 0.0;
+  double b1_imag = 0.0;
+  double b2_real = 0.0;
+  double b2_imag = 0.0;
+  for (int j = KRUEGER_ORDER; j > 0; j--)
+  {
+    double b0_real = c_real * b1_real - c_imag * b1_imag - b2_real + this->alpha_[j];
+    double b0_imag = c_real * b1_imag + c_imag * b1_real - b2_imag;
+    b2_real = b1_real;
+    b2_imag = b1_imag;
+    b1_real = b0_real;
+    b1_imag = b0_imag;
+  }
+
+  // sum = b1 sin(2 zeta')
+  double s_real = sin_2xi * cosh_2eta;
+  double s_imag = cos_2xi * sinh_2eta;
+  double xi = xi_prime + b1_real * s_real - b1_imag * s_imag;
+  double eta = eta_prime + b1_real * s_imag + b1_imag * s_real;
+
+  easting = UTM_FALSE_EASTING + this->scaled_radius_ * eta;
+  northing = this->false_northing_ + this->scaled_radius_ * xi;
+}
+
+void UtmProjection::project(const double* latitude, const double* longitude, size_t count, double* easting,
+                            double* northing) const
+{
+  for (size_t i = 0; i < count; i++)
+    this->project(latitude[i], longitude[i], easting[i], northing[i]);
+}
+
+LocalEnuProjection::LocalEnuProjection(double semi_major_axis, double flattening)
+{
+  this->semi_major_axis_ = semi_major_axis;
+  this->eccentricity_squared_ = flattening * (2.0 - flattening);
+  this->setOrigin(0.0, 0.0, 0.0);
+}
+
+void LocalEnuProjection::toEarthCentred(double latitude, double longitude, double altitude, double& x, double& y,
+                                        double& z) const
+{
+  double phi = latitude * M_PI / 180.0;
+  double lambda = longitude * M_PI / 180.0;
+  double sin_phi = sin(phi);
+  double cos_phi = cos(phi);
+
+  // prime vertical radius of curvature
+  double radius = this->semi_major_axis_ / sqrt(1.0 - this->eccentricity_squared_ * sin_phi * sin_phi);
+
+  x = (radius + altitude) * cos_phi * cos(lambda);
+  y = (radius + altitude) * cos_phi * sin(lambda);
+  z = (radius * (1.0 - this->eccentricity_squared_) + altitude) * sin_phi;
+}
+
+void LocalEnuProjection::setOrigin(double latitude, double longitude, double altitude)
+{
+  this->toEarthCentred(latitude, longitude, altitude, this->origin_x_, this->origin_y_, this->origin_z_);
+  this->sin_latitude_ = sin(latitude * M_PI / 180.0);
+  this->cos_latitude_ = cos(latitude * M_PI / 180.0);
+  this->sin_longitude_ = sin(longitude * M_PI / 180.0);
+  this->cos_longitude_ = cos(longitude * M_PI / 180.0);
+}
+
+void LocalEnuProjection::project(double latitude, double longitude, double altitude, double& east, double& north,
+                                 double& up) const
+{
+  double x, y, z;
+  this->toEarthCentred(latitude, longitude, altitude, x, y, z);
+  x -= this->origin_x_;
+  y -= this->origin_y_;
+  z -= this->origin_z_;
+
+  // rows of the rotation from the earth centred frame to east, north, up
+  double horizontal = this->cos_longitude_ * x + this->sin_longitude_ * y;
+  east = -this->sin_longitude_ * x + this->cos_longitude_ * y;
+  north = -this->sin_latitude_ * horizontal + this->cos_latitude_ * z;
+  up = this->cos_latitude_ * horizontal + this->sin_latitude_ * z;
+}
+
+void LocalEnuProjection::project(const double* latitude, const double* longitude, const double* altitude,
+                                 size_t count, double* east, double* north, double* up) const
+{
+  for (size_t i = 0; i < count; i++)
+    this->project(latitude[i], longitude[i], altitude[i], east[i], north[i], up[i]);
+}
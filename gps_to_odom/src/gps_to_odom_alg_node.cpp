@@ -2,28 +2,62 @@
 
 GpsToOdomAlgNode::GpsToOdomAlgNode(void) :
     algorithm_base::IriBaseAlgorithm<GpsToOdomAlgorithm>()
+{
+  this->init();
+}
+
+GpsToOdomAlgNode::GpsToOdomAlgNode(const ros::NodeHandle& node_handle, const ros::NodeHandle& private_node_handle) :
+    algorithm_base::IriBaseAlgorithm<GpsToOdomAlgorithm>()
+{
+  // the topics, timers and parameters use the nodelet namespace and the
+  // callback queue of the manager
+  this->public_node_handle_ = node_handle;
+  this->private_node_handle_ = private_node_handle;
+  this->init();
+
+  // the base class server is on the private namespace of the manager, shared
+  // by all the nodelets of the manager
+  this->nodelet_reconfigure_server_.reset(new dynamic_reconfigure::Server<Config>(this->private_node_handle_));
+  this->nodelet_reconfigure_server_->setCallback(boost::bind(&GpsToOdomAlgNode::nodeletConfigUpdate, this, _1, _2));
+}
+
+void GpsToOdomAlgNode::init(void)
 {
   //init class attributes if necessary
+  this->node_loop_running_ = false;
   this->flag_publish_odom_ = false;
-  this->flag_gnss_position_received_ = false;
-  this->flag_gnss_velocity_received_ = false;
+  this->utm_trans_resolved_ = false;
   this->loop_rate_ = 10; //in [Hz]
-  this->public_node_handle_.getParam("/gps_to_odom/frame_id", this->frame_id_);
-  this->public_node_handle_.getParam("/gps_to_odom/min_speed", this->min_speed_);
-  this->public_node_handle_.getParam("/gps_to_odom/max_speed", this->max_speed_);
+  // the private names, or the absolute ones read before the nodelets, so older launch files keep working
+  if (!this->private_node_handle_.getParam("frame_id", this->frame_id_))
+    this->public_node_handle_.getParam("/gps_to_odom/frame_id", this->frame_id_);
+  if (!this->private_node_handle_.getParam("min_speed", this->min_speed_))
+    this->public_node_handle_.getParam("/gps_to_odom/min_speed", this->min_speed_);
+  if (!this->private_node_handle_.getParam("max_speed", this->max_speed_))
+    this->public_node_handle_.getParam("/gps_to_odom/max_speed", this->max_speed_);
+  this->config_ = Config::__getDefault__();
+  this->pairing_.setTolerance(this->config_.pairing_tolerance);
   
-  this->odom_gps_.pose.pose.orientation.x = 0.0;
-	this->odom_gps_.pose.pose.orientation.y = 0.0;
-	this->odom_gps_.pose.pose.orientation.z = 0.0;
-	this->odom_gps_.pose.pose.orientation.w = 1.0;
+  this->velocity_odom_.pose.pose.orientation.x = 0.0;
+	this->velocity_odom_.pose.pose.orientation.y = 0.0;
+	this->velocity_odom_.pose.pose.orientation.z = 0.0;
+	this->velocity_odom_.pose.pose.orientation.w = 1.0;
 
   // [init publishers]
   this->odom_gps_pub_ = this->public_node_handle_.advertise < nav_msgs::Odometry > ("/odometry_gps", 1);
 
   // [init subscribers]
-  this->sim_fix_sub_ = this->public_node_handle_.subscribe("/fix", 1, &GpsToOdomAlgNode::cb_getSimGpsFixMsg, this);
-  this->sim_vel_sub_ = this->public_node_handle_.subscribe("/fix_vel", 1, &GpsToOdomAlgNode::cb_getSimGpsVelMsg, this);
-  this->bot_vel_sub_ = this->public_node_handle_.subscribe("/rover/fix_velocity", 1, &GpsToOdomAlgNode::cb_getBotGpsVelMsg, this);
+  // the queues hold as many epochs as the pairing, so a late spin does not drop them
+  this->sim_fix_sub_ = this->public_node_handle_.subscribe("/fix", PAIRING_BUFFER_SIZE,
+                                                           &GpsToOdomAlgNode::cb_getSimGpsFixMsg, this);
+  this->sim_vel_sub_ = this->public_node_handle_.subscribe("/fix_vel", PAIRING_BUFFER_SIZE,
+                                                           &GpsToOdomAlgNode::cb_getSimGpsVelMsg, this);
+  this->bot_vel_sub_ = this->public_node_handle_.subscribe("/rover/fix_velocity", PAIRING_BUFFER_SIZE,
+                                                           &GpsToOdomAlgNode::cb_getBotGpsVelMsg, this);
+
+  // the callbacks only read the cached utm transform, so they never wait for tf
+  this->utm_transform_timer_ = this->public_node_handle_.createTimer(ros::Duration(1.0),
+                                                                     &GpsToOdomAlgNode::cb_utmTransformTimer, this);
 
   // [init services]
 
@@ -37,6 +71,42 @@ GpsToOdomAlgNode::GpsToOdomAlgNode(void) :
 GpsToOdomAlgNode::~GpsToOdomAlgNode(void)
 {
   // [free dynamic memory]
+  this->stopNodeLoop();
+}
+
+void GpsToOdomAlgNode::startNodeLoop(void)
+{
+  this->addNodeDiagnostics();
+  this->node_loop_running_ = true;
+  pthread_create(&this->node_loop_thread_, NULL, &GpsToOdomAlgNode::nodeLoopThread, this);
+}
+
+void GpsToOdomAlgNode::stopNodeLoop(void)
+{
+  if (!this->node_loop_running_)
+    return;
+  this->node_loop_running_ = false;
+  pthread_join(this->node_loop_thread_, NULL);
+}
+
+void GpsToOdomAlgNode::nodeletConfigUpdate(Config &config, uint32_t level)
+{
+  this->alg_.config_update(config, level);
+  this->node_config_update(config, level);
+}
+
+void *GpsToOdomAlgNode::nodeLoopThread(void *param)
+{
+  GpsToOdomAlgNode *node = (GpsToOdomAlgNode *)param;
+
+  while (node->node_loop_running_ && ros::ok())
+  {
+    node->mainNodeThread();
+    node->diagnostic_.update();
+    node->loop_rate_.sleep();
+  }
+
+  pthread_exit(NULL);
 }
 
 void GpsToOdomAlgNode::mainNodeThread(void)
@@ -49,57 +119,110 @@ void GpsToOdomAlgNode::mainNodeThread(void)
   // [fill action structure and make request to the action server]
 
   // [publish messages]
-  if (this->flag_gnss_position_received_ && this->flag_gnss_velocity_received_)
+  // the odometry is published by the callbacks as soon as a fix and a velocity are paired
+}
+
+void GpsToOdomAlgNode::publishPairs(void)
+{
+  while (this->pairing_.nextPair(this->odom_gps_))
+  {
+    // latency compensation, the pair is moved from its epoch to the publish time
+    this->propagator_.propagate(this->odom_gps_, ros::Time::now());
+    this->odom_gps_pub_.publish(boost::make_shared<nav_msgs::Odometry>(this->odom_gps_));
+  }
+}
+
+void GpsToOdomAlgNode::cb_utmTransformTimer(const ros::TimerEvent& event)
+{
+  // the local ENU projection does not use the utm frame
+  this->alg_.lock();
+  bool local_enu = this->config_.projection == PROJECTION_LOCAL_ENU;
+  this->alg_.unlock();
+  if (local_enu)
+    return;
+
+  if (!this->listener_.canTransform(this->frame_id_, "utm", ros::Time(0)))
+  {
+    ROS_WARN_THROTTLE(10.0, "Waiting for the transform from utm to %s", this->frame_id_.c_str());
+    return;
+  }
+
+  tf::StampedTransform utm_trans;
+  try
+  {
+    this->listener_.lookupTransform(this->frame_id_, "utm", ros::Time(0), utm_trans);
+  }
+  catch (tf::TransformException ex)
   {
-    this->odom_gps_pub_.publish(this->odom_gps_);
-    this->flag_gnss_position_received_ = false;
-    this->flag_gnss_velocity_received_ = false;
+    ROS_ERROR("%s", ex.what());
+    return;
   }
+
+  this->alg_.lock();
+  if (!this->utm_trans_resolved_ || utm_trans.stamp_ != this->utm_trans_.stamp_)
+  {
+    Eigen::Affine3d utm_to_map;
+    tf::transformTFToEigen(utm_trans, utm_to_map);
+    this->utm_trans_ = utm_trans;
+    this->utm_rotation_ = utm_to_map.linear();
+    this->utm_rotation_transpose_ = this->utm_rotation_.transpose();
+    this->utm_trans_resolved_ = true;
+  }
+  this->alg_.unlock();
 }
 
 /*  [subscriber callbacks] */
 void GpsToOdomAlgNode::cb_getSimGpsFixMsg(const sensor_msgs::NavSatFix::ConstPtr& fix_msg)
 {
   this->alg_.lock();
-  
-  Ellipsoid utm;
-  double utm_x;
-  double utm_y;
-  char utm_zone[30];
-  int ref_ellipsoid = 23;
-  
-  utm.LLtoUTM(ref_ellipsoid, fix_msg->latitude, fix_msg->longitude, utm_y, utm_x, utm_zone);
-  
-  ///////////////////////////////////////////////////////////
-  ///// TRANSFORM TO TF FARME
+
+  this->propagator_.addDelay(fix_msg->header.stamp, ros::Time::now());
+
   geometry_msgs::PointStamped fix_tf;
-  geometry_msgs::PointStamped fix_utm;
-  fix_utm.header.frame_id = "utm";
-  fix_utm.header.stamp = ros::Time(0); //ros::Time::now();
-  fix_utm.point.x = utm_x;
-  fix_utm.point.y = utm_y;
-  fix_utm.point.z = 0.0;
-  try
+  if (this->config_.projection == PROJECTION_LOCAL_ENU)
   {
-    this->listener_.transformPoint(this->frame_id_, fix_utm, fix_tf);
+    // the local coordinates are already in the map frame
+    double up;
+    this->enu_projection_.project(fix_msg->latitude, fix_msg->longitude, fix_msg->altitude, fix_tf.point.x,
+                                  fix_tf.point.y, up);
   }
-  catch (tf::TransformException& ex)
+  else
   {
-    ROS_WARN("[draw_frames] TF exception:\n%s", ex.what());
-    return;
+    // the zone is kept for the whole run, so the fixes stay continuous across zone borders
+    if (this->utm_projection_.zone() == 0)
+    {
+      int zone = this->config_.utm_zone > 0 ?
+          this->config_.utm_zone : UtmProjection::zoneOf(fix_msg->latitude, fix_msg->longitude);
+      this->utm_projection_.setZone(zone, fix_msg->latitude >= 0.0);
+    }
+    double utm_x;
+    double utm_y;
+    this->utm_projection_.project(fix_msg->latitude, fix_msg->longitude, utm_x, utm_y);
+
+    ///////////////////////////////////////////////////////////
+    ///// TRANSFORM TO TF FARME
+    if (!this->utm_trans_resolved_)
+    {
+      ROS_WARN_THROTTLE(10.0, "Waiting for the transform from utm to %s", this->frame_id_.c_str());
+      this->alg_.unlock();
+      return;
+    }
+    tf::pointTFToMsg(this->utm_trans_ * tf::Vector3(utm_x, utm_y, 0.0), fix_tf.point);
+    ///////////////////////////////////////////////////////////
   }
-  ///////////////////////////////////////////////////////////
-  
-  this->odom_gps_.header = fix_msg->header;
-  this->odom_gps_.header.frame_id = this->frame_id_;
-  this->odom_gps_.pose.pose.position.x = fix_tf.point.x;
-  this->odom_gps_.pose.pose.position.y = fix_tf.point.y;
-  this->odom_gps_.pose.pose.position.z = 0.0;
-  this->odom_gps_.pose.covariance[0] = fix_msg->position_covariance[0];
-  this->odom_gps_.pose.covariance[7] = fix_msg->position_covariance[4];
-  this->odom_gps_.pose.covariance[14] = fix_msg->position_covariance[8];
   
-  this->flag_gnss_position_received_ = true;
+  nav_msgs::Odometry fix;
+  fix.header = fix_msg->header;
+  fix.header.frame_id = this->frame_id_;
+  fix.pose.pose.position.x = fix_tf.point.x;
+  fix.pose.pose.position.y = fix_tf.point.y;
+  fix.pose.pose.position.z = 0.0;
+  fix.pose.covariance[0] = fix_msg->position_covariance[0];
+  fix.pose.covariance[7] = fix_msg->position_covariance[4];
+  fix.pose.covariance[14] = fix_msg->position_covariance[8];
+
+  this->pairing_.addFix(fix);
+  this->publishPairs();
 
   this->alg_.unlock();
 }
@@ -114,13 +237,19 @@ void GpsToOdomAlgNode::cb_getSimGpsVelMsg(const geometry_msgs::Vector3Stamped::C
   tf::Quaternion quat_world = tf::createQuaternionFromRPY(0, 0, yaw);
   
   double speed = sqrt(pow(vel_msg->vector.y, 2) + pow(vel_msg->vector.x, 2));
+
+  // the velocity propagates the fix in the latency compensation
+  this->velocity_odom_.twist.twist.linear.x = vel_msg->vector.x;
+  this->velocity_odom_.twist.twist.linear.y = vel_msg->vector.y;
+  this->velocity_odom_.twist.twist.linear.z = vel_msg->vector.z;
+  this->propagator_.addVelocity(vel_msg->header.stamp, vel_msg->vector.x, vel_msg->vector.y, this->min_speed_);
   
   if (speed > this->min_speed_)
   {
-		this->odom_gps_.pose.pose.orientation.x = quat_world[0];
-		this->odom_gps_.pose.pose.orientation.y = quat_world[1];
-		this->odom_gps_.pose.pose.orientation.z = quat_world[2];
-		this->odom_gps_.pose.pose.orientation.w = quat_world[3];
+		this->velocity_odom_.pose.pose.orientation.x = quat_world[0];
+		this->velocity_odom_.pose.pose.orientation.y = quat_world[1];
+		this->velocity_odom_.pose.pose.orientation.z = quat_world[2];
+		this->velocity_odom_.pose.pose.orientation.w = quat_world[3];
 		 
 		
 		double min_variance_yaw = (2 * 3.1416) / 180.0; 
@@ -133,11 +262,13 @@ void GpsToOdomAlgNode::cb_getSimGpsVelMsg(const geometry_msgs::Vector3Stamped::C
 		  variance_yaw = min_variance_yaw;
 		}
 		
-		this->odom_gps_.pose.covariance[35] = variance_yaw;
+		this->velocity_odom_.pose.covariance[35] = variance_yaw;
   
   }
   
-  this->flag_gnss_velocity_received_ = true;
+  this->velocity_odom_.header.stamp = vel_msg->header.stamp;
+  this->pairing_.addVelocity(this->velocity_odom_);
+  this->publishPairs();
 
   this->alg_.unlock();
 }
@@ -153,29 +284,31 @@ void GpsToOdomAlgNode::cb_getBotGpsVelMsg(const geometry_msgs::TwistWithCovarian
   UTM_velocities(1) = vel_msg->twist.twist.linear.y;
   UTM_velocities(2) = vel_msg->twist.twist.linear.z;
 
-  // Get transform from UTM to MAP
-  try
-  {
-    this->listener_.lookupTransform(this->frame_id_, "utm", ros::Time(0), this->utm_trans_);
-  }
-  catch (tf::TransformException ex)
+  // Rotation from UTM to MAP, cached by cb_utmTransformTimer. In the local ENU
+  // projection the map is the ENU frame, where the velocities are expressed
+  Eigen::Matrix3d velocity_rotation = Eigen::Matrix3d::Identity();
+  Eigen::Matrix3d velocity_rotation_transpose = Eigen::Matrix3d::Identity();
+  if (this->config_.projection != PROJECTION_LOCAL_ENU)
   {
-    ROS_ERROR("%s", ex.what());
-    ros::Duration(1.0).sleep();
+    if (!this->utm_trans_resolved_)
+    {
+      ROS_WARN_THROTTLE(10.0, "Waiting for the transform from utm to %s", this->frame_id_.c_str());
+      this->alg_.unlock();
+      return;
+    }
+    velocity_rotation = this->utm_rotation_;
+    velocity_rotation_transpose = this->utm_rotation_transpose_;
   }
 
-  // Convert it to Eigen
-  Eigen::Affine3d UTM_to_map_rotation;
-  tf::transformTFToEigen(this->utm_trans_, UTM_to_map_rotation);
-
   // Convert the velocities to "map" frame
   Eigen::Vector3d map_velocities = Eigen::Vector3d::Zero();
-  map_velocities = UTM_to_map_rotation.linear() * UTM_velocities;
+  map_velocities = velocity_rotation * UTM_velocities;
 
   // And pass it to the output message
-  this->odom_gps_.twist.twist.linear.x = map_velocities(0);
-  this->odom_gps_.twist.twist.linear.y = map_velocities(1);
-  this->odom_gps_.twist.twist.linear.z = map_velocities(2);
+  this->velocity_odom_.twist.twist.linear.x = map_velocities(0);
+  this->velocity_odom_.twist.twist.linear.y = map_velocities(1);
+  this->velocity_odom_.twist.twist.linear.z = map_velocities(2);
+  this->propagator_.addVelocity(vel_msg->header.stamp, map_velocities(0), map_velocities(1), this->min_speed_);
 
   //////// Extract orientations in "map" frame /////////////////////////////////////////////
   Eigen::Vector3d map_orientations_RPY = Eigen::Vector3d::Zero();
@@ -199,15 +332,14 @@ void GpsToOdomAlgNode::cb_getBotGpsVelMsg(const geometry_msgs::TwistWithCovarian
 		                                                        map_orientations_RPY(1),
 		                                                        map_orientations_RPY(2));
 
-		std::cout << "Roll = "  << map_orientations_RPY(0) * 180.0 / M_PI <<
-		         "    Pitch = " << map_orientations_RPY(1) * 180.0 / M_PI <<
-		         "    Yaw = "   << map_orientations_RPY(2) * 180.0 / M_PI << std::endl;
+		ASYNC_LOG_DEBUG_THROTTLE(1.0, "Roll = %f    Pitch = %f    Yaw = %f", map_orientations_RPY(0) * 180.0 / M_PI,
+		                         map_orientations_RPY(1) * 180.0 / M_PI, map_orientations_RPY(2) * 180.0 / M_PI);
 
 		// Pass it to the output message
-		this->odom_gps_.pose.pose.orientation.x = quaternion[0];
-		this->odom_gps_.pose.pose.orientation.y = quaternion[1];
-		this->odom_gps_.pose.pose.orientation.z = quaternion[2];
-		this->odom_gps_.pose.pose.orientation.w = quaternion[3];
+		this->velocity_odom_.pose.pose.orientation.x = quaternion[0];
+		this->velocity_odom_.pose.pose.orientation.y = quaternion[1];
+		this->velocity_odom_.pose.pose.orientation.z = quaternion[2];
+		this->velocity_odom_.pose.pose.orientation.w = quaternion[3];
 
 		// Now we need to compute the covariance matrix of those orientations,
 		// as we have an explicit non-linear relation, we use the a first order approximation
@@ -230,7 +362,7 @@ void GpsToOdomAlgNode::cb_getBotGpsVelMsg(const geometry_msgs::TwistWithCovarian
 		UTM_vel_covariance(2,2) = vel_msg->twist.covariance[14];
 
 		Eigen::Matrix3d map_vel_cov = Eigen::Matrix3d::Zero();
-		map_vel_cov = UTM_to_map_rotation.linear() * UTM_vel_covariance * UTM_to_map_rotation.linear().transpose();
+		map_vel_cov = velocity_rotation * UTM_vel_covariance * velocity_rotation_transpose;
 		// Explanation of the covariance rotation:
 		// C = E(X*X^T)            --> Covariance definition
 		// X'= R*X                 --> X' is X rotated using matrix R
@@ -239,17 +371,17 @@ void GpsToOdomAlgNode::cb_getBotGpsVelMsg(const geometry_msgs::TwistWithCovarian
 		// C'= R * E(X*X^T) * R^T  --> formula used above
 
 		// And we can now pass this linear velocity covariance matrix to the output message
-		this->odom_gps_.twist.covariance[0]  = map_vel_cov(0,0);
-		this->odom_gps_.twist.covariance[1]  = map_vel_cov(0,1);
-		this->odom_gps_.twist.covariance[2]  = map_vel_cov(0,2);
+		this->velocity_odom_.twist.covariance[0]  = map_vel_cov(0,0);
+		this->velocity_odom_.twist.covariance[1]  = map_vel_cov(0,1);
+		this->velocity_odom_.twist.covariance[2]  = map_vel_cov(0,2);
 
-		this->odom_gps_.twist.covariance[6]  = map_vel_cov(1,0);
-		this->odom_gps_.twist.covariance[7]  = map_vel_cov(1,1);
-		this->odom_gps_.twist.covariance[8]  = map_vel_cov(1,2);
+		this->velocity_odom_.twist.covariance[6]  = map_vel_cov(1,0);
+		this->velocity_odom_.twist.covariance[7]  = map_vel_cov(1,1);
+		this->velocity_odom_.twist.covariance[8]  = map_vel_cov(1,2);
 
-		this->odom_gps_.twist.covariance[12] = map_vel_cov(2,0);
-		this->odom_gps_.twist.covariance[13] = map_vel_cov(2,1);
-		this->odom_gps_.twist.covariance[14] = map_vel_cov(2,2);
+		this->velocity_odom_.twist.covariance[12] = map_vel_cov(2,0);
+		this->velocity_odom_.twist.covariance[13] = map_vel_cov(2,1);
+		this->velocity_odom_.twist.covariance[14] = map_vel_cov(2,2);
 		
 		// now we calcule variance of yaw (DEPENDING ON VELOCITY MAGNITUDE!!!)
 		double speed = sqrt(vx*vx + vy*vy);
@@ -288,21 +420,23 @@ void GpsToOdomAlgNode::cb_getBotGpsVelMsg(const geometry_msgs::TwistWithCovarian
 		map_orientation_RPY_cov = map_orientation_RPY_jacobian * map_vel_cov * map_orientation_RPY_jacobian.transpose();
 
 		// Passing to ROS message
-		this->odom_gps_.pose.covariance[21] = map_orientation_RPY_cov(0,0);
-		this->odom_gps_.pose.covariance[22] = map_orientation_RPY_cov(0,1);
-		this->odom_gps_.pose.covariance[23] = map_orientation_RPY_cov(0,2);
+		this->velocity_odom_.pose.covariance[21] = map_orientation_RPY_cov(0,0);
+		this->velocity_odom_.pose.covariance[22] = map_orientation_RPY_cov(0,1);
+		this->velocity_odom_.pose.covariance[23] = map_orientation_RPY_cov(0,2);
 
-		this->odom_gps_.pose.covariance[27] = map_orientation_RPY_cov(1,0);
-		this->odom_gps_.pose.covariance[28] = map_orientation_RPY_cov(1,1);
-		this->odom_gps_.pose.covariance[29] = map_orientation_RPY_cov(1,2);
+		this->velocity_odom_.pose.covariance[27] = map_orientation_RPY_cov(1,0);
+		this->velocity_odom_.pose.covariance[28] = map_orientation_RPY_cov(1,1);
+		this->velocity_odom_.pose.covariance[29] = map_orientation_RPY_cov(1,2);
 
-		this->odom_gps_.pose.covariance[33] = map_orientation_RPY_cov(2,0);
-		this->odom_gps_.pose.covariance[34] = map_orientation_RPY_cov(2,1);
-		this->odom_gps_.pose.covariance[35] = map_orientation_RPY_cov(2,2) + variance_yaw;
+		this->velocity_odom_.pose.covariance[33] = map_orientation_RPY_cov(2,0);
+		this->velocity_odom_.pose.covariance[34] = map_orientation_RPY_cov(2,1);
+		this->velocity_odom_.pose.covariance[35] = map_orientation_RPY_cov(2,2) + variance_yaw;
   
   }
 
-  this->flag_gnss_velocity_received_ = true;
+  this->velocity_odom_.header.stamp = vel_msg->header.stamp;
+  this->pairing_.addVelocity(this->velocity_odom_);
+  this->publishPairs();
   this->alg_.unlock();
 }
 
@@ -315,16 +449,59 @@ void GpsToOdomAlgNode::cb_getBotGpsVelMsg(const geometry_msgs::TwistWithCovarian
 void GpsToOdomAlgNode::node_config_update(Config &config, uint32_t level)
 {
   this->alg_.lock();
+  // a new zone is selected with the next fix
+  if (config.utm_zone != this->config_.utm_zone)
+    this->utm_projection_.setZone(0, true);
+  this->enu_projection_.setOrigin(config.enu_origin_latitude, config.enu_origin_longitude,
+                                  config.enu_origin_altitude);
+  this->pairing_.setTolerance(config.pairing_tolerance);
+  this->propagator_.setModel((PropagationModel)config.latency_compensation, config.acceleration_variance,
+                             config.max_propagation);
   this->config_ = config;
   this->alg_.unlock();
 }
 
 void GpsToOdomAlgNode::addNodeDiagnostics(void)
 {
+  this->diagnostic_.add("Gnss fix and velocity pairing", this, &GpsToOdomAlgNode::pairingDiagnostic);
+  this->diagnostic_.add("Gnss fix latency", this, &GpsToOdomAlgNode::latencyDiagnostic);
+}
+
+void GpsToOdomAlgNode::pairingDiagnostic(diagnostic_updater::DiagnosticStatusWrapper &stat)
+{
+  this->alg_.lock();
+  stat.summary(diagnostic_msgs::DiagnosticStatus::OK, "Pairing fixes and velocities by header stamp");
+  stat.add("Paired epochs", this->pairing_.paired_epochs_);
+  stat.add("Unpaired fixes", this->pairing_.unpaired_fixes_);
+  stat.add("Unpaired velocities", this->pairing_.unpaired_velocities_);
+  stat.add("Last pair offset [s]", this->pairing_.last_offset_);
+  if (this->pairing_.unpaired_fixes_ + this->pairing_.unpaired_velocities_ > this->pairing_.paired_epochs_)
+    stat.mergeSummary(diagnostic_msgs::DiagnosticStatus::WARN, "Most samples are not paired, check pairing_tolerance");
+  this->alg_.unlock();
+}
+
+void GpsToOdomAlgNode::latencyDiagnostic(diagnostic_updater::DiagnosticStatusWrapper &stat)
+{
+  this->alg_.lock();
+  if (this->config_.latency_compensation == PROPAGATION_OFF)
+    stat.summary(diagnostic_msgs::DiagnosticStatus::OK, "Publishing the fixes at their epoch");
+  else
+    stat.summary(diagnostic_msgs::DiagnosticStatus::OK, "Propagating the fixes to the publish time");
+  stat.add("Measured fixes", this->propagator_.delay_samples_);
+  stat.add("Last delay [s]", this->propagator_.last_delay_);
+  stat.add("Mean delay [s]", this->propagator_.mean_delay_);
+  stat.add("Max delay [s]", this->propagator_.max_delay_);
+  stat.add("Stale fixes", this->propagator_.stale_fixes_);
+  if (this->config_.latency_compensation != PROPAGATION_OFF
+      && this->propagator_.mean_delay_ > this->config_.max_propagation)
+    stat.mergeSummary(diagnostic_msgs::DiagnosticStatus::WARN, "Fixes older than max_propagation are not propagated");
+  this->alg_.unlock();
 }
 
-/* main function */
+/* main function, not built in the nodelet library */
+#ifndef BUILD_NODELET
 int main(int argc, char *argv[])
 {
   return algorithm_base::main < GpsToOdomAlgNode > (argc, argv, "gps_to_odom_alg_node");
 }
+#endif
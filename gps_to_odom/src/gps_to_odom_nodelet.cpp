@@ -0,0 +1,33 @@
+#include "gps_to_odom_alg_node.h"
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
+
+namespace gps_to_odom
+{
+
+/**
+ * \brief Nodelet version of GpsToOdomAlgNode
+ *
+ * Runs the gps odometry node inside a nodelet manager, so the messages exchanged
+ * with other nodelets of the same manager are passed as shared pointers
+ * without serialization. The node is built on the nodelet handles, so its
+ * parameters and dynamic reconfigure server are in the nodelet namespace and
+ * its callbacks are served by the callback queue of the nodelet in the
+ * manager. The node loop runs in its own thread.
+ */
+class GpsToOdomNodelet : public nodelet::Nodelet
+{
+private:
+
+  boost::shared_ptr<GpsToOdomAlgNode> node_;
+
+  virtual void onInit(void)
+  {
+    this->node_.reset(new GpsToOdomAlgNode(this->getNodeHandle(), this->getPrivateNodeHandle()));
+    this->node_->startNodeLoop();
+  }
+};
+
+}
+
+PLUGINLIB_EXPORT_CLASS(gps_to_odom::GpsToOdomNodelet, nodelet::Nodelet)
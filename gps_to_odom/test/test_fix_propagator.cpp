@@ -0,0 +1,187 @@
+#include "fix_propagator.h"
+#include <tf/tf.h>
+#include <gtest/gtest.h>
+#include <math.h>
+
+namespace
+{
+
+const double CIRCLE_RADIUS = 20.0;
+const double CIRCLE_SPEED = 5.0;
+const double VELOCITY_PERIOD = 0.05;
+
+/**
+ * \brief Odometry of a paired fix, level, with diagonal covariances.
+ */
+nav_msgs::Odometry pairAt(double stamp, double x, double y, double velocity_x, double velocity_y)
+{
+  nav_msgs::Odometry odometry;
+  odometry.header.stamp = ros::Time(stamp);
+  odometry.pose.pose.position.x = x;
+  odometry.pose.pose.position.y = y;
+  odometry.pose.pose.orientation = tf::createQuaternionMsgFromYaw(atan2(velocity_y, velocity_x));
+  odometry.pose.covariance[0] = 0.04;
+  odometry.pose.covariance[7] = 0.09;
+  odometry.pose.covariance[35] = 0.01;
+  odometry.twist.twist.linear.x = velocity_x;
+  odometry.twist.twist.linear.y = velocity_y;
+  odometry.twist.covariance[0] = 0.01;
+  odometry.twist.covariance[7] = 0.02;
+  return odometry;
+}
+
+/**
+ * \brief Pair on a counterclockwise circle about the origin.
+ */
+nav_msgs::Odometry circleAt(double stamp)
+{
+  double angle = CIRCLE_SPEED / CIRCLE_RADIUS * (stamp - 100.0);
+  return pairAt(stamp, CIRCLE_RADIUS * cos(angle), CIRCLE_RADIUS * sin(angle), -CIRCLE_SPEED * sin(angle),
+                CIRCLE_SPEED * cos(angle));
+}
+
+/**
+ * \brief Feeds the velocities of the circle up to the given time.
+ */
+void driveCircle(FixPropagator& propagator, double until)
+{
+  for (double stamp = 100.0; stamp <= until + 1e-9; stamp += VELOCITY_PERIOD)
+  {
+    nav_msgs::Odometry odometry = circleAt(stamp);
+    propagator.addVelocity(ros::Time(stamp), odometry.twist.twist.linear.x, odometry.twist.twist.linear.y, 0.5);
+  }
+}
+
+}
+
+// off, not delayed and stale fixes are not changed
+TEST(FixPropagator, LeavesFixesOutOfTheWindow)
+{
+  FixPropagator propagator;
+  nav_msgs::Odometry odometry = pairAt(100.0, 1.0, 2.0, 3.0, 4.0);
+  EXPECT_FALSE(propagator.propagate(odometry, ros::Time(100.1)));
+
+  propagator.setModel(PROPAGATION_CONSTANT_VELOCITY, 1.0, 0.5);
+  EXPECT_FALSE(propagator.propagate(odometry, ros::Time(100.0)));
+  EXPECT_FALSE(propagator.propagate(odometry, ros::Time(99.9)));
+  EXPECT_EQ(0u, propagator.stale_fixes_);
+  EXPECT_FALSE(propagator.propagate(odometry, ros::Time(100.6)));
+  EXPECT_EQ(1u, propagator.stale_fixes_);
+
+  EXPECT_EQ(ros::Time(100.0), odometry.header.stamp);
+  EXPECT_EQ(1.0, odometry.pose.pose.position.x);
+  EXPECT_EQ(0.04, odometry.pose.covariance[0]);
+}
+
+// straight ahead at the fix velocity, with the first order covariance
+TEST(FixPropagator, ConstantVelocity)
+{
+  FixPropagator propagator;
+  propagator.setModel(PROPAGATION_CONSTANT_VELOCITY, 2.0, 0.5);
+  nav_msgs::Odometry odometry = pairAt(100.0, 1.0, 2.0, 3.0, 4.0);
+  ASSERT_TRUE(propagator.propagate(odometry, ros::Time(100.2)));
+
+  double delta_t = 0.2;
+  EXPECT_EQ(ros::Time(100.2), odometry.header.stamp);
+  EXPECT_NEAR(1.6, odometry.pose.pose.position.x, 1e-9);
+  EXPECT_NEAR(2.8, odometry.pose.pose.position.y, 1e-9);
+  EXPECT_NEAR(3.0, odometry.twist.twist.linear.x, 1e-9);
+  EXPECT_NEAR(4.0, odometry.twist.twist.linear.y, 1e-9);
+
+  double acceleration = 0.25 * pow(delta_t, 4) * 2.0;
+  EXPECT_NEAR(0.04 + delta_t * delta_t * 0.01 + acceleration, odometry.pose.covariance[0], 1e-9);
+  EXPECT_NEAR(0.09 + delta_t * delta_t * 0.02 + acceleration, odometry.pose.covariance[7], 1e-9);
+  EXPECT_NEAR(0.0, odometry.pose.covariance[1], 1e-12);
+  EXPECT_NEAR(0.01 + delta_t * delta_t * 2.0, odometry.twist.covariance[0], 1e-9);
+  EXPECT_NEAR(0.02 + delta_t * delta_t * 2.0, odometry.twist.covariance[7], 1e-9);
+  EXPECT_EQ(0.01, odometry.pose.covariance[35]);
+}
+
+// on a circle the fix is moved along the arc, and the velocity and the heading turn with it
+TEST(FixPropagator, ConstantTurnRate)
+{
+  FixPropagator propagator;
+  propagator.setModel(PROPAGATION_CONSTANT_TURN_RATE, 1.0, 0.5);
+  driveCircle(propagator, 102.0);
+
+  nav_msgs::Odometry odometry = circleAt(102.0);
+  ASSERT_TRUE(propagator.propagate(odometry, ros::Time(102.4)));
+  nav_msgs::Odometry expected = circleAt(102.4);
+  EXPECT_NEAR(expected.pose.pose.position.x, odometry.pose.pose.position.x, 1e-6);
+  EXPECT_NEAR(expected.pose.pose.position.y, odometry.pose.pose.position.y, 1e-6);
+  EXPECT_NEAR(expected.twist.twist.linear.x, odometry.twist.twist.linear.x, 1e-6);
+  EXPECT_NEAR(expected.twist.twist.linear.y, odometry.twist.twist.linear.y, 1e-6);
+  double yaw_error = tf::getYaw(odometry.pose.pose.orientation) - tf::getYaw(expected.pose.pose.orientation);
+  EXPECT_NEAR(0.0, atan2(sin(yaw_error), cos(yaw_error)), 1e-6);
+
+  // a constant turn rate has no turn rate noise
+  EXPECT_NEAR(0.01, odometry.pose.covariance[35], 1e-9);
+
+  // at constant velocity the same fix is off the circle by the sagitta
+  FixPropagator straight;
+  straight.setModel(PROPAGATION_CONSTANT_VELOCITY, 1.0, 0.5);
+  odometry = circleAt(102.0);
+  ASSERT_TRUE(straight.propagate(odometry, ros::Time(102.4)));
+  EXPECT_GT(hypot(odometry.pose.pose.position.x, odometry.pose.pose.position.y) - CIRCLE_RADIUS, 0.05);
+}
+
+// a changing turn rate inflates the covariance across the heading and of the yaw
+TEST(FixPropagator, TurnRateNoise)
+{
+  FixPropagator propagator;
+  propagator.setModel(PROPAGATION_CONSTANT_TURN_RATE, 0.0, 0.5);
+  double heading = 0.0;
+  for (int k = 0; k <= 40; k++)
+  {
+    heading += (k % 2 ? 0.3 : -0.1) * VELOCITY_PERIOD;
+    propagator.addVelocity(ros::Time(100.0 + k * VELOCITY_PERIOD), 5.0 * cos(heading), 5.0 * sin(heading), 0.5);
+  }
+
+  // heading along x, so across is y
+  nav_msgs::Odometry odometry = pairAt(102.0, 0.0, 0.0, 5.0, 0.0);
+  odometry.twist.covariance[0] = 0.0;
+  odometry.twist.covariance[7] = 0.0;
+  ASSERT_TRUE(propagator.propagate(odometry, ros::Time(102.2)));
+  EXPECT_GT(odometry.pose.covariance[35], 0.01);
+  EXPECT_GT(odometry.pose.covariance[7], 0.09);
+  EXPECT_NEAR(0.04, odometry.pose.covariance[0], 1e-6);
+}
+
+// under the minimum speed the heading is not observable and the fix goes straight
+TEST(FixPropagator, SlowSpeedForgetsTurnRate)
+{
+  FixPropagator propagator;
+  propagator.setModel(PROPAGATION_CONSTANT_TURN_RATE, 1.0, 0.5);
+  driveCircle(propagator, 102.0);
+  propagator.addVelocity(ros::Time(102.05), 0.1, 0.0, 0.5);
+
+  nav_msgs::Odometry odometry = pairAt(102.05, 0.0, 0.0, 5.0, 0.0);
+  ASSERT_TRUE(propagator.propagate(odometry, ros::Time(102.25)));
+  EXPECT_NEAR(1.0, odometry.pose.pose.position.x, 1e-9);
+  EXPECT_NEAR(0.0, odometry.pose.pose.position.y, 1e-9);
+}
+
+// last, running mean and maximum of the delay, forgotten by reset
+TEST(FixPropagator, MeasuresDelay)
+{
+  FixPropagator propagator;
+  propagator.addDelay(ros::Time(100.0), ros::Time(100.1));
+  EXPECT_NEAR(0.1, propagator.mean_delay_, 1e-9);
+  propagator.addDelay(ros::Time(100.1), ros::Time(100.4));
+  propagator.addDelay(ros::Time(100.2), ros::Time(100.3));
+
+  EXPECT_EQ(3u, propagator.delay_samples_);
+  EXPECT_NEAR(0.1, propagator.last_delay_, 1e-9);
+  EXPECT_NEAR(0.3, propagator.max_delay_, 1e-9);
+  EXPECT_NEAR(0.1 + 0.1 * 0.2 + 0.1 * (0.1 - 0.12), propagator.mean_delay_, 1e-9);
+
+  propagator.reset();
+  EXPECT_EQ(0u, propagator.delay_samples_);
+  EXPECT_EQ(0.0, propagator.max_delay_);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,122 @@
+#include "fix_velocity_pairing.h"
+#include <gtest/gtest.h>
+
+namespace
+{
+
+nav_msgs::Odometry fixAt(double stamp, double x)
+{
+  nav_msgs::Odometry fix;
+  fix.header.stamp = ros::Time(stamp);
+  fix.header.frame_id = "utm";
+  fix.pose.pose.position.x = x;
+  fix.pose.covariance[0] = 0.04;
+  fix.pose.covariance[14] = 0.09;
+  return fix;
+}
+
+nav_msgs::Odometry velocityAt(double stamp, double speed)
+{
+  nav_msgs::Odometry velocity;
+  velocity.header.stamp = ros::Time(stamp);
+  velocity.header.frame_id = "velocity";
+  velocity.pose.pose.orientation.w = 1.0;
+  velocity.twist.twist.linear.x = speed;
+  velocity.twist.covariance[0] = 0.01;
+  return velocity;
+}
+
+}
+
+// the pair has the header and the position of the fix, and the rest of the velocity
+TEST(FixVelocityPairing, PairsSameEpoch)
+{
+  FixVelocityPairing pairing;
+  nav_msgs::Odometry odometry;
+
+  pairing.addFix(fixAt(100.0, 5.0));
+  EXPECT_FALSE(pairing.nextPair(odometry));
+  pairing.addVelocity(velocityAt(100.01, 2.0));
+  ASSERT_TRUE(pairing.nextPair(odometry));
+
+  EXPECT_EQ(ros::Time(100.0), odometry.header.stamp);
+  EXPECT_EQ("utm", odometry.header.frame_id);
+  EXPECT_EQ(5.0, odometry.pose.pose.position.x);
+  EXPECT_EQ(0.04, odometry.pose.covariance[0]);
+  EXPECT_EQ(0.09, odometry.pose.covariance[14]);
+  EXPECT_EQ(1.0, odometry.pose.pose.orientation.w);
+  EXPECT_EQ(2.0, odometry.twist.twist.linear.x);
+  EXPECT_EQ(0.01, odometry.twist.covariance[0]);
+  EXPECT_NEAR(-0.01, pairing.last_offset_, 1e-6);
+  EXPECT_EQ(1u, pairing.paired_epochs_);
+  EXPECT_FALSE(pairing.nextPair(odometry));
+}
+
+// the streams arrive with different delays, the pairs come out in epoch order
+TEST(FixVelocityPairing, PairsInterleavedStreams)
+{
+  FixVelocityPairing pairing;
+  nav_msgs::Odometry odometry;
+
+  for (int epoch = 0; epoch < 5; epoch++)
+    pairing.addVelocity(velocityAt(100.0 + 0.1 * epoch, epoch));
+  for (int epoch = 0; epoch < 5; epoch++)
+  {
+    pairing.addFix(fixAt(100.0 + 0.1 * epoch, 10.0 * epoch));
+    ASSERT_TRUE(pairing.nextPair(odometry)) << "epoch " << epoch;
+    EXPECT_EQ(10.0 * epoch, odometry.pose.pose.position.x);
+    EXPECT_EQ(epoch, odometry.twist.twist.linear.x);
+  }
+  EXPECT_EQ(5u, pairing.paired_epochs_);
+  EXPECT_EQ(0u, pairing.unpaired_fixes_);
+  EXPECT_EQ(0u, pairing.unpaired_velocities_);
+}
+
+// a sample older than the other stream by more than the tolerance is dropped
+TEST(FixVelocityPairing, DropsUnpairedSamples)
+{
+  FixVelocityPairing pairing;
+  pairing.setTolerance(0.025);
+  nav_msgs::Odometry odometry;
+
+  pairing.addFix(fixAt(100.0, 1.0));
+  pairing.addVelocity(velocityAt(100.1, 2.0));
+  EXPECT_FALSE(pairing.nextPair(odometry));
+  EXPECT_EQ(1u, pairing.unpaired_fixes_);
+
+  pairing.addVelocity(velocityAt(100.2, 3.0));
+  pairing.addFix(fixAt(100.2, 4.0));
+  ASSERT_TRUE(pairing.nextPair(odometry));
+  EXPECT_EQ(4.0, odometry.pose.pose.position.x);
+  EXPECT_EQ(3.0, odometry.twist.twist.linear.x);
+  EXPECT_EQ(1u, pairing.unpaired_velocities_);
+}
+
+// duplicated and out of order samples, and the oldest sample of a full buffer
+TEST(FixVelocityPairing, DropsOldAndOverflowingSamples)
+{
+  FixVelocityPairing pairing;
+  nav_msgs::Odometry odometry;
+
+  pairing.addFix(fixAt(100.0, 1.0));
+  pairing.addFix(fixAt(100.0, 2.0));
+  pairing.addFix(fixAt(99.9, 3.0));
+  EXPECT_EQ(2u, pairing.unpaired_fixes_);
+
+  for (int i = 1; i <= PAIRING_BUFFER_SIZE; i++)
+    pairing.addVelocity(velocityAt(200.0 + 0.1 * i, i));
+  EXPECT_EQ(0u, pairing.unpaired_velocities_);
+  pairing.addVelocity(velocityAt(300.0, 0.0));
+  EXPECT_EQ(1u, pairing.unpaired_velocities_);
+
+  pairing.reset();
+  EXPECT_EQ(0u, pairing.unpaired_fixes_);
+  EXPECT_EQ(0u, pairing.unpaired_velocities_);
+  EXPECT_FALSE(pairing.nextPair(odometry));
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,201 @@
+#include "geodetic_projection.h"
+#include <gtest/gtest.h>
+#include <math.h>
+
+namespace
+{
+
+/**
+ * \brief UTM northing on the central meridian, the scaled meridian arc from
+ * the equator integrated with Simpson's rule.
+ */
+double centralMeridianNorthing(double latitude)
+{
+  const double eccentricity_squared = WGS84_FLATTENING * (2.0 - WGS84_FLATTENING);
+  const int intervals = 20000;
+  double phi = latitude * M_PI / 180.0;
+  double h = phi / intervals;
+  double sum = 0.0;
+  for (int i = 0; i <= intervals; i++)
+  {
+    double s = sin(i * h);
+    double radius = WGS84_SEMI_MAJOR_AXIS * (1.0 - eccentricity_squared)
+        / pow(1.0 - eccentricity_squared * s * s, 1.5);
+    sum += (i == 0 || i == intervals ? 1.0 : (i % 2 == 1 ? 4.0 : 2.0)) * radius;
+  }
+  return 0.9996 * sum * h / 3.0;
+}
+
+}
+
+// GeoConvert: 33.3 44.4 -> 38n 444140.545 3684706.356
+TEST(UtmProjection, Reference)
+{
+  UtmProjection projection;
+  ASSERT_EQ(38, UtmProjection::zoneOf(33.3, 44.4));
+  projection.setZone(38, true);
+
+  double easting, northing;
+  projection.project(33.3, 44.4, easting, northing);
+  EXPECT_NEAR(444140.545, easting, 1e-3);
+  EXPECT_NEAR(3684706.356, northing, 1e-3);
+}
+
+TEST(UtmProjection, CentralMeridian)
+{
+  UtmProjection projection;
+  projection.setZone(31, true);
+
+  const double latitudes[] = {0.0, 15.0, 45.0, 70.0, 84.0};
+  for (int i = 0; i < 5; i++)
+  {
+    double easting, northing;
+    projection.project(latitudes[i], 3.0, easting, northing);
+    EXPECT_NEAR(500000.0, easting, 1e-6) << "latitude " << latitudes[i];
+    EXPECT_NEAR(centralMeridianNorthing(latitudes[i]), northing, 1e-3) << "latitude " << latitudes[i];
+  }
+
+  // symmetric about the central meridian
+  double east_easting, east_northing, west_easting, west_northing;
+  projection.project(40.0, 5.5, east_easting, east_northing);
+  projection.project(40.0, 0.5, west_easting, west_northing);
+  EXPECT_NEAR(east_easting - 500000.0, 500000.0 - west_easting, 1e-6);
+  EXPECT_NEAR(east_northing, west_northing, 1e-6);
+}
+
+// the southern hemisphere mirrors the north about the equator, with a false northing of 10000 km
+TEST(UtmProjection, SouthernHemisphere)
+{
+  UtmProjection projection;
+  projection.setZone(38, false);
+  EXPECT_FALSE(projection.north());
+
+  double easting, northing;
+  projection.project(-33.3, 44.4, easting, northing);
+  EXPECT_NEAR(444140.545, easting, 1e-3);
+  EXPECT_NEAR(10000000.0 - 3684706.356, northing, 1e-3);
+
+  // continuous across the equator in a fixed zone, 1 cm either side
+  double north_easting, north_northing;
+  projection.project(1e-7, 44.4, north_easting, north_northing);
+  projection.project(-1e-7, 44.4, easting, northing);
+  EXPECT_NEAR(0.011, north_northing - 10000000.0, 1e-3);
+  EXPECT_NEAR(north_northing - 10000000.0, 10000000.0 - northing, 1e-9);
+  EXPECT_NEAR(north_easting, easting, 1e-6);
+}
+
+TEST(UtmProjection, Zones)
+{
+  EXPECT_EQ(31, UtmProjection::zoneOf(50.0, 5.0));
+  EXPECT_EQ(1, UtmProjection::zoneOf(-10.0, -177.0));
+  EXPECT_EQ(60, UtmProjection::zoneOf(10.0, 179.9));
+  EXPECT_EQ(1, UtmProjection::zoneOf(10.0, 180.0));
+  EXPECT_EQ(30, UtmProjection::zoneOf(40.0, -0.5));
+
+  // south west Norway is zone 32 from 3 deg east
+  EXPECT_EQ(31, UtmProjection::zoneOf(60.0, 2.9));
+  EXPECT_EQ(32, UtmProjection::zoneOf(60.0, 3.0));
+  EXPECT_EQ(32, UtmProjection::zoneOf(56.0, 5.0));
+  EXPECT_EQ(31, UtmProjection::zoneOf(64.0, 5.0));
+  EXPECT_EQ(31, UtmProjection::zoneOf(55.9, 5.0));
+
+  // Svalbard has no zones 32, 34 and 36
+  EXPECT_EQ(31, UtmProjection::zoneOf(78.0, 8.9));
+  EXPECT_EQ(33, UtmProjection::zoneOf(78.0, 9.0));
+  EXPECT_EQ(33, UtmProjection::zoneOf(78.0, 20.9));
+  EXPECT_EQ(35, UtmProjection::zoneOf(78.0, 21.0));
+  EXPECT_EQ(35, UtmProjection::zoneOf(78.0, 32.9));
+  EXPECT_EQ(37, UtmProjection::zoneOf(78.0, 33.0));
+  EXPECT_EQ(37, UtmProjection::zoneOf(78.0, 41.9));
+  EXPECT_EQ(38, UtmProjection::zoneOf(78.0, 42.0));
+  EXPECT_EQ(32, UtmProjection::zoneOf(71.9, 10.0));
+}
+
+TEST(UtmProjection, ArrayMatchesScalar)
+{
+  UtmProjection projection;
+  projection.setZone(30, true);
+
+  const size_t count = 7;
+  double latitude[count], longitude[count], easting[count], northing[count];
+  for (size_t i = 0; i < count; i++)
+  {
+    latitude[i] = 38.0 + 0.3 * i;
+    longitude[i] = -3.0 + 0.7 * i;
+  }
+  projection.project(latitude, longitude, count, easting, northing);
+  for (size_t i = 0; i < count; i++)
+  {
+    double scalar_easting, scalar_northing;
+    projection.project(latitude[i], longitude[i], scalar_easting, scalar_northing);
+    EXPECT_EQ(scalar_easting, easting[i]);
+    EXPECT_EQ(scalar_northing, northing[i]);
+  }
+}
+
+TEST(LocalEnuProjection, Origin)
+{
+  LocalEnuProjection projection;
+  projection.setOrigin(38.38, -0.51, 120.0);
+
+  double east, north, up;
+  projection.project(38.38, -0.51, 120.0, east, north, up);
+  EXPECT_NEAR(0.0, east, 1e-6);
+  EXPECT_NEAR(0.0, north, 1e-6);
+  EXPECT_NEAR(0.0, up, 1e-6);
+
+  // along the normal of the ellipsoid
+  projection.project(38.38, -0.51, 220.0, east, north, up);
+  EXPECT_NEAR(0.0, east, 1e-6);
+  EXPECT_NEAR(0.0, north, 1e-6);
+  EXPECT_NEAR(100.0, up, 1e-6);
+}
+
+// on the equator a longitude step is a chord of the equatorial circle
+TEST(LocalEnuProjection, Equator)
+{
+  LocalEnuProjection projection;
+  projection.setOrigin(0.0, 10.0, 0.0);
+
+  const double steps[] = {1e-5, 0.01, 1.0, -2.0};
+  for (int i = 0; i < 4; i++)
+  {
+    double east, north, up;
+    double lambda = steps[i] * M_PI / 180.0;
+    projection.project(0.0, 10.0 + steps[i], 0.0, east, north, up);
+    EXPECT_NEAR(WGS84_SEMI_MAJOR_AXIS * sin(lambda), east, 1e-6) << "step " << steps[i];
+    EXPECT_NEAR(0.0, north, 1e-6) << "step " << steps[i];
+    EXPECT_NEAR(WGS84_SEMI_MAJOR_AXIS * (cos(lambda) - 1.0), up, 1e-6) << "step " << steps[i];
+  }
+}
+
+// a rotation of the earth centred frame, so distances are kept
+TEST(LocalEnuProjection, KeepsDistances)
+{
+  LocalEnuProjection origin;
+  origin.setOrigin(0.0, 0.0, 0.0);
+  LocalEnuProjection projection;
+  projection.setOrigin(45.0, 7.0, 300.0);
+
+  double east_a, north_a, up_a, east_b, north_b, up_b;
+  projection.project(45.01, 7.02, 250.0, east_a, north_a, up_a);
+  projection.project(44.98, 6.97, 400.0, east_b, north_b, up_b);
+  double distance = sqrt(pow(east_a - east_b, 2) + pow(north_a - north_b, 2) + pow(up_a - up_b, 2));
+
+  origin.project(45.01, 7.02, 250.0, east_a, north_a, up_a);
+  origin.project(44.98, 6.97, 400.0, east_b, north_b, up_b);
+  double reference = sqrt(pow(east_a - east_b, 2) + pow(north_a - north_b, 2) + pow(up_a - up_b, 2));
+  EXPECT_NEAR(reference, distance, 1e-6);
+
+  // north of the origin along the meridian
+  projection.project(45.001, 7.0, 300.0, east_a, north_a, up_a);
+  EXPECT_NEAR(0.0, east_a, 1e-6);
+  EXPECT_GT(north_a, 110.0);
+  EXPECT_LT(north_a, 112.0);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,119 @@
+/**
+ * \file calibration_benchmark.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: m.a.munoz
+ *
+ * Calibration cost per imu sample, per message as the callback did, per
+ * sample with correctAcc() and correctGyro(), and in batches with
+ * correctBatch() (AVX2 when the cpu supports it), and the time to calibrate
+ * one hour of a 1 kHz log.
+ */
+
+#include "imu_calibration.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+namespace
+{
+
+// one hour at 1 kHz, in bursts of ImuSampleBatch::CAPACITY samples
+const int BENCHMARK_BATCHES = 1000;
+const int BENCHMARK_REPEATS = 56;
+const double LOG_RATE = 1000.0;
+
+double uniform(double min, double max)
+{
+  return min + (max - min) * rand() / (double)RAND_MAX;
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+  srand(8);
+  ImuCalibration calibration;
+  for (int i = 0; i < 3; i++)
+  {
+    calibration.acc_bias_(i) = uniform(-0.5, 0.5);
+    calibration.gyro_bias_(i) = uniform(-0.05, 0.05);
+    for (int j = 0; j < 3; j++)
+    {
+      calibration.acc_misalignment_(i, j) = (i == j ? 1.0 : 0.0) + uniform(-0.02, 0.02);
+      calibration.acc_scale_factor_(i, j) = (i == j ? 1.0 : 0.0) + uniform(-0.05, 0.05);
+      calibration.gyro_misalignment_(i, j) = (i == j ? 1.0 : 0.0) + uniform(-0.02, 0.02);
+      calibration.gyro_scale_factor_(i, j) = (i == j ? 1.0 : 0.0) + uniform(-0.05, 0.05);
+    }
+  }
+  calibration.update();
+
+  const int count = ImuSampleBatch::CAPACITY;
+  std::vector<ImuSampleBatch> batches(BENCHMARK_BATCHES);
+  std::vector<sensor_msgs::Imu> messages(BENCHMARK_BATCHES * count);
+  for (int b = 0; b < BENCHMARK_BATCHES; b++)
+  {
+    ImuSample samples[count];
+    for (int i = 0; i < count; i++)
+    {
+      sensor_msgs::Imu& message = messages[b * count + i];
+      message.angular_velocity.x = samples[i].gyro[0] = uniform(-3.0, 3.0);
+      message.angular_velocity.y = samples[i].gyro[1] = uniform(-3.0, 3.0);
+      message.angular_velocity.z = samples[i].gyro[2] = uniform(-3.0, 3.0);
+      message.linear_acceleration.x = samples[i].acc[0] = uniform(-20.0, 20.0);
+      message.linear_acceleration.y = samples[i].acc[1] = uniform(-20.0, 20.0);
+      message.linear_acceleration.z = samples[i].acc[2] = uniform(-20.0, 20.0);
+    }
+    batches[b].assign(samples, count);
+  }
+  const double samples = (double)BENCHMARK_REPEATS * BENCHMARK_BATCHES * count;
+
+  // per message, a calibrated copy of every message
+  double checksum = 0.0;
+  sensor_msgs::Imu calibrated;
+  ros::WallTime start = ros::WallTime::now();
+  for (int repeat = 0; repeat < BENCHMARK_REPEATS; repeat++)
+  {
+    for (size_t i = 0; i < messages.size(); i++)
+    {
+      calibration.correct(messages[i], calibrated);
+      checksum += calibrated.angular_velocity.z;
+    }
+  }
+  double per_message = (ros::WallTime::now() - start).toSec() / samples * 1e9;
+
+  // per sample, on the readings only
+  start = ros::WallTime::now();
+  for (int repeat = 0; repeat < BENCHMARK_REPEATS; repeat++)
+  {
+    for (int b = 0; b < BENCHMARK_BATCHES; b++)
+    {
+      const ImuSampleBatch& batch = batches[b];
+      for (int i = 0; i < count; i++)
+      {
+        Eigen::Vector3d gyro = calibration.correctGyro(Eigen::Vector3d(batch.gyro_x[i], batch.gyro_y[i],
+                                                                       batch.gyro_z[i]));
+        Eigen::Vector3d acc = calibration.correctAcc(Eigen::Vector3d(batch.acc_x[i], batch.acc_y[i],
+                                                                     batch.acc_z[i]));
+        checksum += gyro(2) + acc(2);
+      }
+    }
+  }
+  double per_sample = (ros::WallTime::now() - start).toSec() / samples * 1e9;
+
+  // in batches, in place, so the repeats calibrate already calibrated readings
+  start = ros::WallTime::now();
+  for (int repeat = 0; repeat < BENCHMARK_REPEATS; repeat++)
+  {
+    for (int b = 0; b < BENCHMARK_BATCHES; b++)
+      calibration.correctBatch(batches[b]);
+  }
+  double batched = (ros::WallTime::now() - start).toSec() / samples * 1e9;
+  checksum += batches[0].gyro_z[0];
+
+  printf("calibration of %.0f samples [ns/sample]: per message %.1f, per sample %.1f, batch (%s) %.1f\n", samples,
+         per_message, per_sample, __builtin_cpu_supports("avx2") ? "avx2" : "scalar", batched);
+  printf("one hour of a %.0f Hz log [s]: per message %.2f, batch %.2f (checksum %g)\n", LOG_RATE,
+         per_message * 1e-9 * 3600.0 * LOG_RATE, batched * 1e-9 * 3600.0 * LOG_RATE, checksum);
+  return 0;
+}
@@ -0,0 +1,57 @@
+/**
+ * \file ekf_benchmark.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: m.a.munoz
+ *
+ * Cost of a KalmanFilter predict and correct cycle, with the full attitude
+ * observation and with the gps heading.
+ */
+
+#include "kalman_filter.h"
+#include <math.h>
+#include <stdio.h>
+
+namespace
+{
+
+const int BENCHMARK_CYCLES = 1000000;
+
+}
+
+int main(int argc, char *argv[])
+{
+  KalmanFilter filter;
+  filter.setGyroNoise(0.01);
+  Eigen::Matrix3d covariance = Eigen::Matrix3d::Identity() * 1e-3;
+
+  // the checksum keeps the loops
+  double checksum = 0.0;
+  double roll, pitch, yaw;
+
+  ros::WallTime start = ros::WallTime::now();
+  for (int cycle = 0; cycle < BENCHMARK_CYCLES; cycle++)
+  {
+    float t = cycle * 0.005f;
+    filter.predict(0.005, 0.01 * sin(t), -0.02, 0.1);
+    filter.correct(0.01 * cos(t), 0.02, fmod(0.0005 * cycle, 2.0 * M_PI) - M_PI, covariance);
+  }
+  double full = (ros::WallTime::now() - start).toSec() / BENCHMARK_CYCLES * 1e9;
+  filter.getState(roll, pitch, yaw);
+  checksum += yaw;
+
+  start = ros::WallTime::now();
+  for (int cycle = 0; cycle < BENCHMARK_CYCLES; cycle++)
+  {
+    filter.predict(0.005, 0.0, 0.0, 0.1);
+    filter.correct(fmod(0.0005 * cycle, 2.0 * M_PI) - M_PI, 1e-3);
+  }
+  double heading = (ros::WallTime::now() - start).toSec() / BENCHMARK_CYCLES * 1e9;
+  filter.getState(roll, pitch, yaw);
+  checksum += yaw;
+
+  printf("KalmanFilter predict and correct over %d cycles [ns]: full attitude %.1f, gps heading %.1f"
+         " (checksum %.3f)\n",
+         BENCHMARK_CYCLES, full, heading, checksum);
+  return 0;
+}
@@ -0,0 +1,133 @@
+/**
+ * \file latency_benchmark.cpp
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: m.a.munoz
+ *
+ * Latency of /imu/data to /virtual_imu_data through virtual_imu. Loaded in the
+ * same nodelet manager as virtual_imu the messages are passed as shared
+ * pointers; as a standalone node they go through TCPROS (see
+ * launch/benchmark_latency.launch).
+ */
+
+#include "ros/ros.h"
+#include "sensor_msgs/Imu.h"
+#include <algorithm>
+#include <vector>
+#ifdef BUILD_NODELET
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
+#endif
+
+/**
+ * \brief Imu publisher and virtual imu subscriber measuring the round trip
+ *
+ * Publishes imu samples stamped with the current time at ~rate [Hz], and
+ * measures the time until the virtual imu message with the same stamp is
+ * received (virtual_imu must run with use_header_stamp). After ~samples
+ * messages the latency statistics are reported.
+ */
+class LatencyBenchmark
+{
+private:
+
+  ros::NodeHandle node_handle_;
+  ros::Publisher imu_publisher_;
+  ros::Subscriber virtual_imu_subscriber_;
+  ros::Timer publish_timer_;
+
+  int samples_;
+  int warmup_;
+  int received_;
+  std::vector<double> latencies_;
+
+  void cb_publishTimer(const ros::TimerEvent& event)
+  {
+    sensor_msgs::ImuPtr imu_msg(new sensor_msgs::Imu);
+    imu_msg->header.stamp = ros::Time::now();
+    imu_msg->header.frame_id = "imu_link";
+    imu_msg->orientation.w = 1.0;
+    imu_msg->angular_velocity.z = 0.1;
+    imu_msg->linear_acceleration.z = 9.81;
+    this->imu_publisher_.publish(imu_msg);
+  }
+
+  void cb_virtualImu(const sensor_msgs::Imu::ConstPtr& virtual_imu_msg)
+  {
+    double latency = (ros::Time::now() - virtual_imu_msg->header.stamp).toSec();
+    if (++this->received_ <= this->warmup_)
+      return;
+    this->latencies_.push_back(latency);
+    if ((int)this->latencies_.size() < this->samples_)
+      return;
+
+    std::sort(this->latencies_.begin(), this->latencies_.end());
+    double mean = 0.0;
+    for (size_t i = 0; i < this->latencies_.size(); i++)
+      mean += this->latencies_[i] / this->latencies_.size();
+    ROS_INFO("virtual_imu latency over %d samples [us]: mean %.1f, median %.1f, p99 %.1f, max %.1f",
+             (int)this->latencies_.size(), mean * 1e6, this->latencies_[this->latencies_.size() / 2] * 1e6,
+             this->latencies_[this->latencies_.size() * 99 / 100] * 1e6, this->latencies_.back() * 1e6);
+    this->latencies_.clear();
+  }
+
+public:
+
+  /**
+   * \brief Constructor of LatencyBenchmark class
+   *
+   * @param node_handle is the handle of the topics.
+   * @param private_node_handle reads ~rate (default 200 Hz), ~samples
+   * (default 2000) and ~warmup (default 100 samples).
+   */
+  LatencyBenchmark(const ros::NodeHandle& node_handle, const ros::NodeHandle& private_node_handle) :
+      node_handle_(node_handle)
+  {
+    double rate;
+    private_node_handle.param("rate", rate, 200.0);
+    private_node_handle.param("samples", this->samples_, 2000);
+    private_node_handle.param("warmup", this->warmup_, 100);
+    this->received_ = 0;
+    this->latencies_.reserve(this->samples_);
+
+    this->imu_publisher_ = this->node_handle_.advertise < sensor_msgs::Imu > ("/imu/data", 1);
+    this->virtual_imu_subscriber_ = this->node_handle_.subscribe("/virtual_imu_data", 100,
+                                                                 &LatencyBenchmark::cb_virtualImu, this);
+    this->publish_timer_ = this->node_handle_.createTimer(ros::Duration(1.0 / rate),
+                                                          &LatencyBenchmark::cb_publishTimer, this);
+  }
+};
+
+#ifdef BUILD_NODELET
+namespace virtual_imu
+{
+
+/**
+ * \brief Nodelet version of LatencyBenchmark, to load it in the manager of virtual_imu.
+ */
+class LatencyBenchmarkNodelet : public nodelet::Nodelet
+{
+private:
+
+  boost::shared_ptr<LatencyBenchmark> benchmark_;
+
+  virtual void onInit(void)
+  {
+    this->benchmark_.reset(new LatencyBenchmark(this->getNodeHandle(), this->getPrivateNodeHandle()));
+  }
+};
+
+}
+
+PLUGINLIB_EXPORT_CLASS(virtual_imu::LatencyBenchmarkNodelet, nodelet::Nodelet)
+#else
+int main(int argc, char *argv[])
+{
+  ros::init(argc, argv, "virtual_imu_latency_benchmark");
+  ros::NodeHandle node_handle;
+  ros::NodeHandle private_node_handle("~");
+  LatencyBenchmark benchmark(node_handle, private_node_handle);
+  ros::spin();
+  return 0;
+}
+#endif
@@ -0,0 +1,96 @@
+/**
+ * \file attitude_propagator.h
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: m.a.munoz
+ */
+
+#ifndef _attitude_propagator_h_
+#define _attitude_propagator_h_
+
+#include <Eigen/Dense>
+#include <Eigen/Geometry>
+
+/**
+ * \brief Quaternion attitude propagator
+ *
+ * Integrates body angular rates on SO(3) with the exponential map, so the
+ * attitude is valid for any rotation and no rpy conversion is needed in the
+ * integration loop. Each step can be split in several sub-steps with the rate
+ * linearly interpolated between samples, and the coning correction can be
+ * applied to the rotation vector of every sub-step.
+ */
+class AttitudePropagator
+{
+private:
+
+  // attitude of the body frame in the reference frame
+  Eigen::Quaterniond q_;
+
+  // last integrated rate and rotation increment, for interpolation and coning
+  Eigen::Vector3d prev_rate_;
+  Eigen::Vector3d prev_increment_;
+  bool has_prev_;
+
+  int sub_steps_;
+  bool coning_compensation_;
+
+public:
+
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  /**
+   * \brief Constructor of AttitudePropagator class
+   *
+   * Starts at the identity attitude, with one sub-step and without coning compensation.
+   */
+  AttitudePropagator(void);
+
+  /**
+   * \brief Resets the attitude to identity and forgets the previous rate.
+   */
+  void reset(void);
+
+  /**
+   * \brief Number of sub-steps in which each propagation step is split.
+   */
+  void setSubSteps(int sub_steps);
+
+  /**
+   * \brief Enables the coning correction of the rotation vector.
+   */
+  void setConingCompensation(bool enabled);
+
+  /**
+   * \brief Propagates the attitude with the body rate measured at the end of the step.
+   *
+   * @param delta_t is the step duration in [s].
+   * @param rate is the body angular rate in [rad/s].
+   */
+  void propagate(double delta_t, const Eigen::Vector3d& rate);
+
+  /**
+   * \brief Current attitude.
+   */
+  const Eigen::Quaterniond& getQuaternion(void) const
+  {
+    return q_;
+  }
+
+  /**
+   * \brief Overwrites the current attitude, keeping the rate history.
+   */
+  void setQuaternion(const Eigen::Quaterniond& q);
+
+  /**
+   * \brief Current attitude as roll, pitch and yaw (ZYX convention, same as tf).
+   */
+  void getRPY(double& roll, double& pitch, double& yaw) const;
+
+  /**
+   * \brief Exponential map from a rotation vector to a unit quaternion.
+   */
+  static Eigen::Quaterniond expMap(const Eigen::Vector3d& rotation_vector);
+};
+
+#endif /* _attitude_propagator_h_ */
@@ -0,0 +1,154 @@
+/**
+ * \file imu_calibration.h
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: m.a.munoz
+ */
+
+#ifndef _imu_calibration_h_
+#define _imu_calibration_h_
+
+#include "ros/ros.h"
+#include "sensor_msgs/Imu.h"
+#include "imu_sample.h"
+#include <Eigen/Dense>
+#include <stdint.h>
+#include <string>
+
+/**
+ * \brief Imu calibration stage
+ *
+ * Holds the accelerometer and gyro calibration estimated with imu_tk and
+ * applies it to the raw imu readings as
+ *
+ *   corrected = misalignment * scale_factor * (reading - bias)
+ *
+ * The misalignment and scale factor are folded in a single matrix when the
+ * calibration is updated, so each reading costs one matrix product.
+ *
+ * The calibration is read from the parameter server (imu_calib.yaml loaded with
+ * rosparam), and can be stored in a binary cache keyed by the hash of the yaml
+ * file, so later starts do not need to parse the parameters.
+ */
+class ImuCalibration
+{
+private:
+
+  // misalignment * scale_factor, computed in update()
+  Eigen::Matrix3d acc_correction_;
+  Eigen::Matrix3d gyro_correction_;
+
+  /**
+   * \brief Reads a matrix stored as a flat array in the parameter server.
+   *
+   * @param name is the parameter name.
+   * @param rows is the number of rows expected.
+   * @param cols is the number of columns expected.
+   * @param data is the row major output, only modified if the parameter is valid.
+   * \return false if the parameter has a wrong type or size. A missing parameter is not an error.
+   */
+  static bool readParam(ros::NodeHandle& nh, const std::string& name, int rows, int cols, double* data);
+
+  /**
+   * \brief Copies the calibration to a flat array of CALIBRATION_SIZE values, or back.
+   */
+  void pack(double* data) const;
+  void unpack(const double* data);
+
+public:
+
+  // number of values of the whole calibration (two matrices and one vector per sensor)
+  static const int CALIBRATION_SIZE = 2 * (9 + 9 + 3);
+
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  Eigen::Vector3d acc_bias_;
+  Eigen::Matrix3d acc_scale_factor_;
+  Eigen::Matrix3d acc_misalignment_;
+
+  Eigen::Vector3d gyro_bias_;
+  Eigen::Matrix3d gyro_scale_factor_;
+  Eigen::Matrix3d gyro_misalignment_;
+
+  /**
+   * \brief Constructor of ImuCalibration class
+   *
+   * Starts with the identity calibration (no bias, unit scale, no misalignment).
+   */
+  ImuCalibration(void);
+
+  /**
+   * \brief Precomputes the correction matrices, must be called after changing the calibration.
+   */
+  void update(void);
+
+  /**
+   * \brief Corrects the accelerometer reading.
+   */
+  Eigen::Vector3d correctAcc(const Eigen::Vector3d& reading) const;
+
+  /**
+   * \brief Corrects the gyro reading.
+   */
+  Eigen::Vector3d correctGyro(const Eigen::Vector3d& reading) const;
+
+  /**
+   * \brief Corrects the accelerometer and gyro readings of a batch in place.
+   *
+   * Uses AVX2 when the cpu supports it, with a scalar fallback. Both kernels do
+   * the same floating point operations in the same order as correctAcc() and
+   * correctGyro(), so the results are identical to the per-sample path.
+   */
+  void correctBatch(ImuSampleBatch& batch) const;
+
+  /**
+   * \brief Corrects a raw imu message.
+   *
+   * The calibrated message is a copy of the raw one with corrected linear
+   * accelerations and angular velocities.
+   *
+   * @param raw_msg is the message read from the imu.
+   * @param calibrated_msg is the corrected message.
+   */
+  void correct(const sensor_msgs::Imu& raw_msg, sensor_msgs::Imu& calibrated_msg) const;
+
+  /**
+   * \brief Loads the calibration from the parameter server.
+   *
+   * Reads /acc_misalign_matrix, /acc_scale_matrix, /acc_bias_vector,
+   * /gyro_misalign_matrix, /gyro_scale_matrix and /gyro_bias_vector. Missing
+   * parameters keep their identity value.
+   *
+   * \return false if any of the parameters exists but has a wrong type or size.
+   */
+  bool loadFromParams(ros::NodeHandle& nh);
+
+  /**
+   * \brief Loads the calibration from a binary cache.
+   *
+   * @param path is the cache file.
+   * @param source_hash is the hash of the calibration file the cache must come from.
+   * \return false if the cache does not exist, is corrupted or comes from another file.
+   */
+  bool loadCache(const std::string& path, uint64_t source_hash);
+
+  /**
+   * \brief Stores the calibration in a binary cache.
+   *
+   * @param path is the cache file.
+   * @param source_hash is the hash of the calibration file the calibration was read from.
+   */
+  bool saveCache(const std::string& path, uint64_t source_hash) const;
+
+  /**
+   * \brief Hash of the calibration values, to identify the calibration in use.
+   */
+  uint64_t hash(void) const;
+
+  /**
+   * \brief Hash of the contents of a file (64 bit FNV-1a).
+   */
+  static bool hashFile(const std::string& path, uint64_t& hash);
+};
+
+#endif /* _imu_calibration_h_ */
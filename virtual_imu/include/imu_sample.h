@@ -0,0 +1,87 @@
+/**
+ * \file imu_sample.h
+ *
+ *  Created on: 17 Oct 2026
+ *      Author: m.a.munoz
+ */
+
+#ifndef _imu_sample_h_
+#define _imu_sample_h_
+
+#include "ros/time.h"
+#include "sensor_msgs/Imu.h"
+
+/**
+ * \brief Imu sample
+ *
+ * Copyable sample passed from the imu callback to the integration thread, with
+ * the raw readings to calibrate and the raw message, which keeps the header,
+ * the orientation and the covariances of the sample.
+ */
+struct ImuSample
+{
+  // header stamp of the imu message
+  ros::Time stamp;
+  // node clock when the message was received, elapsed time without header stamps
+  ros::Time received;
+  // wall time at which the message was received, for latency measurement
+  ros::WallTime arrival;
+  // raw angular velocity [rad/s]
+  double gyro[3];
+  // raw linear acceleration [m/s^2]
+  double acc[3];
+  // raw imu message
+  sensor_msgs::Imu::ConstPtr message;
+};
+
+/**
+ * \brief Batch of imu samples in structure of arrays layout
+ *
+ * Used to calibrate and integrate bursts of samples, with each axis stored
+ * contiguously so the calibration can be vectorized.
+ */
+struct ImuSampleBatch
+{
+  static const int CAPACITY = 64;
+
+  // number of valid samples
+  int size;
+
+  ros::Time stamp[CAPACITY];
+  ros::Time received[CAPACITY];
+  ros::WallTime arrival[CAPACITY];
+  sensor_msgs::Imu::ConstPtr message[CAPACITY];
+
+  double gyro_x[CAPACITY];
+  double gyro_y[CAPACITY];
+  double gyro_z[CAPACITY];
+
+  double acc_x[CAPACITY];
+  double acc_y[CAPACITY];
+  double acc_z[CAPACITY];
+
+  /**
+   * \brief Fills the batch with up to CAPACITY samples.
+   */
+  void assign(const ImuSample* samples, int count)
+  {
+    size = count;
+    if (size > CAPACITY)
+      size = CAPACITY;
+    for (int i = 0; i < size; i++)
+    {
+      stamp[i] = samples[i].stamp;
+      received[i] = samples[i].received;
+      arrival[i] = samples[i].arrival;
+      message[i] = samples[i].message;
+      gyro_x[i] = samples[i].gyro[0];
+      gyro_y[i] = samples[i].gyro[1];
+      gyro_z[i] = samples[i].gyro[2];
+      acc_x[i] = samples[i].acc[0];
+      acc_y[i] = samples[i].acc[1];
+      acc_z[i] = samples[i].acc[2];
+    }
+  }
+};
+
+#endif /* _imu_sample_h_ */
@@ -10,28 +10,109 @@
 
 #include "math.h"
 #include "ros/ros.h"
-//#include "../libraries/MatrixMath-master/MatrixMath.h" // utilizar eigen
+#include "attitude_propagator.h"
 
 #define MAX_DIFF 0.56
 
+/**
+ * \brief Fixed size extended Kalman filter core
+ *
+ * Covariance propagation and Joseph form update for a state of dimension N.
+ * All matrices are sized at compile time, so no memory is allocated while
+ * filtering.
+ */
+template <int N>
+class EkfCore
+{
+public:
+
+  typedef Eigen::Matrix<double, N, 1> StateVector;
+  typedef Eigen::Matrix<double, N, N> StateMatrix;
+
+  //covariance of the state error
+  StateMatrix P_;
+
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  EkfCore(void)
+  {
+    P_.setZero();
+  }
+
+  /**
+   * Covariance prediction with transition jacobian F and process noise Q
+   */
+  void predict(const StateMatrix& F, const StateMatrix& Q)
+  {
+    P_ = F * P_ * F.transpose() + Q;
+  }
+
+  /**
+   * Covariance prediction for an identity transition jacobian
+   */
+  void predict(const StateMatrix& Q)
+  {
+    P_ += Q;
+  }
+
+  /**
+   * Joseph form update with an observation of dimension M
+   *
+   * @param H is the observation jacobian.
+   * @param R is the observation noise covariance.
+   * @param residual is the difference between the observation and its prediction.
+   * \return the state error correction.
+   */
+  template <int M>
+  StateVector update(const Eigen::Matrix<double, M, N>& H, const Eigen::Matrix<double, M, M>& R,
+                     const Eigen::Matrix<double, M, 1>& residual)
+  {
+    Eigen::Matrix<double, N, M> PHt = P_ * H.transpose();
+    Eigen::Matrix<double, M, M> S = H * PHt + R;
+    Eigen::Matrix<double, N, M> K = S.ldlt().solve(PHt.transpose()).transpose();
+
+    StateMatrix I_KH = StateMatrix::Identity() - K * H;
+    P_ = I_KH * P_ * I_KH.transpose() + K * R * K.transpose();
+
+    return K * residual;
+  }
+};
+
 class KalmanFilter;
 typedef KalmanFilter* KalmanFilterPtr;
 
 /**
  * \brief Specific Kalman Filter
  *
- * Kalman Filter methods for estimate angle position
+ * Kalman Filter methods for estimate angle position. The state is the attitude
+ * quaternion, and the covariance is the one of the attitude error about the
+ * fixed axes (the orientation covariance convention of sensor_msgs::Imu).
  */
 class KalmanFilter
 {
 private:
 
+  //gyro noise density in [rad/s/sqrt(Hz)]
+  double gyro_noise_;
+
+  /**
+   * Applies an attitude error correction about the fixed axes
+   */
+  void applyCorrection(const Eigen::Vector3d& correction);
+
+  /**
+   * Jacobian of roll, pitch and yaw with respect to the attitude error about the fixed axes
+   */
+  Eigen::Matrix3d rpyJacobian(void) const;
+
 public:
 
-  //state vector of kalman filter process
-  float X_[3][1];
-  //covariance vector of kalman filter process
-  float P_[3][3];
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  //state of kalman filter process, attitude as quaternion
+  AttitudePropagator attitude_;
+  //covariance of kalman filter process
+  EkfCore<3> ekf_;
 
   /**
    * \brief Constructor of KalmanFilter class
@@ -41,18 +122,47 @@ public:
   KalmanFilter(void);
 
   /**
-   * Prediction step for kalman filter with model of rpy rate integration
+   * Gyro noise density used for the process noise, in [rad/s/sqrt(Hz)]
+   */
+  void setGyroNoise(double gyro_noise);
+
+  /**
+   * Prediction step for kalman filter, integrating the body rates on the attitude quaternion.
+   * The rates are integrated with the sign used by the previous rpy integration.
    */
   void predict(float delta_t, float roll_rate, float pitch_rate, float yaw_rate);
 
   /**
-   * Correction step for kalman filter with the angular position calculate with gps
+   * Correction step for kalman filter with an observation of the full angular position
+   *
+   * @param covariance is the covariance of the roll, pitch and yaw observation.
    */
-  void correct(float roll_obs, float pitch_obs, float yaw_obs);
+  void correct(float roll_obs, float pitch_obs, float yaw_obs, const Eigen::Matrix3d& covariance);
 
-  void getState(void);
+  /**
+   * Correction step for kalman filter with the heading calculated with gps
+   *
+   * @param yaw_variance is the variance of the heading observation.
+   */
+  void correct(float yaw_obs, float yaw_variance);
+
+  /**
+   * Current angular position as roll, pitch and yaw
+   */
+  void getState(double& roll, double& pitch, double& yaw) const;
 
-  void getVariances(void);
+  /**
+   * Current variances of roll, pitch and yaw
+   */
+  void getVariances(double& roll_variance, double& pitch_variance, double& yaw_variance) const;
+
+  /**
+   * Covariance of the attitude error about the fixed x, y and z axes
+   */
+  const Eigen::Matrix3d& getCovariance(void) const
+  {
+    return ekf_.P_;
+  }
 };
 
 #endif /* _kalman_filter_h_ */
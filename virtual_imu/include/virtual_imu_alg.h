@@ -34,6 +34,7 @@
 #include <virtual_imu/VirtualImuConfig.h>
 #include "sensor_msgs/Imu.h"
 #include "kalman_filter.h"
+#include "imu_sample.h"
 #include <tf/tf.h>
 #include <math.h>
 
@@ -56,9 +57,48 @@ protected:
   pthread_mutex_t access_;
 
   // private attributes and methods
+  bool first_sample_;
+  ros::Time last_stamp_;
+
+  /**
+   * \brief compute delta time
+   *
+   * Computes the time elapsed since the previous sample. If use_header_stamp is
+   * set the sample stamp is used, otherwise the node clock when the sample was
+   * received, so a burst drained at once keeps its spacing. Duplicated and out
+   * of order samples are rejected, and after a gap the integration restarts from
+   * the current sample with zero elapsed time.
+   *
+   * @param stamp is the header stamp of the current sample.
+   * @param received is the node clock when the current sample was received.
+   * @param delta_t is the elapsed time in [s].
+   * \return true if the sample has to be integrated.
+   */
+  bool computeDeltaT(const ros::Time& stamp, const ros::Time& received, float& delta_t);
+
+  /**
+   * \brief integrate sample
+   *
+   * Integrates one calibrated gyro sample in the attitude estimation. Shared by
+   * the per-message and the batch paths, so both give the same result.
+   */
+  void integrateSample(const ros::Time& stamp, const ros::Time& received, double gyro_x, double gyro_y,
+                       double gyro_z);
+
+  /**
+   * \brief fill orientation
+   *
+   * Sets the header, the current orientation and its covariance in the message.
+   */
+  void fillOrientation(const ros::Time& stamp, const ros::Time& received, sensor_msgs::Imu& virtual_imu_msg);
 
 public:
 
+  // sample timing statistics (header stamp mode)
+  unsigned long duplicated_samples_;
+  unsigned long out_of_order_samples_;
+  unsigned long gapped_samples_;
+
   KalmanFilterPtr estimation_rpy_;
 
   /**
@@ -153,11 +193,47 @@ public:
    * \brief create virtual imu
    *
    * This method gets rpy from real imu, and integrate this for calculate absolute orientation.
+   * The calibrated angular velocities and linear accelerations are copied to the new message.
+   *
+   * @param originl_imu_msg is the calibrated data from real imu.
+   * @param virtual_imu_msg is the new imu message generated.
+   */
+  void createVirtualImu(const sensor_msgs::Imu& originl_imu_msg, sensor_msgs::Imu& virtual_imu_msg);
+
+  /**
+   * \brief integrate batch
    *
-   * @param originl_imu_msg is the data from real imu.
+   * Integrates the samples [begin, end) of a calibrated batch in order. The
+   * attitude chain is sequential, so this is the same computation as calling
+   * createVirtualImu() for each sample, without building the messages.
+   *
+   * @param batch is the calibrated imu data.
+   * @param begin is the first sample to integrate.
+   * @param end is one past the last sample to integrate.
+   */
+  void integrateBatch(const ImuSampleBatch& batch, int begin, int end);
+
+  /**
+   * \brief create virtual imu from a batch sample
+   *
+   * Fills the message with the current orientation and the rates of an already
+   * integrated batch sample, with the rate covariances of its imu message.
+   *
+   * @param batch is the calibrated imu data.
+   * @param index is the sample whose stamp and rates are copied.
    * @param virtual_imu_msg is the new imu message generated.
    */
-  void createVirtualImu(sensor_msgs::Imu originl_imu_msg, sensor_msgs::Imu& virtual_imu_msg);
+  void createVirtualImu(const ImuSampleBatch& batch, int index, sensor_msgs::Imu& virtual_imu_msg);
+
+  /**
+   * \brief correct heading
+   *
+   * This method corrects the estimated orientation with an external heading observation.
+   *
+   * @param yaw is the observed heading in [rad].
+   * @param yaw_variance is the variance of the observed heading.
+   */
+  void correctHeading(double yaw, double yaw_variance);
 
 };
 
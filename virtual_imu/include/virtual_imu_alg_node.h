@@ -32,11 +32,24 @@
 #define _virtual_imu_alg_node_h_
 
 #include <iri_base_algorithm/iri_base_algorithm.h>
+#include <dynamic_reconfigure/server.h>
 #include "virtual_imu_alg.h"
+#include "imu_calibration.h"
+#include "imu_sample.h"
 #include "sensor_msgs/Imu.h"
 #include "geometry_msgs/TwistWithCovarianceStamped.h"
+#include "nav_msgs/Odometry.h"
 #include <Eigen/Dense>
-#include <XmlRpcException.h>
+#include <stdlib.h>
+#include <semaphore.h>
+#include <boost/atomic.hpp>
+#include <boost/make_shared.hpp>
+#include <boost/lockfree/spsc_queue.hpp>
+
+// capacity of the ring between the imu callback and the integration thread (1 s at 1 kHz)
+#define IMU_RING_SIZE 1024
+// maximum number of samples integrated with the algorithm locked
+#define IMU_BATCH_SIZE ImuSampleBatch::CAPACITY
 //#include <fstream>
 
 // [publisher subscriber headers]
@@ -54,35 +67,83 @@ class VirtualImuAlgNode : public algorithm_base::IriBaseAlgorithm<VirtualImuAlgo
 {
 private:
 
-  sensor_msgs::Imu originl_imu_msg_;
-
   // [publisher attributes]
   ros::Publisher imu_publisher_;
   sensor_msgs::Imu virtual_imu_msg_;
+  ros::Publisher calibrated_imu_publisher_;
 
   // [subscriber attributes]
   ros::Subscriber original_imu_;
   ros::Subscriber gps_velocity_;
+  ros::Subscriber gps_odometry_;
 
   /**
    * \brief Callback for read imu messages.
    */
-  void cb_imuData(const sensor_msgs::Imu& Imu_msg);
+  void cb_imuData(const sensor_msgs::Imu::ConstPtr& Imu_msg);
 
-  Eigen::Vector3d acc_reading_;
-  Eigen::Vector3d acc_corrected_;
+  /**
+   * \brief Callback for read the gps odometry, whose heading corrects the estimated yaw.
+   */
+  void cb_gpsOdometry(const nav_msgs::Odometry::ConstPtr& odom_msg);
 
-  Eigen::Vector3d acc_bias_;
-  Eigen::Matrix3d acc_scale_factor_;
-  Eigen::Matrix3d acc_misaligment_;
+  ImuCalibration calibration_;
 
-  Eigen::Vector3d gyro_reading_;
-  Eigen::Vector3d gyro_corrected_;
+  /**
+   * \brief Loads the imu calibration.
+   *
+   * If ~calibration_file points to the imu_calib.yaml loaded in rosparam, the
+   * calibration is read from the binary cache ~calibration_cache (default
+   * $ROS_HOME/virtual_imu_calibration.bin) when it was generated from the same
+   * file. Otherwise it is read from rosparam and, if it is valid, the cache is
+   * rewritten.
+   */
+  void loadCalibration(void);
+
+  // event driven output
+  int samples_since_publish_;
+  unsigned long published_msgs_;
+  double latency_last_;
+  double latency_mean_;
+  double latency_max_;
+
+  // lock-free ring from cb_imuData (producer) to the integration thread (consumer)
+  boost::lockfree::spsc_queue<ImuSample, boost::lockfree::capacity<IMU_RING_SIZE> > imu_ring_;
+  sem_t imu_ring_semaphore_;
+  boost::atomic<unsigned long> ring_high_water_mark_;
+  boost::atomic<unsigned long> ring_overruns_;
+
+  bool new_virtual_imu_;
+  pthread_t integration_thread_;
+  boost::atomic<bool> integration_running_;
+
+  /**
+   * \brief Integration thread
+   *
+   * Waits for samples in the imu ring, calibrates them in batches, publishes
+   * the calibrated messages and integrates the batch. In event
+   * driven mode every integrated sample is published, otherwise the last
+   * result is published by mainNodeThread.
+   */
+  static void *integrationThread(void *param);
 
-  Eigen::Vector3d gyro_bias_;
-  Eigen::Matrix3d gyro_scale_factor_;
-  Eigen::Matrix3d gyro_misaligment_;
+  /**
+   * \brief Integrates a batch of imu samples and publishes them if decimation allows it.
+   *
+   * Called from the integration thread in event driven mode. The batch is
+   * integrated in runs that end at the samples to publish, and the elapsed time
+   * since the arrival of each published sample is accumulated for diagnostics.
+   *
+   * @param batch is the calibrated imu data.
+   */
+  void integrateAndPublish(const ImuSampleBatch& batch);
 
+  /**
+   * \brief Publishes the calibrated imu messages of a batch.
+   *
+   * @param batch is the imu data already calibrated with correctBatch().
+   */
+  void publishCalibrated(const ImuSampleBatch& batch);
 
   // [service attributes]
 
@@ -99,7 +160,39 @@ private:
    * Is updated everytime function config_update() is called.
    */
   Config config_;
+
+  // node loop when loaded as a nodelet, see startNodeLoop()
+  pthread_t node_loop_thread_;
+  boost::atomic<bool> node_loop_running_;
+
+  /**
+   * \brief Node loop thread
+   *
+   * Same loop as the one run by algorithm_base::main: mainNodeThread() and the
+   * diagnostics update at the loop rate.
+   */
+  static void *nodeLoopThread(void *param);
+
+  // dynamic reconfigure server on the private namespace of the nodelet
+  boost::shared_ptr<dynamic_reconfigure::Server<Config> > nodelet_reconfigure_server_;
+
+  /**
+   * \brief Dynamic reconfigure callback of the nodelet server
+   *
+   * Updates the algorithm and the node configuration, as the callback of the
+   * base class server.
+   */
+  void nodeletConfigUpdate(Config &config, uint32_t level);
+
+  /**
+   * \brief Initializes the node attributes and its ROS communications.
+   */
+  void init(void);
+
 public:
+
+  EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
   /**
    * \brief Constructor
    *
@@ -108,6 +201,18 @@ public:
    */
   VirtualImuAlgNode(void);
 
+  /**
+   * \brief Nodelet constructor
+   *
+   * Same as the default constructor, with the node handles of the nodelet
+   * instead of the ones of the process, and a dynamic reconfigure server on
+   * the private namespace of the nodelet.
+   *
+   * @param node_handle is the nodelet node handle.
+   * @param private_node_handle is the nodelet private node handle.
+   */
+  VirtualImuAlgNode(const ros::NodeHandle& node_handle, const ros::NodeHandle& private_node_handle);
+
   /**
    * \brief Destructor
    *
@@ -116,6 +221,20 @@ public:
    */
   ~VirtualImuAlgNode(void);
 
+  /**
+   * \brief Starts the node loop
+   *
+   * Used by the nodelet, which can not block in algorithm_base::main. Adds the
+   * node diagnostics and runs mainNodeThread() in its own thread until
+   * stopNodeLoop() is called. The callbacks are served by the nodelet manager.
+   */
+  void startNodeLoop(void);
+
+  /**
+   * \brief Stops the node loop started with startNodeLoop().
+   */
+  void stopNodeLoop(void);
+
 protected:
   /**
    * \brief main node thread
@@ -155,6 +274,11 @@ protected:
 
   // [diagnostic functions]
 
+  /**
+   * \brief Reports the publication latency and the imu sample timing statistics.
+   */
+  void timingDiagnostic(diagnostic_updater::DiagnosticStatusWrapper &stat);
+
   // [test functions]
 };
 
@@ -0,0 +1,87 @@
+#include "attitude_propagator.h"
+#include <math.h>
+
+AttitudePropagator::AttitudePropagator(void)
+{
+  this->sub_steps_ = 1;
+  this->coning_compensation_ = false;
+  this->reset();
+}
+
+void AttitudePropagator::reset(void)
+{
+  this->q_.setIdentity();
+  this->prev_rate_.setZero();
+  this->prev_increment_.setZero();
+  this->has_prev_ = false;
+}
+
+void AttitudePropagator::setSubSteps(int sub_steps)
+{
+  this->sub_steps_ = sub_steps < 1 ? 1 : sub_steps;
+}
+
+void AttitudePropagator::setConingCompensation(bool enabled)
+{
+  this->coning_compensation_ = enabled;
+}
+
+void AttitudePropagator::propagate(double delta_t, const Eigen::Vector3d& rate)
+{
+  if (!this->has_prev_)
+  {
+    this->prev_rate_ = rate;
+    this->has_prev_ = true;
+  }
+
+  double h = delta_t / this->sub_steps_;
+  for (int j = 1; j <= this->sub_steps_; j++)
+  {
+    // rate at the end of the sub-step, linearly interpolated from the previous sample
+    Eigen::Vector3d increment = (this->prev_rate_ + (rate - this->prev_rate_) * ((double)j / this->sub_steps_)) * h;
+
+    Eigen::Vector3d rotation_vector = increment;
+    if (this->coning_compensation_)
+      rotation_vector += this->prev_increment_.cross(increment) / 12.0;
+
+    this->q_ = this->q_ * expMap(rotation_vector);
+    this->prev_increment_ = increment;
+  }
+  this->q_.normalize();
+
+  this->prev_rate_ = rate;
+}
+
+void AttitudePropagator::setQuaternion(const Eigen::Quaterniond& q)
+{
+  this->q_ = q.normalized();
+}
+
+void AttitudePropagator::getRPY(double& roll, double& pitch, double& yaw) const
+{
+  const Eigen::Quaterniond& q = this->q_;
+
+  roll = atan2(2.0 * (q.w() * q.x() + q.y() * q.z()), 1.0 - 2.0 * (q.x() * q.x() + q.y() * q.y()));
+
+  double sin_pitch = 2.0 * (q.w() * q.y() - q.z() * q.x());
+  if (sin_pitch > 1.0)
+    sin_pitch = 1.0;
+  else if (sin_pitch < -1.0)
+    sin_pitch = -1.0;
+  pitch = asin(sin_pitch);
+
+  yaw = atan2(2.0 * (q.w() * q.z() + q.x() * q.y()), 1.0 - 2.0 * (q.y() * q.y() + q.z() * q.z()));
+}
+
+Eigen::Quaterniond AttitudePropagator::expMap(const Eigen::Vector3d& rotation_vector)
+{
+  double angle = rotation_vector.norm();
+
+  // first order expansion for small angles to avoid the division by zero
+  if (angle < 1e-8)
+    return Eigen::Quaterniond(1.0, 0.5 * rotation_vector(0), 0.5 * rotation_vector(1), 0.5 * rotation_vector(2));
+
+  double half_angle = 0.5 * angle;
+  double k = sin(half_angle) / angle;
+  return Eigen::Quaterniond(cos(half_angle), k * rotation_vector(0), k * rotation_vector(1), k * rotation_vector(2));
+}
@@ -0,0 +1,314 @@
+#include "imu_calibration.h"
+#include <fstream>
+#include <string.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define IMU_CALIBRATION_AVX2
+#endif
+
+namespace
+{
+
+// row major correction matrix and bias of one sensor, as used by the batch kernels
+struct AxisCorrection
+{
+  double t[9];
+  double b[3];
+
+  AxisCorrection(const Eigen::Matrix3d& correction, const Eigen::Vector3d& bias)
+  {
+    for (int i = 0; i < 3; i++)
+    {
+      for (int j = 0; j < 3; j++)
+        t[3 * i + j] = correction(i, j);
+      b[i] = bias(i);
+    }
+  }
+};
+
+// Scalar kernel. The products are summed left to right and the file is built
+// with fp contraction disabled, so the avx2 kernel gives the same bits.
+inline void correctScalar(const AxisCorrection& c, double* x, double* y, double* z, int begin, int end)
+{
+  for (int i = begin; i < end; i++)
+  {
+    double dx = x[i] - c.b[0];
+    double dy = y[i] - c.b[1];
+    double dz = z[i] - c.b[2];
+    x[i] = c.t[0] * dx + c.t[1] * dy + c.t[2] * dz;
+    y[i] = c.t[3] * dx + c.t[4] * dy + c.t[5] * dz;
+    z[i] = c.t[6] * dx + c.t[7] * dy + c.t[8] * dz;
+  }
+}
+
+#ifdef IMU_CALIBRATION_AVX2
+// Four samples per iteration, returns the number of samples corrected. The
+// remaining ones are left for the scalar kernel.
+__attribute__((target("avx2")))
+int correctAvx2(const AxisCorrection& c, double* x, double* y, double* z, int size)
+{
+  __m256d t[9];
+  for (int k = 0; k < 9; k++)
+    t[k] = _mm256_set1_pd(c.t[k]);
+  __m256d bx = _mm256_set1_pd(c.b[0]);
+  __m256d by = _mm256_set1_pd(c.b[1]);
+  __m256d bz = _mm256_set1_pd(c.b[2]);
+
+  int i = 0;
+  for (; i + 4 <= size; i += 4)
+  {
+    __m256d dx = _mm256_sub_pd(_mm256_loadu_pd(x + i), bx);
+    __m256d dy = _mm256_sub_pd(_mm256_loadu_pd(y + i), by);
+    __m256d dz = _mm256_sub_pd(_mm256_loadu_pd(z + i), bz);
+
+    __m256d rx = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(t[0], dx), _mm256_mul_pd(t[1], dy)),
+                               _mm256_mul_pd(t[2], dz));
+    __m256d ry = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(t[3], dx), _mm256_mul_pd(t[4], dy)),
+                               _mm256_mul_pd(t[5], dz));
+    __m256d rz = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(t[6], dx), _mm256_mul_pd(t[7], dy)),
+                               _mm256_mul_pd(t[8], dz));
+
+    _mm256_storeu_pd(x + i, rx);
+    _mm256_storeu_pd(y + i, ry);
+    _mm256_storeu_pd(z + i, rz);
+  }
+  return i;
+}
+
+bool hasAvx2(void)
+{
+  static const bool supported = __builtin_cpu_supports("avx2");
+  return supported;
+}
+#endif
+
+void correctAxes(const AxisCorrection& c, double* x, double* y, double* z, int size)
+{
+  int done = 0;
+#ifdef IMU_CALIBRATION_AVX2
+  if (hasAvx2())
+    done = correctAvx2(c, x, y, z, size);
+#endif
+  correctScalar(c, x, y, z, done, size);
+}
+
+}
+
+ImuCalibration::ImuCalibration(void)
+{
+  acc_bias_.setZero();
+  acc_scale_factor_.setIdentity();
+  acc_misalignment_.setIdentity();
+
+  gyro_bias_.setZero();
+  gyro_scale_factor_.setIdentity();
+  gyro_misalignment_.setIdentity();
+
+  update();
+}
+
+void ImuCalibration::update(void)
+{
+  acc_correction_ = acc_misalignment_ * acc_scale_factor_;
+  gyro_correction_ = gyro_misalignment_ * gyro_scale_factor_;
+}
+
+Eigen::Vector3d ImuCalibration::correctAcc(const Eigen::Vector3d& reading) const
+{
+  Eigen::Vector3d acc = reading;
+  correctScalar(AxisCorrection(acc_correction_, acc_bias_), &acc(0), &acc(1), &acc(2), 0, 1);
+  return acc;
+}
+
+Eigen::Vector3d ImuCalibration::correctGyro(const Eigen::Vector3d& reading) const
+{
+  Eigen::Vector3d gyro = reading;
+  correctScalar(AxisCorrection(gyro_correction_, gyro_bias_), &gyro(0), &gyro(1), &gyro(2), 0, 1);
+  return gyro;
+}
+
+void ImuCalibration::correctBatch(ImuSampleBatch& batch) const
+{
+  correctAxes(AxisCorrection(acc_correction_, acc_bias_), batch.acc_x, batch.acc_y, batch.acc_z, batch.size);
+  correctAxes(AxisCorrection(gyro_correction_, gyro_bias_), batch.gyro_x, batch.gyro_y, batch.gyro_z, batch.size);
+}
+
+void ImuCalibration::correct(const sensor_msgs::Imu& raw_msg, sensor_msgs::Imu& calibrated_msg) const
+{
+  Eigen::Vector3d acc = correctAcc(
+      Eigen::Vector3d(raw_msg.linear_acceleration.x, raw_msg.linear_acceleration.y, raw_msg.linear_acceleration.z));
+  Eigen::Vector3d gyro = correctGyro(
+      Eigen::Vector3d(raw_msg.angular_velocity.x, raw_msg.angular_velocity.y, raw_msg.angular_velocity.z));
+
+  calibrated_msg = raw_msg;
+  calibrated_msg.linear_acceleration.x = acc(0);
+  calibrated_msg.linear_acceleration.y = acc(1);
+  calibrated_msg.linear_acceleration.z = acc(2);
+  calibrated_msg.angular_velocity.x = gyro(0);
+  calibrated_msg.angular_velocity.y = gyro(1);
+  calibrated_msg.angular_velocity.z = gyro(2);
+}
+
+namespace
+{
+
+const char CACHE_MAGIC[8] = {'V', 'I', 'M', 'U', 'C', 'A', 'L', '\0'};
+const uint32_t CACHE_VERSION = 1;
+
+struct CacheHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t size;
+  uint64_t source_hash;
+  uint64_t values_hash;
+};
+
+const uint64_t FNV_OFFSET = 14695981039346656037ULL;
+const uint64_t FNV_PRIME = 1099511628211ULL;
+
+uint64_t fnv1a(const void* data, size_t length, uint64_t hash = FNV_OFFSET)
+{
+  const unsigned char* bytes = static_cast<const unsigned char*>(data);
+  for (size_t i = 0; i < length; i++)
+  {
+    hash ^= bytes[i];
+    hash *= FNV_PRIME;
+  }
+  return hash;
+}
+
+}
+
+bool ImuCalibration::readParam(ros::NodeHandle& nh, const std::string& name, int rows, int cols, double* data)
+{
+  XmlRpc::XmlRpcValue config;
+  if (!nh.getParam(name, config))
+  {
+    ROS_WARN("IMU calibration: %s not found, using identity", name.c_str());
+    return true;
+  }
+
+  if (config.getType() != XmlRpc::XmlRpcValue::TypeArray || config.size() != rows * cols)
+  {
+    ROS_ERROR("IMU calibration: %s must be an array of %d values", name.c_str(), rows * cols);
+    return false;
+  }
+
+  // values written without decimal point are read as integers
+  double values[9];
+  for (int i = 0; i < rows * cols; i++)
+  {
+    if (config[i].getType() == XmlRpc::XmlRpcValue::TypeDouble)
+      values[i] = static_cast<double>(config[i]);
+    else if (config[i].getType() == XmlRpc::XmlRpcValue::TypeInt)
+      values[i] = static_cast<int>(config[i]);
+    else
+    {
+      ROS_ERROR("IMU calibration: element %d of %s is not a number", i, name.c_str());
+      return false;
+    }
+  }
+
+  for (int i = 0; i < rows * cols; i++)
+    data[i] = values[i];
+  return true;
+}
+
+void ImuCalibration::pack(double* data) const
+{
+  Eigen::Map<Eigen::Matrix<double, 3, 3, Eigen::RowMajor> >(data + 0) = acc_misalignment_;
+  Eigen::Map<Eigen::Matrix<double, 3, 3, Eigen::RowMajor> >(data + 9) = acc_scale_factor_;
+  Eigen::Map<Eigen::Vector3d>(data + 18) = acc_bias_;
+  Eigen::Map<Eigen::Matrix<double, 3, 3, Eigen::RowMajor> >(data + 21) = gyro_misalignment_;
+  Eigen::Map<Eigen::Matrix<double, 3, 3, Eigen::RowMajor> >(data + 30) = gyro_scale_factor_;
+  Eigen::Map<Eigen::Vector3d>(data + 39) = gyro_bias_;
+}
+
+void ImuCalibration::unpack(const double* data)
+{
+  acc_misalignment_ = Eigen::Map<const Eigen::Matrix<double, 3, 3, Eigen::RowMajor> >(data + 0);
+  acc_scale_factor_ = Eigen::Map<const Eigen::Matrix<double, 3, 3, Eigen::RowMajor> >(data + 9);
+  acc_bias_ = Eigen::Map<const Eigen::Vector3d>(data + 18);
+  gyro_misalignment_ = Eigen::Map<const Eigen::Matrix<double, 3, 3, Eigen::RowMajor> >(data + 21);
+  gyro_scale_factor_ = Eigen::Map<const Eigen::Matrix<double, 3, 3, Eigen::RowMajor> >(data + 30);
+  gyro_bias_ = Eigen::Map<const Eigen::Vector3d>(data + 39);
+  update();
+}
+
+bool ImuCalibration::loadFromParams(ros::NodeHandle& nh)
+{
+  double data[CALIBRATION_SIZE];
+  pack(data);
+
+  bool valid = true;
+  valid &= readParam(nh, "/acc_misalign_matrix", 3, 3, data + 0);
+  valid &= readParam(nh, "/acc_scale_matrix", 3, 3, data + 9);
+  valid &= readParam(nh, "/acc_bias_vector", 3, 1, data + 18);
+  valid &= readParam(nh, "/gyro_misalign_matrix", 3, 3, data + 21);
+  valid &= readParam(nh, "/gyro_scale_matrix", 3, 3, data + 30);
+  valid &= readParam(nh, "/gyro_bias_vector", 3, 1, data + 39);
+
+  unpack(data);
+  return valid;
+}
+
+bool ImuCalibration::loadCache(const std::string& path, uint64_t source_hash)
+{
+  std::ifstream file(path.c_str(), std::ios::binary);
+  if (!file.is_open())
+    return false;
+
+  CacheHeader header;
+  double data[CALIBRATION_SIZE];
+  file.read(reinterpret_cast<char*>(&header), sizeof(header));
+  file.read(reinterpret_cast<char*>(data), sizeof(data));
+  if (!file.good())
+    return false;
+
+  if (memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 || header.version != CACHE_VERSION
+      || header.size != CALIBRATION_SIZE || header.source_hash != source_hash
+      || header.values_hash != fnv1a(data, sizeof(data)))
+    return false;
+
+  unpack(data);
+  return true;
+}
+
+bool ImuCalibration::saveCache(const std::string& path, uint64_t source_hash) const
+{
+  CacheHeader header;
+  double data[CALIBRATION_SIZE];
+  pack(data);
+
+  memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+  header.version = CACHE_VERSION;
+  header.size = CALIBRATION_SIZE;
+  header.source_hash = source_hash;
+  header.values_hash = fnv1a(data, sizeof(data));
+
+  std::ofstream file(path.c_str(), std::ios::binary | std::ios::trunc);
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  file.write(reinterpret_cast<const char*>(data), sizeof(data));
+  return file.good();
+}
+
+uint64_t ImuCalibration::hash(void) const
+{
+  double data[CALIBRATION_SIZE];
+  pack(data);
+  return fnv1a(data, sizeof(data));
+}
+
+bool ImuCalibration::hashFile(const std::string& path, uint64_t& hash)
+{
+  std::ifstream file(path.c_str(), std::ios::binary);
+  if (!file.is_open())
+    return false;
+
+  hash = FNV_OFFSET;
+  char buffer[4096];
+  while (file.read(buffer, sizeof(buffer)) || file.gcount() > 0)
+    hash = fnv1a(buffer, file.gcount(), hash);
+  return true;
+}
@@ -5,50 +5,99 @@ KalmanFilter::KalmanFilter(void)
   //Initializations:
 
   //State
-  X_[0][0] = 0.0; //Roll
-  X_[1][0] = 0.0; //Pitch
-  X_[2][0] = 0.0; //Yaw
+  attitude_.reset();
 
   //Covariance matrix
-  P_[0][0] = 0.0;
-  P_[0][1] = 0.0;
-  P_[0][2] = 0.0;
+  ekf_.P_.setZero();
 
-  // [...]
+  gyro_noise_ = 0.0;
+}
+
+void KalmanFilter::setGyroNoise(double gyro_noise)
+{
+  gyro_noise_ = gyro_noise;
 }
 
 void KalmanFilter::predict(float delta_t, float roll_rate, float pitch_rate, float yaw_rate)
 {
   //State prediction
 
-  if (abs(delta_t * roll_rate) < MAX_DIFF && abs(delta_t * pitch_rate) < MAX_DIFF && abs(delta_t * yaw_rate) < MAX_DIFF)
+  if (fabs(delta_t * roll_rate) < MAX_DIFF && fabs(delta_t * pitch_rate) < MAX_DIFF
+      && fabs(delta_t * yaw_rate) < MAX_DIFF)
   {
-    X_[0][0] = X_[0][0] - delta_t * roll_rate;
-    X_[1][0] = X_[1][0] - delta_t * pitch_rate;
-    X_[2][0] = X_[2][0] - delta_t * yaw_rate;
-  }
-  else
-  {
-    X_[0][0] = X_[0][0];
-    X_[1][0] = X_[1][0];
-    X_[2][0] = X_[2][0];
+    attitude_.propagate(delta_t, Eigen::Vector3d(-roll_rate, -pitch_rate, -yaw_rate));
   }
 
-  // [...]
+  //Covariance prediction, the attitude error about the fixed axes is not
+  //changed by the body rotation, so the transition jacobian is the identity
+  //and only the gyro noise integrated along the step is added
+  ekf_.predict(Eigen::Matrix3d::Identity() * (gyro_noise_ * gyro_noise_ * fabs(delta_t)));
 }
 
-void KalmanFilter::correct(float roll_obs, float pitch_obs, float yaw_obs)
+void KalmanFilter::correct(float roll_obs, float pitch_obs, float yaw_obs, const Eigen::Matrix3d& covariance)
 {
-  // [...]
+  double roll, pitch, yaw;
+  attitude_.getRPY(roll, pitch, yaw);
+
+  Eigen::Vector3d residual(roll_obs - roll, pitch_obs - pitch, yaw_obs - yaw);
+  for (int i = 0; i < 3; i++)
+    residual(i) = atan2(sin(residual(i)), cos(residual(i)));
+
+  applyCorrection(ekf_.update<3>(rpyJacobian(), covariance, residual));
 }
 
-void KalmanFilter::getState(void)
+void KalmanFilter::correct(float yaw_obs, float yaw_variance)
 {
-  // [...]
+  double roll, pitch, yaw;
+  attitude_.getRPY(roll, pitch, yaw);
+
+  Eigen::Matrix<double, 1, 3> H = rpyJacobian().row(2);
+  Eigen::Matrix<double, 1, 1> R;
+  R(0, 0) = yaw_variance;
+  Eigen::Matrix<double, 1, 1> residual;
+  residual(0) = atan2(sin(yaw_obs - yaw), cos(yaw_obs - yaw));
+
+  applyCorrection(ekf_.update<1>(H, R, residual));
 }
 
-void KalmanFilter::getVariances(void)
+void KalmanFilter::getState(double& roll, double& pitch, double& yaw) const
 {
-  // [...]
+  attitude_.getRPY(roll, pitch, yaw);
 }
 
+void KalmanFilter::getVariances(double& roll_variance, double& pitch_variance, double& yaw_variance) const
+{
+  Eigen::Matrix3d T = rpyJacobian();
+  Eigen::Matrix3d rpy_covariance = T * ekf_.P_ * T.transpose();
+
+  roll_variance = rpy_covariance(0, 0);
+  pitch_variance = rpy_covariance(1, 1);
+  yaw_variance = rpy_covariance(2, 2);
+}
+
+void KalmanFilter::applyCorrection(const Eigen::Vector3d& correction)
+{
+  attitude_.setQuaternion(AttitudePropagator::expMap(correction) * attitude_.getQuaternion());
+}
+
+Eigen::Matrix3d KalmanFilter::rpyJacobian(void) const
+{
+  double roll, pitch, yaw;
+  attitude_.getRPY(roll, pitch, yaw);
+
+  // keep the jacobian bounded close to the pitch singularity
+  double cos_pitch = cos(pitch);
+  if (fabs(cos_pitch) < 1e-3)
+    cos_pitch = cos_pitch < 0.0 ? -1e-3 : 1e-3;
+  double tan_pitch = sin(pitch) / cos_pitch;
+
+  double cos_yaw = cos(yaw);
+  double sin_yaw = sin(yaw);
+
+  // derivatives of the zyx euler angles with respect to a small rotation about the fixed axes
+  Eigen::Matrix3d T;
+  T << cos_yaw / cos_pitch, sin_yaw / cos_pitch, 0.0,
+       -sin_yaw,            cos_yaw,             0.0,
+       cos_yaw * tan_pitch, sin_yaw * tan_pitch, 1.0;
+  return T;
+}
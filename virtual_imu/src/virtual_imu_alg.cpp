@@ -4,6 +4,12 @@ VirtualImuAlgorithm::VirtualImuAlgorithm(void)
 {
   this->estimation_rpy_ = new KalmanFilter();
 
+  this->config_ = Config::__getDefault__();
+  this->first_sample_ = true;
+  this->duplicated_samples_ = 0;
+  this->out_of_order_samples_ = 0;
+  this->gapped_samples_ = 0;
+
   pthread_mutex_init(&this->access_, NULL);
 }
 
@@ -19,44 +25,121 @@ void VirtualImuAlgorithm::config_update(Config& config, uint32_t level)
   // save the current configuration
   this->config_ = config;
 
+  this->estimation_rpy_->attitude_.setSubSteps(config.attitude_sub_steps);
+  this->estimation_rpy_->attitude_.setConingCompensation(config.coning_compensation);
+  this->estimation_rpy_->setGyroNoise(config.gyro_noise_density);
+
   this->unlock();
 }
 
-// VirtualImuAlgorithm Public API
-void VirtualImuAlgorithm::createVirtualImu(sensor_msgs::Imu originl_imu_msg, sensor_msgs::Imu& virtual_imu_msg)
+bool VirtualImuAlgorithm::computeDeltaT(const ros::Time& stamp, const ros::Time& received, float& delta_t)
 {
+  ros::Time current = this->config_.use_header_stamp ? stamp : received;
 
-  static double t_1;
-  static double t_2;
-  static double first_exec = 1;
+  delta_t = 0.0;
+  if (this->first_sample_)
+  {
+    this->last_stamp_ = current;
+    this->first_sample_ = false;
+    return true;
+  }
 
-  float delta_t;
+  if (!this->config_.use_header_stamp)
+  {
+    delta_t = (float)(current - this->last_stamp_).toSec();
+    this->last_stamp_ = current;
+    return true;
+  }
 
-  //calculate delta time
-  if (first_exec)
+  double elapsed = (current - this->last_stamp_).toSec();
+  if (elapsed == 0.0)
+  {
+    this->duplicated_samples_++;
+    return false;
+  }
+  if (elapsed < 0.0)
   {
-    t_2 = (double)ros::Time::now().toSec();
-    first_exec = 0;
+    this->out_of_order_samples_++;
+    return false;
   }
-  t_1 = (double)ros::Time::now().toSec();
-  delta_t = (float)(t_1 - t_2);
-  t_2 = (double)ros::Time::now().toSec();
+
+  this->last_stamp_ = current;
+  if (elapsed > this->config_.max_sample_gap)
+  {
+    // do not integrate the rates across the gap, restart from this sample
+    this->gapped_samples_++;
+    return true;
+  }
+
+  delta_t = (float)elapsed;
+  return true;
+}
+
+void VirtualImuAlgorithm::integrateSample(const ros::Time& stamp, const ros::Time& received, double gyro_x,
+                                          double gyro_y, double gyro_z)
+{
+  float delta_t;
 
   //orientation calculations
-  this->estimation_rpy_->predict(delta_t, originl_imu_msg.angular_velocity.x, originl_imu_msg.angular_velocity.y,
-                                 originl_imu_msg.angular_velocity.z);
-  tf::Quaternion quaternion = tf::createQuaternionFromRPY(this->estimation_rpy_->X_[0][0],
-                                                          this->estimation_rpy_->X_[1][0],
-                                                          this->estimation_rpy_->X_[2][0]);
+  if (this->computeDeltaT(stamp, received, delta_t))
+    this->estimation_rpy_->predict(delta_t, gyro_x, gyro_y, gyro_z);
+}
 
-  //create message
-  virtual_imu_msg.header.stamp = ros::Time::now();
+void VirtualImuAlgorithm::fillOrientation(const ros::Time& stamp, const ros::Time& received,
+                                          sensor_msgs::Imu& virtual_imu_msg)
+{
+  const Eigen::Quaterniond& quaternion = this->estimation_rpy_->attitude_.getQuaternion();
+
+  if (this->config_.use_header_stamp)
+    virtual_imu_msg.header.stamp = stamp;
+  else
+    virtual_imu_msg.header.stamp = received;
   virtual_imu_msg.header.frame_id = "imu_link";
-  virtual_imu_msg.orientation.x = quaternion[0];
-  virtual_imu_msg.orientation.y = quaternion[1];
-  virtual_imu_msg.orientation.z = quaternion[2];
-  virtual_imu_msg.orientation.w = quaternion[3];
-  virtual_imu_msg.orientation_covariance[0] = 0.5;
-  virtual_imu_msg.orientation_covariance[4] = 0.5;
-  virtual_imu_msg.orientation_covariance[8] = 0.5;
+  virtual_imu_msg.orientation.x = quaternion.x();
+  virtual_imu_msg.orientation.y = quaternion.y();
+  virtual_imu_msg.orientation.z = quaternion.z();
+  virtual_imu_msg.orientation.w = quaternion.w();
+  const Eigen::Matrix3d& covariance = this->estimation_rpy_->getCovariance();
+  for (int i = 0; i < 3; i++)
+    for (int j = 0; j < 3; j++)
+      virtual_imu_msg.orientation_covariance[3 * i + j] = covariance(i, j);
+}
+
+// VirtualImuAlgorithm Public API
+void VirtualImuAlgorithm::createVirtualImu(const sensor_msgs::Imu& originl_imu_msg, sensor_msgs::Imu& virtual_imu_msg)
+{
+  ros::Time received = ros::Time::now();
+  this->integrateSample(originl_imu_msg.header.stamp, received, originl_imu_msg.angular_velocity.x,
+                        originl_imu_msg.angular_velocity.y, originl_imu_msg.angular_velocity.z);
+
+  //create message
+  this->fillOrientation(originl_imu_msg.header.stamp, received, virtual_imu_msg);
+  virtual_imu_msg.angular_velocity = originl_imu_msg.angular_velocity;
+  virtual_imu_msg.angular_velocity_covariance = originl_imu_msg.angular_velocity_covariance;
+  virtual_imu_msg.linear_acceleration = originl_imu_msg.linear_acceleration;
+  virtual_imu_msg.linear_acceleration_covariance = originl_imu_msg.linear_acceleration_covariance;
+}
+
+void VirtualImuAlgorithm::integrateBatch(const ImuSampleBatch& batch, int begin, int end)
+{
+  for (int i = begin; i < end; i++)
+    this->integrateSample(batch.stamp[i], batch.received[i], batch.gyro_x[i], batch.gyro_y[i], batch.gyro_z[i]);
+}
+
+void VirtualImuAlgorithm::createVirtualImu(const ImuSampleBatch& batch, int index, sensor_msgs::Imu& virtual_imu_msg)
+{
+  this->fillOrientation(batch.stamp[index], batch.received[index], virtual_imu_msg);
+  virtual_imu_msg.angular_velocity.x = batch.gyro_x[index];
+  virtual_imu_msg.angular_velocity.y = batch.gyro_y[index];
+  virtual_imu_msg.angular_velocity.z = batch.gyro_z[index];
+  virtual_imu_msg.linear_acceleration.x = batch.acc_x[index];
+  virtual_imu_msg.linear_acceleration.y = batch.acc_y[index];
+  virtual_imu_msg.linear_acceleration.z = batch.acc_z[index];
+  virtual_imu_msg.angular_velocity_covariance = batch.message[index]->angular_velocity_covariance;
+  virtual_imu_msg.linear_acceleration_covariance = batch.message[index]->linear_acceleration_covariance;
+}
+
+void VirtualImuAlgorithm::correctHeading(double yaw, double yaw_variance)
+{
+  this->estimation_rpy_->correct(yaw, yaw_variance);
 }
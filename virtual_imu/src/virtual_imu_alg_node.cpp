@@ -2,338 +2,297 @@
 
 VirtualImuAlgNode::VirtualImuAlgNode(void) :
     algorithm_base::IriBaseAlgorithm<VirtualImuAlgorithm>()
+{
+  this->init();
+}
+
+VirtualImuAlgNode::VirtualImuAlgNode(const ros::NodeHandle& node_handle, const ros::NodeHandle& private_node_handle) :
+    algorithm_base::IriBaseAlgorithm<VirtualImuAlgorithm>()
+{
+  // the topics, timers and parameters use the nodelet namespace and the
+  // callback queue of the manager
+  this->public_node_handle_ = node_handle;
+  this->private_node_handle_ = private_node_handle;
+  this->init();
+
+  // the base class server is on the private namespace of the manager, shared
+  // by all the nodelets of the manager
+  this->nodelet_reconfigure_server_.reset(new dynamic_reconfigure::Server<Config>(this->private_node_handle_));
+  this->nodelet_reconfigure_server_->setCallback(boost::bind(&VirtualImuAlgNode::nodeletConfigUpdate, this, _1, _2));
+}
+
+void VirtualImuAlgNode::init(void)
 {
   //init class attributes if necessary
+  this->node_loop_running_ = false;
   this->loop_rate_ = 100; //in [Hz]
-  this->originl_imu_msg_.angular_velocity.x = 0.0;
-  this->originl_imu_msg_.angular_velocity.y = 0.0;
-  this->originl_imu_msg_.angular_velocity.z = 0.0;
   this->virtual_imu_msg_.angular_velocity.x = 0.0;
   this->virtual_imu_msg_.angular_velocity.y = 0.0;
   this->virtual_imu_msg_.angular_velocity.z = 0.0;
+  this->config_ = Config::__getDefault__();
+
+  this->samples_since_publish_ = 0;
+  this->published_msgs_ = 0;
+  this->latency_last_ = 0.0;
+  this->latency_mean_ = 0.0;
+  this->latency_max_ = 0.0;
+
+  this->loadCalibration();
+
+  this->new_virtual_imu_ = false;
+  this->ring_high_water_mark_ = 0;
+  this->ring_overruns_ = 0;
+  sem_init(&this->imu_ring_semaphore_, 0, 0);
 
   // [init publishers]
   this->imu_publisher_ = this->public_node_handle_.advertise < sensor_msgs::Imu > ("/virtual_imu_data", 1);
+  this->calibrated_imu_publisher_ = this->public_node_handle_.advertise < sensor_msgs::Imu > ("/imu/data_calibrated", 1);
 
   // [init subscribers]
-  this->original_imu_ = this->public_node_handle_.subscribe("/imu/data", 1, &VirtualImuAlgNode::cb_imuData, this);
-
-  XmlRpc::XmlRpcValue accMisalignMatrixConfig;
-  if (this->public_node_handle_.hasParam("/acc_misalign_matrix"))
-  {
-    try
-    {
-      this->public_node_handle_.getParam("/acc_misalign_matrix", accMisalignMatrixConfig);
-
-      ROS_ASSERT(accMisalignMatrixConfig.getType() == XmlRpc::XmlRpcValue::TypeArray);
+  this->original_imu_ = this->public_node_handle_.subscribe("/imu/data", IMU_BATCH_SIZE, &VirtualImuAlgNode::cb_imuData,
+                                                           this);
+  this->gps_odometry_ = this->public_node_handle_.subscribe("/odometry_gps", 1, &VirtualImuAlgNode::cb_gpsOdometry,
+                                                            this);
 
-      int matSize = acc_misaligment_.rows();
+  // [init services]
 
-      for (int i = 0; i < matSize; i++)
-      {
-        for (int j = 0; j < matSize; j++)
-        {
-          try
-          {
-            // These matrices can cause problems if all the types
-            // aren't specified with decimal points. Handle that
-            // using string streams.
-            std::ostringstream ostr;
-            ostr << accMisalignMatrixConfig[matSize * i + j];
-            std::istringstream istr(ostr.str());
-            istr >> acc_misaligment_(i, j);
-          }
-          catch (XmlRpc::XmlRpcException &e)
-          {
-            throw e;
-          }
-          catch (...)
-          {
-            throw;
-          }
-        }
-      }
-    }
-    catch (XmlRpc::XmlRpcException &e)
-    {
-      ROS_ERROR_STREAM(
-          "ERROR reading IMU calibration: " << e.getMessage() << " for misalign_matrix (type: "
-              << accMisalignMatrixConfig.getType() << ")");
-    }
-    std::cout << "Loaded acc_misalign_matrix using rosparam: " << std::endl;
-    std::cout << acc_misaligment_ << std::endl;
-  }
+  // [init clients]
 
-  XmlRpc::XmlRpcValue accScaleMatrixConfig;
-  if (this->public_node_handle_.hasParam("/acc_scale_matrix"))
-  {
-    try
-    {
-      this->public_node_handle_.getParam("/acc_scale_matrix", accScaleMatrixConfig);
+  // [init action servers]
 
-      ROS_ASSERT(accScaleMatrixConfig.getType() == XmlRpc::XmlRpcValue::TypeArray);
+  // [init action clients]
 
-      int matSize = acc_scale_factor_.rows();
+  this->integration_running_ = true;
+  pthread_create(&this->integration_thread_, NULL, &VirtualImuAlgNode::integrationThread, this);
+}
 
-      for (int i = 0; i < matSize; i++)
-      {
-        for (int j = 0; j < matSize; j++)
-        {
-          try
-          {
-            // These matrices can cause problems if all the types
-            // aren't specified with decimal points. Handle that
-            // using string streams.
-            std::ostringstream ostr;
-            ostr << accScaleMatrixConfig[matSize * i + j];
-            std::istringstream istr(ostr.str());
-            istr >> acc_scale_factor_(i, j);
-          }
-          catch (XmlRpc::XmlRpcException &e)
-          {
-            throw e;
-          }
-          catch (...)
-          {
-            throw;
-          }
-        }
-      }
-    }
-    catch (XmlRpc::XmlRpcException &e)
-    {
-      ROS_ERROR_STREAM(
-          "ERROR reading IMU calibration: " << e.getMessage() << " for acc_scale_factor_matrix (type: "
-              << accScaleMatrixConfig.getType() << ")");
-    }
-    std::cout << "Loaded acc_scale_factor_matrix using rosparam: " << std::endl;
-    std::cout << acc_scale_factor_ << std::endl;
+void VirtualImuAlgNode::loadCalibration(void)
+{
+  std::string calibration_file;
+  std::string calibration_cache;
+  this->private_node_handle_.getParam("calibration_file", calibration_file);
+  if (!this->private_node_handle_.getParam("calibration_cache", calibration_cache))
+  {
+    const char* ros_home = getenv("ROS_HOME");
+    const char* home = getenv("HOME");
+    if (ros_home != NULL)
+      calibration_cache = std::string(ros_home) + "/virtual_imu_calibration.bin";
+    else if (home != NULL)
+      calibration_cache = std::string(home) + "/.ros/virtual_imu_calibration.bin";
   }
 
-  XmlRpc::XmlRpcValue accBiasVectorConfig;
-  if (this->public_node_handle_.hasParam("/acc_bias_vector"))
+  // the cache is only valid for the calibration file it was generated from
+  uint64_t file_hash = 0;
+  bool file_hashed = !calibration_file.empty() && ImuCalibration::hashFile(calibration_file, file_hash);
+  if (file_hashed && !calibration_cache.empty() && this->calibration_.loadCache(calibration_cache, file_hash))
   {
-    try
-    {
-      this->public_node_handle_.getParam("/acc_bias_vector", accBiasVectorConfig);
+    ROS_INFO("IMU calibration %016llx loaded from cache %s", (unsigned long long)this->calibration_.hash(),
+             calibration_cache.c_str());
+    return;
+  }
 
-      ROS_ASSERT(accBiasVectorConfig.getType() == XmlRpc::XmlRpcValue::TypeArray);
+  // a partial calibration is neither reported as loaded nor cached
+  if (!this->calibration_.loadFromParams(this->public_node_handle_))
+  {
+    ROS_ERROR("Invalid IMU calibration in rosparam, check imu_calib.yaml");
+    return;
+  }
+  ROS_INFO("IMU calibration %016llx loaded from rosparam", (unsigned long long)this->calibration_.hash());
 
-      int matSize = acc_bias_.rows();
+  if (file_hashed && !calibration_cache.empty() && !this->calibration_.saveCache(calibration_cache, file_hash))
+    ROS_WARN("Could not write the IMU calibration cache %s", calibration_cache.c_str());
+}
 
-      for (int i = 0; i < matSize; i++)
-      {
-        try
-        {
-          // These matrices can cause problems if all the types
-          // aren't specified with decimal points. Handle that
-          // using string streams.
-          std::ostringstream ostr;
-          ostr << accBiasVectorConfig[i];
-          std::istringstream istr(ostr.str());
-          istr >> acc_bias_(i);
-        }
-        catch (XmlRpc::XmlRpcException &e)
-        {
-          throw e;
-        }
-        catch (...)
-        {
-          throw;
-        }
-      }
-    }
-    catch (XmlRpc::XmlRpcException &e)
-    {
-      ROS_ERROR_STREAM(
-          "ERROR reading IMU calibration: " << e.getMessage() << " for acc_bias_vector (type: "
-              << accBiasVectorConfig.getType() << ")");
-    }
-    std::cout << "Loaded acc_bias_vector using rosparam: " << std::endl;
-    std::cout << acc_bias_ << std::endl;
-  }
+VirtualImuAlgNode::~VirtualImuAlgNode(void)
+{
+  // [free dynamic memory]
+  this->stopNodeLoop();
+  this->integration_running_ = false;
+  sem_post(&this->imu_ring_semaphore_);
+  pthread_join(this->integration_thread_, NULL);
+  sem_destroy(&this->imu_ring_semaphore_);
+}
 
-  ////////////////////////////////// Loading Gyro calibration!!! //////////////////////////////////////////////
+void VirtualImuAlgNode::startNodeLoop(void)
+{
+  this->addNodeDiagnostics();
+  this->node_loop_running_ = true;
+  pthread_create(&this->node_loop_thread_, NULL, &VirtualImuAlgNode::nodeLoopThread, this);
+}
 
-  XmlRpc::XmlRpcValue gyroMisalignMatrixConfig;
-  if (this->public_node_handle_.hasParam("/gyro_misalign_matrix"))
-  {
-    try
-    {
-      this->public_node_handle_.getParam("/gyro_misalign_matrix", gyroMisalignMatrixConfig);
+void VirtualImuAlgNode::stopNodeLoop(void)
+{
+  if (!this->node_loop_running_)
+    return;
+  this->node_loop_running_ = false;
+  pthread_join(this->node_loop_thread_, NULL);
+}
 
-      ROS_ASSERT(gyroMisalignMatrixConfig.getType() == XmlRpc::XmlRpcValue::TypeArray);
+void VirtualImuAlgNode::nodeletConfigUpdate(Config &config, uint32_t level)
+{
+  this->alg_.config_update(config, level);
+  this->node_config_update(config, level);
+}
 
-      int matSize = gyro_misaligment_.rows();
+void *VirtualImuAlgNode::nodeLoopThread(void *param)
+{
+  VirtualImuAlgNode *node = (VirtualImuAlgNode *)param;
 
-      for (int i = 0; i < matSize; i++)
-      {
-        for (int j = 0; j < matSize; j++)
-        {
-          try
-          {
-            // These matrices can cause problems if all the types
-            // aren't specified with decimal points. Handle that
-            // using string streams.
-            std::ostringstream ostr;
-            ostr << gyroMisalignMatrixConfig[matSize * i + j];
-            std::istringstream istr(ostr.str());
-            istr >> gyro_misaligment_(i, j);
-          }
-          catch (XmlRpc::XmlRpcException &e)
-          {
-            throw e;
-          }
-          catch (...)
-          {
-            throw;
-          }
-        }
-      }
-    }
-    catch (XmlRpc::XmlRpcException &e)
-    {
-      ROS_ERROR_STREAM(
-          "ERROR reading IMU calibration: " << e.getMessage() << " for misalign_matrix (type: "
-              << gyroMisalignMatrixConfig.getType() << ")");
-    }
-    std::cout << "Loaded gyro_misalign_matrix using rosparam: " << std::endl;
-    std::cout << gyro_misaligment_ << std::endl;
+  while (node->node_loop_running_ && ros::ok())
+  {
+    node->mainNodeThread();
+    node->diagnostic_.update();
+    node->loop_rate_.sleep();
   }
 
-  XmlRpc::XmlRpcValue gyroScaleMatrixConfig;
-  if (this->public_node_handle_.hasParam("/gyro_scale_matrix"))
+  pthread_exit(NULL);
+}
+
+void VirtualImuAlgNode::mainNodeThread(void)
+{
+  // the integration is done in the integration thread, and in event driven
+  // mode the publication too
+  this->alg_.lock();
+  if (this->config_.event_driven || !this->new_virtual_imu_)
   {
-    try
-    {
-      this->public_node_handle_.getParam("/gyro_scale_matrix", gyroScaleMatrixConfig);
+    this->alg_.unlock();
+    return;
+  }
+  this->new_virtual_imu_ = false;
 
-      ROS_ASSERT(gyroScaleMatrixConfig.getType() == XmlRpc::XmlRpcValue::TypeArray);
+  // [fill msg structures]
 
-      int matSize = gyro_scale_factor_.rows();
+  // [fill srv structure and make request to the server]
 
-      for (int i = 0; i < matSize; i++)
-      {
-        for (int j = 0; j < matSize; j++)
-        {
-          try
-          {
-            // These matrices can cause problems if all the types
-            // aren't specified with decimal points. Handle that
-            // using string streams.
-            std::ostringstream ostr;
-            ostr << gyroScaleMatrixConfig[matSize * i + j];
-            std::istringstream istr(ostr.str());
-            istr >> gyro_scale_factor_(i, j);
-          }
-          catch (XmlRpc::XmlRpcException &e)
-          {
-            throw e;
-          }
-          catch (...)
-          {
-            throw;
-          }
-        }
-      }
-    }
-    catch (XmlRpc::XmlRpcException &e)
-    {
-      ROS_ERROR_STREAM(
-          "ERROR reading IMU calibration: " << e.getMessage() << " for gyro_scale_factor_matrix (type: "
-              << gyroScaleMatrixConfig.getType() << ")");
-    }
-    std::cout << "Loaded gyro_scale_factor_matrix using rosparam: " << std::endl;
-    std::cout << gyro_scale_factor_ << std::endl;
-  }
+  // [fill action structure and make request to the action server]
+
+  // [publish messages]
+  this->imu_publisher_.publish(boost::make_shared<sensor_msgs::Imu>(this->virtual_imu_msg_));
+  this->alg_.unlock();
+}
+
+void *VirtualImuAlgNode::integrationThread(void *param)
+{
+  VirtualImuAlgNode *node = (VirtualImuAlgNode *)param;
+  ImuSample samples[IMU_BATCH_SIZE];
+  ImuSampleBatch batch;
 
-  XmlRpc::XmlRpcValue gyroBiasVectorConfig;
-  if (this->public_node_handle_.hasParam("/gyro_bias_vector"))
+  while (node->integration_running_)
   {
-    try
-    {
-      this->public_node_handle_.getParam("/gyro_bias_vector", gyroBiasVectorConfig);
+    // the callback posts once per sample, but all available samples are drained
+    // on every wake up, so the semaphore count only limits the sleeping time
+    sem_wait(&node->imu_ring_semaphore_);
 
-      ROS_ASSERT(gyroBiasVectorConfig.getType() == XmlRpc::XmlRpcValue::TypeArray);
+    size_t count;
+    while ((count = node->imu_ring_.pop(samples, IMU_BATCH_SIZE)) > 0)
+    {
+      batch.assign(samples, count);
 
-      int matSize = gyro_bias_.rows();
+      // the calibration is constant after construction
+      node->calibration_.correctBatch(batch);
+      node->publishCalibrated(batch);
 
-      for (int i = 0; i < matSize; i++)
+      node->alg_.lock();
+      if (node->config_.event_driven)
+        node->integrateAndPublish(batch);
+      else
       {
-        try
-        {
-          // These matrices can cause problems if all the types
-          // aren't specified with decimal points. Handle that
-          // using string streams.
-          std::ostringstream ostr;
-          ostr << gyroBiasVectorConfig[i];
-          std::istringstream istr(ostr.str());
-          istr >> gyro_bias_(i);
-        }
-        catch (XmlRpc::XmlRpcException &e)
-        {
-          throw e;
-        }
-        catch (...)
-        {
-          throw;
-        }
+        node->alg_.integrateBatch(batch, 0, batch.size);
+        node->alg_.createVirtualImu(batch, batch.size - 1, node->virtual_imu_msg_);
       }
+      node->new_virtual_imu_ = true;
+      node->alg_.unlock();
     }
-    catch (XmlRpc::XmlRpcException &e)
-    {
-      ROS_ERROR_STREAM(
-          "ERROR reading IMU calibration: " << e.getMessage() << " for gyro_bias_vector (type: "
-              << gyroBiasVectorConfig.getType() << ")");
-    }
-    std::cout << "Loaded gyro_bias_vector using rosparam: " << std::endl;
-    std::cout << gyro_bias_ << std::endl;
   }
 
-  // [init services]
-
-  // [init clients]
-
-  // [init action servers]
-
-  // [init action clients]
+  pthread_exit(NULL);
 }
 
-VirtualImuAlgNode::~VirtualImuAlgNode(void)
+void VirtualImuAlgNode::integrateAndPublish(const ImuSampleBatch& batch)
 {
-  // [free dynamic memory]
+  int begin = 0;
+  while (begin < batch.size)
+  {
+    // integrate up to the next sample to publish
+    int remaining = this->config_.output_decimation - this->samples_since_publish_;
+    int end = begin + (remaining > 1 ? remaining : 1);
+    if (end > batch.size)
+      end = batch.size;
+    this->alg_.integrateBatch(batch, begin, end);
+    this->samples_since_publish_ += end - begin;
+    begin = end;
+
+    if (this->samples_since_publish_ < this->config_.output_decimation)
+      continue;
+    this->samples_since_publish_ = 0;
+
+    this->alg_.createVirtualImu(batch, end - 1, this->virtual_imu_msg_);
+    this->imu_publisher_.publish(boost::make_shared<sensor_msgs::Imu>(this->virtual_imu_msg_));
+
+    // latency from sample arrival to publication, in [ms]
+    this->latency_last_ = (ros::WallTime::now() - batch.arrival[end - 1]).toSec() * 1000.0;
+    this->published_msgs_++;
+    this->latency_mean_ += (this->latency_last_ - this->latency_mean_) / this->published_msgs_;
+    if (this->latency_last_ > this->latency_max_)
+      this->latency_max_ = this->latency_last_;
+  }
 }
 
-void VirtualImuAlgNode::mainNodeThread(void)
+void VirtualImuAlgNode::publishCalibrated(const ImuSampleBatch& batch)
 {
-  // [fill msg structures]
-  this->alg_.createVirtualImu(this->originl_imu_msg_, this->virtual_imu_msg_);
-
-  // [fill srv structure and make request to the server]
-
-  // [fill action structure and make request to the action server]
-
-  // [publish messages]
-  this->imu_publisher_.publish(this->virtual_imu_msg_);
+  for (int i = 0; i < batch.size; i++)
+  {
+    sensor_msgs::ImuPtr calibrated_imu_msg(new sensor_msgs::Imu(*batch.message[i]));
+    calibrated_imu_msg->angular_velocity.x = batch.gyro_x[i];
+    calibrated_imu_msg->angular_velocity.y = batch.gyro_y[i];
+    calibrated_imu_msg->angular_velocity.z = batch.gyro_z[i];
+    calibrated_imu_msg->linear_acceleration.x = batch.acc_x[i];
+    calibrated_imu_msg->linear_acceleration.y = batch.acc_y[i];
+    calibrated_imu_msg->linear_acceleration.z = batch.acc_z[i];
+    this->calibrated_imu_publisher_.publish(calibrated_imu_msg);
+  }
 }
 
 /*  [subscriber callbacks] */
-void VirtualImuAlgNode::cb_imuData(const sensor_msgs::Imu& Imu_msg)
+void VirtualImuAlgNode::cb_imuData(const sensor_msgs::Imu::ConstPtr& Imu_msg)
 {
-  this->alg_.lock();
+  // the raw sample is calibrated in the integration thread and the ring is
+  // lock-free, so this callback never waits for the integration thread
+  ImuSample sample;
+  sample.arrival = ros::WallTime::now();
+  sample.received = ros::Time::now();
+  sample.stamp = Imu_msg->header.stamp;
+
+  sample.gyro[0] = Imu_msg->angular_velocity.x;
+  sample.gyro[1] = Imu_msg->angular_velocity.y;
+  sample.gyro[2] = Imu_msg->angular_velocity.z;
+  sample.acc[0] = Imu_msg->linear_acceleration.x;
+  sample.acc[1] = Imu_msg->linear_acceleration.y;
+  sample.acc[2] = Imu_msg->linear_acceleration.z;
+  sample.message = Imu_msg;
+
+  if (!this->imu_ring_.push(sample))
+  {
+    this->ring_overruns_++;
+    return;
+  }
 
-  gyro_reading_(0) = Imu_msg.angular_velocity.x;
-  gyro_reading_(1) = Imu_msg.angular_velocity.y;
-  gyro_reading_(2) = Imu_msg.angular_velocity.z;
+  unsigned long occupancy = this->imu_ring_.read_available();
+  if (occupancy > this->ring_high_water_mark_)
+    this->ring_high_water_mark_ = occupancy;
 
-  gyro_corrected_ = gyro_misaligment_ * gyro_scale_factor_ * (gyro_reading_ - gyro_bias_);
+  sem_post(&this->imu_ring_semaphore_);
+}
 
-  //std::cout << "Gyro reading   = " << gyro_reading_ << std::endl
-  //          << "Gyro corrected = " << gyro_corrected_ << std::endl;
+void VirtualImuAlgNode::cb_gpsOdometry(const nav_msgs::Odometry::ConstPtr& odom_msg)
+{
+  this->alg_.lock();
 
-  this->originl_imu_msg_.angular_velocity.x = gyro_corrected_(0);
-  this->originl_imu_msg_.angular_velocity.y = gyro_corrected_(1);
-  this->originl_imu_msg_.angular_velocity.z = gyro_corrected_(2);
+  // the heading is only valid while the vehicle moves, gps_to_odom keeps the
+  // last orientation otherwise, so the yaw variance decides its weight
+  double yaw_variance = odom_msg->pose.covariance[35];
+  if (this->config_.gps_heading_correction && yaw_variance > 0.0)
+    this->alg_.correctHeading(tf::getYaw(odom_msg->pose.pose.orientation), yaw_variance);
 
   this->alg_.unlock();
 }
@@ -353,10 +312,42 @@ void VirtualImuAlgNode::node_config_update(Config &config, uint32_t level)
 
 void VirtualImuAlgNode::addNodeDiagnostics(void)
 {
+  this->diagnostic_.add("Virtual IMU timing", this, &VirtualImuAlgNode::timingDiagnostic);
+}
+
+void VirtualImuAlgNode::timingDiagnostic(diagnostic_updater::DiagnosticStatusWrapper &stat)
+{
+  this->alg_.lock();
+
+  if (!this->config_.event_driven)
+    stat.summary(diagnostic_msgs::DiagnosticStatus::OK, "Polling mode, publishing at loop rate");
+  else if (this->published_msgs_ == 0)
+    stat.summary(diagnostic_msgs::DiagnosticStatus::WARN, "No imu samples received yet");
+  else
+    stat.summary(diagnostic_msgs::DiagnosticStatus::OK, "Event driven mode");
+
+  stat.add("Output decimation", this->config_.output_decimation);
+  stat.add("Published messages", this->published_msgs_);
+  stat.add("Last latency [ms]", this->latency_last_);
+  stat.add("Mean latency [ms]", this->latency_mean_);
+  stat.add("Max latency [ms]", this->latency_max_);
+  stat.add("Use header stamp", (bool)this->config_.use_header_stamp);
+  stat.add("Duplicated samples", this->alg_.duplicated_samples_);
+  stat.add("Out of order samples", this->alg_.out_of_order_samples_);
+  stat.add("Gapped samples", this->alg_.gapped_samples_);
+  stat.add("Ring capacity", IMU_RING_SIZE);
+  stat.add("Ring high water mark", this->ring_high_water_mark_.load());
+  stat.add("Ring overruns", this->ring_overruns_.load());
+  if (this->ring_overruns_ > 0)
+    stat.mergeSummary(diagnostic_msgs::DiagnosticStatus::WARN, "Imu samples lost in the integration ring");
+
+  this->alg_.unlock();
 }
 
-/* main function */
+/* main function, not built in the nodelet library */
+#ifndef BUILD_NODELET
 int main(int argc, char *argv[])
 {
   return algorithm_base::main < VirtualImuAlgNode > (argc, argv, "virtual_imu_alg_node");
 }
+#endif
@@ -0,0 +1,33 @@
+#include "virtual_imu_alg_node.h"
+#include <nodelet/nodelet.h>
+#include <pluginlib/class_list_macros.h>
+
+namespace virtual_imu
+{
+
+/**
+ * \brief Nodelet version of VirtualImuAlgNode
+ *
+ * Runs the virtual imu node inside a nodelet manager, so the messages exchanged
+ * with other nodelets of the same manager are passed as shared pointers
+ * without serialization. The node is built on the nodelet handles, so its
+ * parameters and dynamic reconfigure server are in the nodelet namespace and
+ * its callbacks are served by the callback queue of the nodelet in the
+ * manager. The node loop runs in its own thread.
+ */
+class VirtualImuNodelet : public nodelet::Nodelet
+{
+private:
+
+  boost::shared_ptr<VirtualImuAlgNode> node_;
+
+  virtual void onInit(void)
+  {
+    this->node_.reset(new VirtualImuAlgNode(this->getNodeHandle(), this->getPrivateNodeHandle()));
+    this->node_->startNodeLoop();
+  }
+};
+
+}
+
+PLUGINLIB_EXPORT_CLASS(virtual_imu::VirtualImuNodelet, nodelet::Nodelet)
@@ -0,0 +1,106 @@
+#include "imu_calibration.h"
+#include <gtest/gtest.h>
+#include <stdlib.h>
+
+namespace
+{
+
+double uniform(double min, double max)
+{
+  return min + (max - min) * rand() / (double)RAND_MAX;
+}
+
+// non trivial calibration, every matrix element and bias set
+ImuCalibration randomCalibration(void)
+{
+  ImuCalibration calibration;
+  for (int i = 0; i < 3; i++)
+  {
+    calibration.acc_bias_(i) = uniform(-0.5, 0.5);
+    calibration.gyro_bias_(i) = uniform(-0.05, 0.05);
+    for (int j = 0; j < 3; j++)
+    {
+      calibration.acc_misalignment_(i, j) = (i == j ? 1.0 : 0.0) + uniform(-0.02, 0.02);
+      calibration.acc_scale_factor_(i, j) = (i == j ? 1.0 : 0.0) + uniform(-0.05, 0.05);
+      calibration.gyro_misalignment_(i, j) = (i == j ? 1.0 : 0.0) + uniform(-0.02, 0.02);
+      calibration.gyro_scale_factor_(i, j) = (i == j ? 1.0 : 0.0) + uniform(-0.05, 0.05);
+    }
+  }
+  calibration.update();
+  return calibration;
+}
+
+}
+
+// the batch kernels (avx2 blocks of 4 and scalar tail) must give the same bits as the per-message path
+TEST(ImuCalibration, BatchMatchesPerMessage)
+{
+  srand(8);
+  ImuCalibration calibration = randomCalibration();
+
+  // 61 samples, not a multiple of the avx2 width
+  const int count = 61;
+  ImuSample samples[count];
+  for (int i = 0; i < count; i++)
+  {
+    sensor_msgs::Imu::Ptr message(new sensor_msgs::Imu);
+    message->angular_velocity.x = samples[i].gyro[0] = uniform(-3.0, 3.0);
+    message->angular_velocity.y = samples[i].gyro[1] = uniform(-3.0, 3.0);
+    message->angular_velocity.z = samples[i].gyro[2] = uniform(-3.0, 3.0);
+    message->linear_acceleration.x = samples[i].acc[0] = uniform(-20.0, 20.0);
+    message->linear_acceleration.y = samples[i].acc[1] = uniform(-20.0, 20.0);
+    message->linear_acceleration.z = samples[i].acc[2] = uniform(-20.0, 20.0);
+    samples[i].message = message;
+  }
+
+  ImuSampleBatch batch;
+  batch.assign(samples, count);
+  calibration.correctBatch(batch);
+
+  for (int i = 0; i < count; i++)
+  {
+    sensor_msgs::Imu calibrated;
+    calibration.correct(*samples[i].message, calibrated);
+    EXPECT_EQ(calibrated.angular_velocity.x, batch.gyro_x[i]) << "sample " << i;
+    EXPECT_EQ(calibrated.angular_velocity.y, batch.gyro_y[i]) << "sample " << i;
+    EXPECT_EQ(calibrated.angular_velocity.z, batch.gyro_z[i]) << "sample " << i;
+    EXPECT_EQ(calibrated.linear_acceleration.x, batch.acc_x[i]) << "sample " << i;
+    EXPECT_EQ(calibrated.linear_acceleration.y, batch.acc_y[i]) << "sample " << i;
+    EXPECT_EQ(calibrated.linear_acceleration.z, batch.acc_z[i]) << "sample " << i;
+  }
+}
+
+TEST(ImuCalibration, AppliesBiasScaleAndMisalignment)
+{
+  ImuCalibration calibration;
+  calibration.acc_bias_ << 0.1, -0.2, 0.3;
+  calibration.acc_scale_factor_ = Eigen::Vector3d(1.01, 0.99, 1.02).asDiagonal();
+  calibration.acc_misalignment_ << 1.0, 0.01, 0.0, 0.0, 1.0, -0.02, 0.0, 0.0, 1.0;
+  calibration.update();
+
+  Eigen::Vector3d reading(1.0, 2.0, 9.81);
+  Eigen::Vector3d expected = calibration.acc_misalignment_ * calibration.acc_scale_factor_
+      * (reading - calibration.acc_bias_);
+  Eigen::Vector3d corrected = calibration.correctAcc(reading);
+  for (int i = 0; i < 3; i++)
+    EXPECT_NEAR(expected(i), corrected(i), 1e-12);
+
+  // the identity calibration leaves the gyro untouched
+  Eigen::Vector3d rate(0.1, -0.2, 0.3);
+  EXPECT_TRUE(calibration.correctGyro(rate) == rate);
+}
+
+TEST(ImuCalibration, EmptyBatch)
+{
+  ImuCalibration calibration = randomCalibration();
+  ImuSampleBatch batch;
+  batch.assign(NULL, 0);
+  calibration.correctBatch(batch);
+  EXPECT_EQ(0, batch.size);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
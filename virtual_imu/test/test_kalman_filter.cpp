@@ -0,0 +1,151 @@
+#include "kalman_filter.h"
+#include <gtest/gtest.h>
+#include <math.h>
+
+// scalar observation of the first state, the gain is P00 / (P00 + R)
+TEST(EkfCore, LinearUpdate)
+{
+  EkfCore<2> ekf;
+  ekf.P_ << 4.0, 0.0, 0.0, 1.0;
+
+  Eigen::Matrix<double, 1, 2> H;
+  H << 1.0, 0.0;
+  Eigen::Matrix<double, 1, 1> R;
+  R(0, 0) = 1.0;
+  Eigen::Matrix<double, 1, 1> residual;
+  residual(0) = 2.0;
+
+  Eigen::Vector2d correction = ekf.update<1>(H, R, residual);
+  EXPECT_NEAR(1.6, correction(0), 1e-12);
+  EXPECT_NEAR(0.0, correction(1), 1e-12);
+  EXPECT_NEAR(0.8, ekf.P_(0, 0), 1e-12);
+  EXPECT_NEAR(1.0, ekf.P_(1, 1), 1e-12);
+  EXPECT_NEAR(0.0, ekf.P_(0, 1), 1e-12);
+}
+
+// the Joseph form gives the same covariance as (I - K H) P for the optimal gain, and keeps it symmetric
+TEST(EkfCore, JosephUpdate)
+{
+  EkfCore<3> ekf;
+  Eigen::Matrix3d A;
+  A << 1.0, 0.2, -0.1, 0.3, 0.8, 0.05, -0.2, 0.1, 0.5;
+  ekf.P_ = A * A.transpose();
+  Eigen::Matrix3d P = ekf.P_;
+
+  Eigen::Matrix<double, 2, 3> H;
+  H << 1.0, 0.5, 0.0, 0.0, 1.0, -1.0;
+  Eigen::Matrix2d R;
+  R << 0.2, 0.01, 0.01, 0.1;
+  ekf.update<2>(H, R, Eigen::Vector2d(0.1, -0.2));
+
+  Eigen::Matrix<double, 3, 2> K = P * H.transpose() * (H * P * H.transpose() + R).inverse();
+  Eigen::Matrix3d expected = (Eigen::Matrix3d::Identity() - K * H) * P;
+  for (int i = 0; i < 3; i++)
+  {
+    for (int j = 0; j < 3; j++)
+    {
+      EXPECT_NEAR(expected(i, j), ekf.P_(i, j), 1e-12);
+      EXPECT_NEAR(ekf.P_(i, j), ekf.P_(j, i), 1e-15);
+    }
+  }
+}
+
+TEST(EkfCore, Predict)
+{
+  EkfCore<2> ekf;
+  ekf.P_ << 1.0, 0.0, 0.0, 2.0;
+  Eigen::Matrix2d F;
+  F << 1.0, 0.1, 0.0, 1.0;
+  Eigen::Matrix2d Q = Eigen::Matrix2d::Identity() * 0.01;
+  ekf.predict(F, Q);
+
+  Eigen::Matrix2d expected;
+  expected << 1.03, 0.2, 0.2, 2.01;
+  EXPECT_TRUE(ekf.P_.isApprox(expected, 1e-12));
+
+  ekf.predict(Q);
+  EXPECT_NEAR(1.04, ekf.P_(0, 0), 1e-12);
+}
+
+// the gyro noise density integrated along the step, with the float step time
+TEST(KalmanFilter, PredictGrowsVariances)
+{
+  KalmanFilter filter;
+  filter.setGyroNoise(0.01);
+  for (int i = 0; i < 100; i++)
+    filter.predict(0.01, 0.0, 0.0, 0.0);
+
+  double roll_variance, pitch_variance, yaw_variance;
+  filter.getVariances(roll_variance, pitch_variance, yaw_variance);
+  EXPECT_NEAR(1e-4, roll_variance, 1e-10);
+  EXPECT_NEAR(1e-4, pitch_variance, 1e-10);
+  EXPECT_NEAR(1e-4, yaw_variance, 1e-10);
+}
+
+// a gps heading pulls the yaw and shrinks its variance only
+TEST(KalmanFilter, GpsHeadingCorrection)
+{
+  KalmanFilter filter;
+  filter.setGyroNoise(0.1);
+  for (int i = 0; i < 100; i++)
+    filter.predict(0.01, 0.0, 0.0, 0.0);
+
+  filter.correct(0.3, 0.01);
+
+  double roll, pitch, yaw;
+  filter.getState(roll, pitch, yaw);
+  EXPECT_NEAR(0.0, roll, 1e-9);
+  EXPECT_NEAR(0.0, pitch, 1e-9);
+  // prior variance 0.01, same as the observation
+  EXPECT_NEAR(0.15, yaw, 1e-3);
+
+  double roll_variance, pitch_variance, yaw_variance;
+  filter.getVariances(roll_variance, pitch_variance, yaw_variance);
+  EXPECT_NEAR(0.01, roll_variance, 1e-9);
+  EXPECT_NEAR(0.01, pitch_variance, 1e-9);
+  EXPECT_NEAR(0.005, yaw_variance, 1e-4);
+}
+
+// the residual is wrapped, a heading across +-pi moves the short way
+TEST(KalmanFilter, WrapsHeadingResidual)
+{
+  KalmanFilter filter;
+  filter.setGyroNoise(0.1);
+  filter.predict(1.0, 0.0, 0.0, 0.0);
+  filter.correct(0.0f, 0.0f, 3.1f, Eigen::Matrix3d::Identity() * 1e-6);
+
+  filter.correct(-3.1f, 1e-6f);
+  double roll, pitch, yaw;
+  filter.getState(roll, pitch, yaw);
+  EXPECT_GT(fabs(yaw), 3.09);
+}
+
+TEST(KalmanFilter, FullCorrectionConverges)
+{
+  KalmanFilter filter;
+  filter.setGyroNoise(0.05);
+  Eigen::Matrix3d covariance = Eigen::Matrix3d::Identity() * 1e-4;
+  for (int i = 0; i < 200; i++)
+  {
+    filter.predict(0.01, 0.0, 0.0, 0.0);
+    filter.correct(0.1, -0.05, 1.0, covariance);
+  }
+
+  double roll, pitch, yaw;
+  filter.getState(roll, pitch, yaw);
+  EXPECT_NEAR(0.1, roll, 1e-3);
+  EXPECT_NEAR(-0.05, pitch, 1e-3);
+  EXPECT_NEAR(1.0, yaw, 1e-3);
+
+  // the covariance stays symmetric and positive
+  const Eigen::Matrix3d& P = filter.getCovariance();
+  EXPECT_TRUE(P.isApprox(P.transpose(), 1e-12));
+  Eigen::SelfAdjointEigenSolver<Eigen::Matrix3d> solver(P);
+  EXPECT_GT(solver.eigenvalues().minCoeff(), 0.0);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}